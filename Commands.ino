@@ -16,7 +16,11 @@
 #include "src/AppSettings.h"
 #include "src/TelnetServer.h"
 #include "src/Actuator.h"
+#include "src/StepEngine.h"
+#include "src/TrackPlanner.h"
 #include "src/GpioInputs.h"
+#include "src/TaskScheduler.h"
+#include "src/Profiler.h"
 
 #include "src/ServerInfo.h"
 #include "src/SystemInfo.h"
@@ -27,12 +31,24 @@
 
 #pragma region Standard Callbacks
 
+/// <summary>
+/// Gets the axis selected by the current user (see the "axis" command). A disabled axis selects axis 0.
+/// </summary>
+LinearActuator& selectedAxis()
+{
+    UserContext* context = UserIO.getContext();
+
+    if (!Engine.isEnabled(context->Axis)) context->Axis = 0;
+
+    return Engine.getAxis(context->Axis);
+}
+
 /// <summary>
 /// Toggle the json flag (output format).
 /// </summary>
 void json()
 {
-    Commands.JsonOutput = !Commands.JsonOutput;
+    UserIO.getContext()->JsonOutput = !UserIO.getContext()->JsonOutput;
 }
 
 /// <summary>
@@ -40,9 +56,10 @@ void json()
 /// </summary>
 void quit()
 {
-    if (Commands.WaitForResponse)
+    if (UserIO.getContext()->WaitForResponse)
     {
-        if (Telnet.isConnected())
+        // Only the current telnet session is closed.
+        if ((Telnet.getSession() >= 0) && Telnet.isConnected())
         {
             UserIO.show("Bye...");
             Telnet.disconnectClient();
@@ -51,7 +68,7 @@ void quit()
     else
     {
         UserIO.show("Do You really want to quit (Y/N)? ");
-        Commands.WaitForResponse = true;
+        UserIO.getContext()->WaitForResponse = true;
     }
 }
 
@@ -94,7 +111,7 @@ void nop() {}
 /// </summary>
 void status()
 {
-    Commands.JsonOutput ? UserIO.show(Actuator.toJsonString()) : UserIO.show(Actuator.toString());
+    UserIO.getContext()->JsonOutput ? UserIO.show(selectedAxis().toJsonString()) : UserIO.show(selectedAxis().toString());
 }
 
 /// <summary>
@@ -102,7 +119,7 @@ void status()
 /// </summary>
 void position()
 {
-    UserIO.show(String("position: ") + Actuator.getPosition());
+    UserIO.show(String("position: ") + selectedAxis().getPosition());
 }
 
 /// <summary>
@@ -110,7 +127,7 @@ void position()
 /// </summary>
 void plus()
 {
-    UserIO.println(Actuator.moveRelativeDistance(Settings.Actuator.MinStep));
+    UserIO.println(selectedAxis().moveRelativeDistance(selectedAxis().getMinStep()));
 }
 
 /// <summary>
@@ -118,7 +135,7 @@ void plus()
 /// </summary>
 void minus()
 {
-    UserIO.println(Actuator.moveRelativeDistance(-Settings.Actuator.MinStep));
+    UserIO.println(selectedAxis().moveRelativeDistance(-selectedAxis().getMinStep()));
 }
 
 /// <summary>
@@ -126,7 +143,7 @@ void minus()
 /// </summary>
 void forward()
 {
-    UserIO.println(Actuator.moveRelativeDistance(Settings.Actuator.SmallStep));
+    UserIO.println(selectedAxis().moveRelativeDistance(selectedAxis().getSmallStep()));
 }
 
 /// <summary>
@@ -134,7 +151,7 @@ void forward()
 /// </summary>
 void backward()
 {
-    UserIO.println(Actuator.moveRelativeDistance(-Settings.Actuator.SmallStep));
+    UserIO.println(selectedAxis().moveRelativeDistance(-selectedAxis().getSmallStep()));
 }
 
 /// <summary>
@@ -142,7 +159,7 @@ void backward()
 /// </summary>
 void calibrate()
 {
-    UserIO.println(Actuator.calibrate());
+    UserIO.println(selectedAxis().calibrate());
 }
 
 /// <summary>
@@ -150,7 +167,7 @@ void calibrate()
 /// </summary>
 void enable()
 {
-    Actuator.enable();
+    selectedAxis().enable();
 }
 
 /// <summary>
@@ -158,7 +175,7 @@ void enable()
 /// </summary>
 void disable()
 {
-    Actuator.disable();
+    selectedAxis().disable();
 }
 
 /// <summary>
@@ -166,7 +183,7 @@ void disable()
 /// </summary>
 void stop()
 {
-    Actuator.stop();
+    selectedAxis().stop();
 }
 
 /// <summary>
@@ -174,16 +191,16 @@ void stop()
 /// </summary>
 void reset()
 {
-    UserIO.println(Actuator.reset());
+    UserIO.println(selectedAxis().reset());
 }
 
 /// <summary>
 /// Saves the current application settings.
-/// The actuator specific settings are updated before saving.
+/// The axis specific settings (all axes) are updated before saving.
 /// </summary>
 void save()
 {
-    Actuator.update();
+    Engine.update();
 
     bool ok = Settings.save();
 
@@ -199,7 +216,7 @@ void save()
 
 /// <summary>
 /// (Re)loads the application settings.
-/// The actuator is initialized with the actuator specific settings.
+/// The actuator and the additional axes are initialized with the axis specific settings.
 /// </summary>
 void load()
 {
@@ -207,7 +224,7 @@ void load()
 
     if (ok)
     {
-        Actuator.init();
+        Engine.init();
 
         UserIO.println("Current application settings loaded.");
     }
@@ -217,12 +234,36 @@ void load()
     }
 }
 
+/// <summary>
+/// Print the selected axis and the state of all axes.
+/// </summary>
+void axis()
+{
+    UserIO.getContext()->JsonOutput ? UserIO.show(Engine.toJsonString()) : UserIO.show(String("Selected axis: ") + selectedAxis().getAxis() + "\r\n" + Engine.toString());
+}
+
+/// <summary>
+/// Selects the axis used by the move and settings commands (0: actuator, 1..: additional axes).
+/// </summary>
+/// <param name="value">The axis index.</param>
+void axis(long value)
+{
+    if ((value < 0) || !Engine.isEnabled(value))
+    {
+        UserIO.println(String("Axis ") + value + " not enabled");
+        return;
+    }
+
+    UserIO.getContext()->Axis = value;
+    UserIO.println(String("Axis ") + value + " selected");
+}
+
 /// <summary>
 /// Move to home (zero).
 /// </summary>
 void home()
 {
-        UserIO.println(Actuator.home());
+        UserIO.println(selectedAxis().home());
 }
 
 /// <summary>
@@ -230,7 +271,7 @@ void home()
 /// </summary>
 void gpio()
 {
-    Commands.JsonOutput ? UserIO.show(Pins.toJsonString()) : UserIO.show(Pins.toString());
+    UserIO.getContext()->JsonOutput ? UserIO.show(Pins.toJsonString()) : UserIO.show(Pins.toString());
 }
 
 /// <summary>
@@ -238,7 +279,7 @@ void gpio()
 /// </summary>
 void smallstep()
 {
-    UserIO.show(String(Actuator.getSmallStep()));
+    UserIO.show(selectedAxis().getSmallStep().toString());
 }
 
 /// <summary>
@@ -246,7 +287,7 @@ void smallstep()
 /// </summary>
 void minstep()
 {
-    UserIO.show(String(Actuator.getMinStep()));
+    UserIO.show(selectedAxis().getMinStep().toString());
 }
 
 /// <summary>
@@ -254,7 +295,7 @@ void minstep()
 /// </summary>
 void retract()
 {
-    UserIO.show(String(Actuator.getRetract()));
+    UserIO.show(selectedAxis().getRetract().toString());
 }
 
 /// <summary>
@@ -262,7 +303,7 @@ void retract()
 /// </summary>
 void rpm()
 {
-    UserIO.show(String(Actuator.getRPM()));
+    UserIO.show(selectedAxis().getRPM().toString());
 }
 
 /// <summary>
@@ -270,7 +311,7 @@ void rpm()
 /// </summary>
 void speed()
 {
-    UserIO.show(String(Actuator.getSpeed()));
+    UserIO.show(selectedAxis().getSpeed().toString());
 }
 
 /// <summary>
@@ -278,7 +319,7 @@ void speed()
 /// </summary>
 void minspeed()
 {
-    UserIO.show(String(Actuator.getMinSpeed()));
+    UserIO.show(selectedAxis().getMinSpeed().toString());
 }
 
 /// <summary>
@@ -286,7 +327,7 @@ void minspeed()
 /// </summary>
 void maxspeed()
 {
-    UserIO.show(String(Actuator.getMaxSpeed()));
+    UserIO.show(selectedAxis().getMaxSpeed().toString());
 }
 
 /// <summary>
@@ -294,7 +335,7 @@ void maxspeed()
 /// </summary>
 void maxsteps()
 {
-    UserIO.show(String(Actuator.getMaxSteps()));
+    UserIO.show(String(selectedAxis().getMaxSteps()));
 }
 
 /// <summary>
@@ -302,7 +343,61 @@ void maxsteps()
 /// </summary>
 void microsteps()
 {
-    UserIO.show(String(Actuator.getMicrosteps()));
+    UserIO.show(String(selectedAxis().getMicrosteps()));
+}
+
+/// <summary>
+/// Prints the output benchmark (digitalWrite vs. SIO cycles per edge).
+/// </summary>
+void benchmark()
+{
+    UserIO.println(selectedAxis().benchmark());
+}
+
+/// <summary>
+/// Prints the move time matrix of the yard tracks (axis 0, paged a row at a time), a summary for more than MAX_SHOWN tracks.
+/// </summary>
+void matrix()
+{
+    if (Settings.Yard.Count > TrackPlanner::MAX_SHOWN)
+    {
+        Planner.writeSummary(UserIO.getContext()->JsonOutput, [](const String& chunk) { UserIO.show(chunk); });
+    }
+    else
+    {
+        bool json = UserIO.getContext()->JsonOutput;
+        size_t row = 0;
+
+        UserIO.page([json, row](String& chunk) mutable { return Planner.read(json, row, chunk); });
+    }
+}
+
+/// <summary>
+/// Prints the fastest sequence visiting all yard tracks (axis 0).
+/// </summary>
+void sequence()
+{
+    TrackPlanner::Sequence result = Planner.plan();
+    UserIO.getContext()->JsonOutput ? UserIO.show(Planner.toJsonString(result)) : UserIO.show(Planner.toString(result));
+}
+
+/// <summary>
+/// Prints the main loop tasks and their run-time statistics (overruns are flagged).
+/// </summary>
+void tasks()
+{
+    UserIO.getContext()->JsonOutput ? UserIO.show(Scheduler.toJsonString()) : UserIO.show(Scheduler.toString());
+}
+
+/// <summary>
+/// Prints the profiled times of the loop, the tasks, the commands and the HTTP handlers (paged a site at a time).
+/// </summary>
+void profile()
+{
+    ProfilerClass::Cursor cursor;
+    cursor.Json = UserIO.getContext()->JsonOutput;
+
+    UserIO.page([cursor](String& chunk) mutable { return Profiler.read(cursor, chunk); });
 }
 
 // Number command functions (callbacks).
@@ -312,7 +407,7 @@ void microsteps()
 /// </summary>
 void moveAway()
 {
-    UserIO.println(Actuator.moveAway());
+    UserIO.println(selectedAxis().moveAway());
 }
 
 /// <summary>
@@ -321,7 +416,7 @@ void moveAway()
 /// <param name="value">The position to be moved to.</param>
 void moveAbsoluteDistance(float value)
 {
-    UserIO.println(Actuator.moveAbsoluteDistance(value));
+    UserIO.println(selectedAxis().moveAbsoluteDistance(Millimetres::fromFloat(value)));
 }
 
 /// <summary>
@@ -330,7 +425,7 @@ void moveAbsoluteDistance(float value)
 /// <param name="value">The distance to be moved.</param>
 void moveRelativeDistance(float value)
 {
-    UserIO.println(Actuator.moveRelativeDistance(value));
+    UserIO.println(selectedAxis().moveRelativeDistance(Millimetres::fromFloat(value)));
 }
 
 /// <summary>
@@ -339,7 +434,7 @@ void moveRelativeDistance(float value)
 /// <param name="value">The position to be moved to.</param>
 void moveAbsolute(long value)
 {
-    UserIO.println(Actuator.moveAbsolute(value));
+    UserIO.println(selectedAxis().moveAbsolute(value));
 }
 
 /// <summary>
@@ -348,16 +443,50 @@ void moveAbsolute(long value)
 /// <param name="value">The steps to be moved.</param>
 void moveRelative(long value)
 {
-    UserIO.println(Actuator.moveRelative(value));
+    UserIO.println(selectedAxis().moveRelative(value));
 }
 
 /// <summary>
 /// Move to specified track.
 /// </summary>
-/// <param name="value">The track number.</param>
-void moveToTrack(long value)
+/// <param name="value">The track name or number.</param>
+void moveToTrack(String value)
 {
-    UserIO.println(Actuator.moveTrack(value));
+    UserIO.println(selectedAxis().moveTrack(value));
+}
+
+/// <summary>
+/// Prints the fastest sequence visiting the tracks (axis 0). The tracks are names or numbers
+/// separated by commas or plus signs (i.e. 1,3,5 or North+South).
+/// </summary>
+/// <param name="value">The track list.</param>
+void sequence(String value)
+{
+    uint8_t tracks[TrackPlanner::TRACKS];
+    size_t  count = 0;
+
+    if (!TrackPlanner::parseTracks(value, tracks, count))
+    {
+        UserIO.println(String("Invalid track list ") + value);
+        return;
+    }
+
+    TrackPlanner::Sequence result = Planner.plan(tracks, count);
+    UserIO.getContext()->JsonOutput ? UserIO.show(Planner.toJsonString(result)) : UserIO.show(Planner.toString(result));
+}
+
+/// <summary>
+/// Prints the profiled times of a single group (loop, settings, task, command, http), paged a site at a time.
+/// </summary>
+/// <param name="value">The group name.</param>
+void profile(String value)
+{
+    ProfilerClass::Cursor cursor;
+    cursor.Json = UserIO.getContext()->JsonOutput;
+    cursor.Group = value;
+    cursor.Group.trim();
+
+    UserIO.page([cursor](String& chunk) mutable { return Profiler.read(cursor, chunk); });
 }
 
 /// <summary>
@@ -366,7 +495,7 @@ void moveToTrack(long value)
 /// <param name="value">The new distance value.</param>
 void smallstep(float value)
 {
-    UserIO.println(Actuator.setSmallStep(value));
+    UserIO.println(selectedAxis().setSmallStep(Millimetres::fromFloat(value)));
 }
 
 /// <summary>
@@ -375,7 +504,7 @@ void smallstep(float value)
 /// <param name="value">The new distance value.</param>
 void minstep(float value)
 {
-    UserIO.println(Actuator.setMinStep(value));
+    UserIO.println(selectedAxis().setMinStep(Millimetres::fromFloat(value)));
 }
 
 /// <summary>
@@ -384,7 +513,7 @@ void minstep(float value)
 /// <param name="value">The new distance value.</param>
 void retract(float value)
 {
-    UserIO.println(Actuator.setRetract(value));
+    UserIO.println(selectedAxis().setRetract(Millimetres::fromFloat(value)));
 }
 
 /// <summary>
@@ -393,7 +522,7 @@ void retract(float value)
 /// <param name="value">The new speed value.</param>
 void minspeed(float value)
 {
-    UserIO.println(Actuator.setMinSpeed(value));
+    UserIO.println(selectedAxis().setMinSpeed(StepSpeed::fromFloat(value)));
 }
 
 /// <summary>
@@ -402,7 +531,7 @@ void minspeed(float value)
 /// <param name="value">The new speed value.</param>
 void maxspeed(float value)
 {
-    UserIO.println(Actuator.setMaxSpeed(value));
+    UserIO.println(selectedAxis().setMaxSpeed(StepSpeed::fromFloat(value)));
 }
 
 /// <summary>
@@ -411,7 +540,7 @@ void maxspeed(float value)
 /// <param name="value">The new ramp steps value.</param>
 void maxsteps(long value)
 {
-    UserIO.println(Actuator.setMaxSteps(value));
+    UserIO.println(selectedAxis().setMaxSteps(value));
 }
 
 /// <summary>
@@ -420,7 +549,7 @@ void maxsteps(long value)
 /// <param name="value">The new microsteps value.</param>
 void microsteps(long value)
 {
-    UserIO.println(Actuator.setMicrosteps(value));
+    UserIO.println(selectedAxis().setMicrosteps(value));
 }
 
 // Basic command functions (callbacks).
@@ -430,7 +559,7 @@ void microsteps(long value)
 /// </summary>
 void yard()
 {
-    Commands.JsonOutput ? UserIO.show(Settings.Yard.toJsonString()) : UserIO.show(Settings.Yard.toString());
+    UserIO.getContext()->JsonOutput ? UserIO.show(Settings.Yard.toJsonString()) : UserIO.show(Settings.Yard.toString());
 }
 
 /// <summary>
@@ -447,7 +576,7 @@ void pico()
 void wifi()
 {
     WiFiInfo info;
-    Commands.JsonOutput ? UserIO.show(info.toJsonString()) : UserIO.show(info.toString());
+    UserIO.getContext()->JsonOutput ? UserIO.show(info.toJsonString()) : UserIO.show(info.toString());
 }
 
 /// <summary>
@@ -456,7 +585,7 @@ void wifi()
 void system()
 {
     SystemInfo info;
-    Commands.JsonOutput ? UserIO.show(info.toJsonString()) : UserIO.show(info.toString());
+    UserIO.getContext()->JsonOutput ? UserIO.show(info.toJsonString()) : UserIO.show(info.toString());
 }
 
 /// <summary>
@@ -465,7 +594,7 @@ void system()
 void server()
 {
     ServerInfo info;
-    Commands.JsonOutput ? UserIO.show(info.toJsonString()) : UserIO.show(info.toString());
+    UserIO.getContext()->JsonOutput ? UserIO.show(info.toJsonString()) : UserIO.show(info.toString());
 }
 
 /// <summary>
@@ -473,7 +602,7 @@ void server()
 /// </summary>
 void stepper()
 {
-    Commands.JsonOutput ? UserIO.show(Settings.Stepper.toJsonString()) : UserIO.show(Settings.Stepper.toString());
+    UserIO.getContext()->JsonOutput ? UserIO.show(Settings.Stepper.toJsonString()) : UserIO.show(Settings.Stepper.toString());
 }
 
 /// <summary>
@@ -481,7 +610,7 @@ void stepper()
 /// </summary>
 void actuator()
 {
-    Commands.JsonOutput ? UserIO.show(Settings.Actuator.toJsonString()) : UserIO.show(Settings.Actuator.toString());
+    UserIO.getContext()->JsonOutput ? UserIO.show(Settings.Actuator.toJsonString()) : UserIO.show(Settings.Actuator.toString());
 }
 
 /// <summary>
@@ -489,7 +618,7 @@ void actuator()
 /// </summary>
 void settings()
 {
-    Commands.JsonOutput ? UserIO.show(Settings.toJsonString()) : UserIO.show(Settings.toString());
+    UserIO.getContext()->JsonOutput ? UserIO.show(Settings.toJsonString()) : UserIO.show(Settings.toString());
 }
 
 /// <summary>
@@ -507,20 +636,23 @@ void appsettings()
 /// </summary>
 void reboot()
 {
-    if (Commands.WaitForResponse)
+    if (UserIO.getContext()->WaitForResponse)
     {      
         if (Telnet.isConnected())
         {
             UserIO.show("Rebooting...");
-            Telnet.disconnectClient();
         }
 
+        // Close all telnet sessions.
+        Telnet.selectSession(-1);
+        Telnet.disconnectClient();
+
         rp2040.reboot();
     }
     else
     {
         UserIO.show("Do You really want to reboot (Y/N)? ");
-        Commands.WaitForResponse = true;
+        UserIO.getContext()->WaitForResponse = true;
     }
 }
 
@@ -13,6 +13,75 @@
 // </summary>
 // --------------------------------------------------------------------------------------------------------------------
 
+// The state of the current application settings upload.
+File   uploadFile;
+size_t uploadSize    = 0;
+bool   uploadStarted = false;
+int    uploadStatus  = 200;
+String uploadMessage = "OK";
+
+/// <summary>
+/// Registers a route handler (any method). The handler is wrapped to record the request count and latency.
+/// </summary>
+/// <param name="uri">The route URI.</param>
+/// <param name="handler">The request handler.</param>
+void addRoute(const char* uri, WebServer::THandlerFunction handler)
+{
+    addRoute(uri, HTTP_ANY, handler);
+}
+
+/// <summary>
+/// Registers a route handler for the specified method. The handler is wrapped to record the request count and latency
+/// (metrics), and the handler time (profiling site).
+/// URIs containing path arguments (i.e. "/settings/{}") are matched using UriBraces (see HttpServer.pathArg()).
+/// </summary>
+/// <param name="uri">The route URI.</param>
+/// <param name="method">The HTTP method.</param>
+/// <param name="handler">The request handler.</param>
+void addRoute(const char* uri, HTTPMethod method, WebServer::THandlerFunction handler)
+{
+    int route = Metrics.addRoute(uri);
+    int site = Profiler.add("http", uri);
+
+    auto timed = [route, site, handler]() {
+        unsigned long start = micros();
+        handler();
+        uint32_t elapsed = micros() - start;
+        Metrics.observeRoute(route, elapsed);
+        Profiler.record(site, elapsed);
+    };
+
+    if (strchr(uri, '{') != nullptr)
+    {
+        HttpServer.on(UriBraces(uri), method, timed);
+    }
+    else
+    {
+        HttpServer.on(uri, method, timed);
+    }
+}
+
+/// <summary>
+/// Registers a route handler with an upload handler. Only the final request handler is timed.
+/// </summary>
+/// <param name="uri">The route URI.</param>
+/// <param name="method">The HTTP method.</param>
+/// <param name="handler">The request handler.</param>
+/// <param name="upload">The upload handler.</param>
+void addRoute(const char* uri, HTTPMethod method, WebServer::THandlerFunction handler, WebServer::THandlerFunction upload)
+{
+    int route = Metrics.addRoute(uri);
+    int site = Profiler.add("http", uri);
+
+    HttpServer.on(uri, method, [route, site, handler]() {
+        unsigned long start = micros();
+        handler();
+        uint32_t elapsed = micros() - start;
+        Metrics.observeRoute(route, elapsed);
+        Profiler.record(site, elapsed);
+    }, upload);
+}
+
 /// <summary>
 /// Stream a file to the Http client. The Mime type is set based on the file extension. 
 /// </summary>
@@ -65,32 +134,48 @@ void sendFile(String path)
 }
 
 /// <summary>
-/// Recieves a file (string content) and writes to the file system.
-/// Note this works for small files only.
+/// Selects the axis for the command (optional "axis" argument, default axis 0). The HTTP server uses its own
+/// user context, so the axis selected by a telnet or SerialBT user is not changed.
 /// </summary>
-/// <param name="path">The path of the file.</param>
-/// <param name="content">The file content (string).</param>
-void receiveFile(String path, String content)
+/// <returns>True if the axis is valid and enabled (otherwise a 400 response has been sent).</returns>
+bool selectAxis()
 {
-    File file = LittleFS.open(path, "w");
+    uint8_t axis = 0;
 
-    if (!file)
-    {
-        HttpServer.send(500, "text/plain", String("Error opening file ") + path + ".");
-    }
-    else
+    if (HttpServer.hasArg("axis"))
     {
-        if (file.print(content))
-        {
-            HttpServer.send(200, "text/plain", "OK");
-        }
-        else
+        String arg = HttpServer.arg("axis");
+
+        if (!Commands.isInteger(arg) || !Engine.isEnabled(arg.toInt()))
         {
-            HttpServer.send(500, "text/plain", String("Saving file to ") + path + " failed.");
+            HttpServer.send(400, "text/plain", String("Axis ") + arg + " not enabled");
+            return false;
         }
+
+        axis = arg.toInt();
+    }
+
+    UserIO.getContext()->Axis = axis;
+    return true;
+}
+
+/// <summary>
+/// Gets the single command argument (the "axis" argument is not counted).
+/// </summary>
+/// <param name="count">The number of arguments.</param>
+/// <returns>The (first) command argument.</returns>
+String getCommandArg(int& count)
+{
+    String value;
+    count = 0;
+
+    for (int i = 0; i < HttpServer.args(); i++)
+    {
+        if (HttpServer.argName(i) == "axis") continue;
+        if (count++ == 0) value = HttpServer.arg(i);
     }
 
-    file.close();
+    return value;
 }
 
 /// <summary>
@@ -147,7 +232,12 @@ void getInfo()
 
         if (info == "status")
         {
-            json = Actuator.toJsonString();
+            if (!selectAxis()) return;
+            json = Engine.getAxis(UserIO.getContext()->Axis).toJsonString();
+        }
+        else if (info == "axes")
+        {
+            json = Engine.toJsonString();
         }
         else if (info == "settings")
         {
@@ -172,6 +262,30 @@ void getInfo()
         {
             json = Pins.toJsonString();
         }
+        else if (info == "tasks")
+        {
+            json = Scheduler.toJsonString();
+        }
+        else if (info == "yard/sequence")
+        {
+            // The optional tracks argument (i.e. "1,3,5" or "North,South"), the default is all tracks.
+            uint8_t tracks[TrackPlanner::TRACKS];
+            size_t  count = 0;
+
+            if (!HttpServer.hasArg("tracks"))
+            {
+                json = Planner.toJsonString(Planner.plan());
+            }
+            else if (TrackPlanner::parseTracks(HttpServer.arg("tracks"), tracks, count))
+            {
+                json = Planner.toJsonString(Planner.plan(tracks, count));
+            }
+            else
+            {
+                HttpServer.send(400, "text/plain", String("Argument ") + HttpServer.arg("tracks") + " not a valid track list");
+                return;
+            }
+        }
         else
         {
             HttpServer.send(500, "text/plain", "Could not find the info");
@@ -182,8 +296,96 @@ void getInfo()
     }
 }
 
+/// <summary>
+/// Returns a JSON representation of a single settings section (i.e. "/settings/Stepper").
+/// </summary>
+void getSettingsSection()
+{
+    int index = Settings.findSection(HttpServer.pathArg(0));
+
+    if (index < 0)
+    {
+        HttpServer.send(404, "text/plain", String("Section ") + HttpServer.pathArg(0) + " not found");
+        return;
+    }
+
+    HttpServer.send(200, "application/json", Settings.toJsonString(index));
+}
+
+/// <summary>
+/// Applies a JSON merge patch (RFC 7396) to the application settings. Only the sections contained in the
+/// patch are updated. The stepper and axes settings are applied immediately (not while the stepper is running),
+/// all other settings take effect after a reboot. The changed sections are saved after a short delay,
+/// so that several patches in a row result in a single flash write.
+/// </summary>
+void patchSettings()
+{
+    JsonArenaDocument doc(AppSettings::JSON_SIZE);
+    DeserializationError error = deserializeJson(doc, HttpServer.arg("plain"));
+
+    if (error || !doc.is<JsonObject>())
+    {
+        HttpServer.send(400, "text/plain", "A JSON object was expected.");
+        return;
+    }
+
+    JsonObject patch = doc.as<JsonObject>();
+
+    if (patch.containsKey("Stepper") && Actuator.getRunningFlag())
+    {
+        HttpServer.send(409, "text/plain", "The stepper settings cannot be changed while the stepper is running.");
+        return;
+    }
+
+    if (patch.containsKey("Axes") && Engine.isRunning())
+    {
+        HttpServer.send(409, "text/plain", "The axes settings cannot be changed while an axis is running.");
+        return;
+    }
+
+    uint8_t changed = 0;
+    String  message;
+
+    if (!Settings.patch(patch, changed, message))
+    {
+        HttpServer.send(400, "text/plain", message);
+        return;
+    }
+
+    if (changed & AppSettings::SECTION_STEPPER)
+    {
+        Actuator.apply();
+    }
+
+    if (changed & AppSettings::SECTION_AXES)
+    {
+        Engine.apply();
+    }
+
+    if (changed)
+    {
+        Settings.requestCommit();
+    }
+
+    JsonArenaDocument result(256);
+    JsonArray sections = result.createNestedArray("Changed");
+
+    for (int i = 0; i < AppSettings::SECTIONS; i++)
+    {
+        if (changed & (1 << i))
+        {
+            sections.add(Settings.getSectionName(i));
+        }
+    }
+
+    String json;
+    serializeJson(result, json);
+    HttpServer.send(200, "application/json", json);
+}
+
 /// <summary>
 /// Execute basic command (no arguments). The "reboot" command is executed without waiting for a response.
+/// The axis is selected using the optional "axis" argument (i.e. "/home?axis=1").
 /// </summary>
 void postBaseCommand()
 {
@@ -195,11 +397,13 @@ void postBaseCommand()
     {
         String command = HttpServer.uri().substring(1);
 
+        if (!selectAxis()) return;
+
         if (Commands.isValidBaseCommand(command))
         {
             if (command == "reboot")
             {
-                Commands.WaitForResponse = true;
+                UserIO.getContext()->WaitForResponse = true;
             }
 
             Commands.parse(command);
@@ -213,7 +417,7 @@ void postBaseCommand()
 }
 
 /// <summary>
-/// Execute integer command (one integer argument).
+/// Execute integer command (one integer argument and the optional "axis" argument).
 /// </summary>
 void putIntegerCommand()
 {
@@ -223,19 +427,21 @@ void putIntegerCommand()
     }
     else
     {
-        int n = HttpServer.args();
+        int n = 0;
+        String arg = getCommandArg(n);
+
+        if (!selectAxis()) return;
 
         if (n == 0)
         {
             HttpServer.send(400, "text/plain", "A single argument expected");
         }
-        if (n > 1)
+        else if (n > 1)
         {
             HttpServer.send(400, "text/plain", "Only one argument expected");
         }
         else
         {
-            String arg = HttpServer.arg(0);
 
             if (Commands.isInteger(arg))
             {
@@ -261,7 +467,7 @@ void putIntegerCommand()
 }
 
 /// <summary>
-/// Execute float command (one float argument).
+/// Execute float command (one float argument and the optional "axis" argument).
 /// </summary>
 void putFloatCommand()
 {
@@ -271,19 +477,21 @@ void putFloatCommand()
     }
     else
     {
-        int n = HttpServer.args();
+        int n = 0;
+        String arg = getCommandArg(n);
+
+        if (!selectAxis()) return;
 
         if (n == 0)
         {
             HttpServer.send(400, "text/plain", "A single argument expected");
         }
-        if (n > 1)
+        else if (n > 1)
         {
             HttpServer.send(400, "text/plain", "Only one argument expected");
         }
         else
         {
-            String arg = HttpServer.arg(0);
 
             if (Commands.isFloat(arg))
             {
@@ -309,20 +517,301 @@ void putFloatCommand()
 }
 
 /// <summary>
-/// Receive the application settings file ('appsettings.json').
+/// Execute string command (one text argument, i.e. a track name, and the optional "axis" argument).
+/// The text may contain letters, digits, '_', '-', ',' and '+' only (a single command line argument).
+/// </summary>
+void putStringCommand()
+{
+    if (HttpServer.method() != HTTP_PUT)
+    {
+        HttpServer.send(405, "text/plain", "Method Not Allowed");
+    }
+    else
+    {
+        int n = 0;
+        String arg = getCommandArg(n);
+
+        if (!selectAxis()) return;
+
+        bool valid = arg.length() > 0;
+
+        for (size_t i = 0; i < arg.length(); i++)
+        {
+            char c = arg[i];
+            valid &= isAlphaNumeric(c) || (c == '_') || (c == '-') || (c == ',') || (c == '+');
+        }
+
+        if (n == 0)
+        {
+            HttpServer.send(400, "text/plain", "A single argument expected");
+        }
+        else if (n > 1)
+        {
+            HttpServer.send(400, "text/plain", "Only one argument expected");
+        }
+        else if (!valid)
+        {
+            HttpServer.send(400, "text/plain", String("Argument ") + arg + " not a valid name");
+        }
+        else
+        {
+            String command = HttpServer.uri().substring(1);
+
+            if (Commands.isValidStringCommand(command))
+            {
+                command += " " + arg;
+                Commands.parse(command);
+                HttpServer.send(200, "text/plain", "OK");
+            }
+            else
+            {
+                HttpServer.send(404, "text/plain", String("Command ") + command + " not found");
+            }
+        }
+    }
+}
+
+/// <summary>
+/// Execute a coordinated (linear) move of several axes to absolute positions [steps]. The target of every
+/// axis is given by an argument "a0", "a1", ... (i.e. "/stepall?a0=1000&a1=200"), missing axes keep their
+/// position. All axes start and reach the target at the same time (see StepEngine).
+/// </summary>
+void putLinearCommand()
+{
+    if (HttpServer.method() != HTTP_PUT)
+    {
+        HttpServer.send(405, "text/plain", "Method Not Allowed");
+        return;
+    }
+
+    long targets[StepEngine::MAX_AXES];
+
+    for (uint8_t i = 0; i < StepEngine::MAX_AXES; i++)
+    {
+        targets[i] = Engine.isEnabled(i) ? Engine.getAxis(i).getPosition() : 0;
+    }
+
+    for (int i = 0; i < HttpServer.args(); i++)
+    {
+        String name = HttpServer.argName(i);
+        String arg  = HttpServer.arg(i);
+        String axis = name.substring(1);
+
+        if (name == "plain") continue;
+
+        if (!name.startsWith("a") || !Commands.isInteger(axis) || !Engine.isEnabled(axis.toInt()))
+        {
+            HttpServer.send(400, "text/plain", String("Argument ") + name + " not an enabled axis");
+            return;
+        }
+
+        if (!Commands.isInteger(arg))
+        {
+            HttpServer.send(400, "text/plain", String("Argument ") + arg + " not a valid integer");
+            return;
+        }
+
+        targets[axis.toInt()] = arg.toInt();
+    }
+
+    String result = Engine.moveLinear(targets);
+
+    if (Engine.isLinear() || Engine.isRunning())
+    {
+        HttpServer.send(200, "text/plain", "OK");
+    }
+    else
+    {
+        HttpServer.send(409, "text/plain", result);
+    }
+}
+
+/// <summary>
+/// Upload handler receiving the application settings file ('appsettings.json') in chunks.
+/// The chunks are written to a temporary file, so the memory used does not depend on the file size.
+/// Uploads exceeding the maximum settings file size are rejected.
+/// </summary>
+void uploadSettings()
+{
+    HTTPUpload& upload = HttpServer.upload();
+
+    switch (upload.status)
+    {
+    case UPLOAD_FILE_START:
+        uploadStarted = true;
+        uploadStatus = 200;
+        uploadMessage = "OK";
+        uploadSize = 0;
+        uploadFile = LittleFS.open(SETTINGS_TEMP, "w");
+
+        if (!uploadFile)
+        {
+            uploadStatus = 500;
+            uploadMessage = String("Error opening file ") + SETTINGS_TEMP + ".";
+        }
+
+        break;
+
+    case UPLOAD_FILE_WRITE:
+        if (uploadStatus != 200)
+            break;
+
+        uploadSize += upload.currentSize;
+
+        if (uploadSize > SETTINGS_MAX_SIZE)
+        {
+            uploadStatus = 413;
+            uploadMessage = String("File exceeds the maximum size of ") + SETTINGS_MAX_SIZE + " bytes.";
+            uploadFile.close();
+        }
+        else if (uploadFile.write(upload.buf, upload.currentSize) != upload.currentSize)
+        {
+            uploadStatus = 500;
+            uploadMessage = String("Saving file to ") + SETTINGS_TEMP + " failed.";
+            uploadFile.close();
+        }
+
+        break;
+
+    case UPLOAD_FILE_END:
+        if (uploadFile)
+            uploadFile.close();
+
+        break;
+
+    case UPLOAD_FILE_ABORTED:
+        if (uploadFile)
+            uploadFile.close();
+
+        uploadStatus = 400;
+        uploadMessage = "Upload aborted.";
+        break;
+    }
+}
+
+/// <summary>
+/// Receive the application settings file ('appsettings.json'). Called after the upload has been completed.
+/// The uploaded file is verified and then renamed, replacing the current settings file in a single step.
 /// </summary>
 void postSettings()
 {
-    int n = HttpServer.args();
+    if (!uploadStarted)
+    {
+        HttpServer.send(400, "text/plain", "A file upload (JSON) was expected.");
+        return;
+    }
+
+    uploadStarted = false;
+
+    if (uploadStatus != 200)
+    {
+        LittleFS.remove(SETTINGS_TEMP);
+        HttpServer.send(uploadStatus, "text/plain", uploadMessage);
+    }
+    else if (!Settings.verify(SETTINGS_TEMP))
+    {
+        LittleFS.remove(SETTINGS_TEMP);
+        HttpServer.send(400, "text/plain", "File does not contain valid application settings.");
+    }
+    else if (!LittleFS.rename(SETTINGS_TEMP, SETTINGS_FILE))
+    {
+        LittleFS.remove(SETTINGS_TEMP);
+        HttpServer.send(500, "text/plain", String("Replacing file ") + SETTINGS_FILE + " failed.");
+    }
+    else
+    {
+        // The binary snapshot is recreated from the new file at the next boot.
+        Settings.invalidate();
+        HttpServer.send(200, "text/plain", "OK");
+    }
+}
 
-    if (n != 1)
+/// <summary>
+/// Returns the metrics in the Prometheus text format. The response is sent in chunks (one per metric).
+/// </summary>
+void getMetrics()
+{
+    if (HttpServer.method() != HTTP_GET)
+    {
+        HttpServer.send(405, "text/plain", "Method Not Allowed");
+    }
+    else
     {
-        HttpServer.send(400, "text/plain", "A file content (JSON) was expected.");
+        Metrics.collect();
+
+        HttpServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        HttpServer.send(200, "text/plain; version=0.0.4; charset=utf-8", "");
+        Metrics.write([](const String& chunk) { HttpServer.sendContent(chunk); });
+        HttpServer.sendContent("");
+    }
+}
+
+/// <summary>
+/// Streams the move history (see MoveHistory). The optional 'since' argument is the sequence number of the
+/// last record received, the optional 'format' argument selects the output ('json' or 'csv').
+/// </summary>
+void getHistory()
+{
+    String since  = HttpServer.arg("since");
+    String format = HttpServer.arg("format");
+
+    if (HttpServer.method() != HTTP_GET)
+    {
+        HttpServer.send(405, "text/plain", "Method Not Allowed");
+    }
+    else if ((since.length() > 0) && (!Commands.isInteger(since) || (since.toInt() < 0)))
+    {
+        HttpServer.send(400, "text/plain", String("Argument ") + since + " not a valid sequence number");
+    }
+    else if ((format.length() > 0) && (format != "json") && (format != "csv"))
+    {
+        HttpServer.send(400, "text/plain", String("Format ") + format + " not supported (json or csv)");
+    }
+    else
+    {
+        bool csv = (format == "csv");
+
+        HttpServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        HttpServer.send(200, csv ? "text/csv" : "application/json", "");
+        History.write(uint32_t(since.toInt()), csv, [](const String& chunk) { HttpServer.sendContent(chunk); });
+        HttpServer.sendContent("");
+    }
+}
+
+/// <summary>
+/// Returns the move time matrix of the yard tracks (streamed, a row per chunk).
+/// </summary>
+void getMatrix()
+{
+    if (HttpServer.method() != HTTP_GET)
+    {
+        HttpServer.send(405, "text/plain", "Method Not Allowed");
+    }
+    else
+    {
+        HttpServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        HttpServer.send(200, "application/json", "");
+        Planner.write(true, [](const String& chunk) { HttpServer.sendContent(chunk); });
+        HttpServer.sendContent("");
+    }
+}
+
+/// <summary>
+/// Streams the profiled times of the loop, the tasks, the commands and the HTTP handlers (JSON, a site per chunk).
+/// The output is limited to a single group using the group argument (i.e. /profile?group=task).
+/// </summary>
+void getProfile()
+{
+    if (HttpServer.method() != HTTP_GET)
+    {
+        HttpServer.send(405, "text/plain", "Method Not Allowed");
     }
     else
     {
-        String arg = HttpServer.arg(0);
-        receiveFile(HttpServer.uri(), arg);
+        HttpServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+        HttpServer.send(200, "application/json", "");
+        Profiler.write(true, [](const String& chunk) { HttpServer.sendContent(chunk); }, HttpServer.arg("group").c_str());
+        HttpServer.sendContent("");
     }
 }
 
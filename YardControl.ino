@@ -37,7 +37,6 @@
 // 
 //      - ArduinoJson       https://github.com/bblanchon/ArduinoJson
 //      - Blinkenlight      https://github.com/tfeldmann/Arduino-Blinkenlight
-//      - InputDebounce     https://github.com/Mokolea/InputDebounce
 //      - TimerInterrupt    https://github.com/khoih-prog/TimerInterrupt_Generic
 //   
 //   The Telnet implementation from https://github.com/LennartHennigs/ESPTelnet is used (ported and modified).
@@ -61,8 +60,8 @@
 #include <SerialBT.h>
 #include <LittleFS.h>
 #include <WebServer.h>
+#include <uri/UriBraces.h>
 #include <Blinkenlight.h>
-#include <InputDebounce.h>
 #include <TimerInterrupt_Generic.h>
 
 #include "src/AppSettings.h"
@@ -75,7 +74,15 @@
 #include "src/Wireless.h"
 #include "src/Commands.h"
 #include "src/Actuator.h"
+#include "src/StepEngine.h"
+#include "src/TrackPlanner.h"
+#include "src/PositionStore.h"
+#include "src/MoveHistory.h"
 #include "src/UserInterface.h"
+#include "src/Metrics.h"
+#include "src/Profiler.h"
+#include "src/TaskScheduler.h"
+#include "src/JsonArena.h"
 
 #pragma endregion
 
@@ -88,6 +95,9 @@ auto COPYRIGHT = "Copyright (c) 2023 - Dr. Peter Trimmel";
 // The global (onboard) Led.
 Blinkenlight Led(LED_BUILTIN);
 
+// Create the (global) JSON scratch memory (shared by all JSON documents).
+JsonArenaClass JsonArena;
+
 // Create the (global) application settings.
 AppSettings Settings;
 
@@ -100,6 +110,18 @@ GpioInputs Inputs;
 // Create the (global) actuator.
 LinearActuator Actuator;
 
+// Create the (global) position store (the actuator position persisted in flash).
+PositionStore Positions;
+
+// Create the (global) move history (the move records logged in flash).
+MoveHistory History;
+
+// Create the (global) step engine (driving the actuator and the additional axes).
+StepEngine Engine;
+
+// Create the (global) track planner (move time matrix and track sequences).
+TrackPlanner Planner;
+
 // Create the (global) web server instance (defaults port 80).
 WebServer HttpServer(80);
 
@@ -112,9 +134,30 @@ CommandsClass Commands;
 // Create the (global) user IO instance.
 UserInterface UserIO;
 
+// Create the (global) metrics registry.
+MetricsClass Metrics;
+
+// Create the (global) profiler (the timing aggregates of the loop, the commands and the HTTP handlers).
+ProfilerClass Profiler;
+
 // Create the (global) stepper driver timer.
 RPI_PICO_Timer Timer(0);
 
+// Create the (global) safety input debounce timer.
+RPI_PICO_Timer DebounceTimer(1);
+
+// Create the (global) network instance (WiFi and NTP started in the background).
+Wireless Network;
+
+// Flag indicating that the HTTP and telnet servers have been started.
+bool ServicesStarted = false;
+
+// Create the (global) task scheduler (running the main loop tasks).
+TaskScheduler Scheduler;
+
+// The id of the safety inputs task (signaled by the debounce timer).
+int InputsTask = -1;
+
 #pragma endregion
 
 #pragma region Timer Callback
@@ -122,12 +165,79 @@ RPI_PICO_Timer Timer(0);
 bool TimerHandler(struct repeating_timer* t)
 {
     (void)t;
-    Actuator.onTimer();
+
+    uint32_t start = micros();
+    Engine.onTimer();
+    uint32_t elapsed = micros() - start;
+
+    Metrics.StepIsrTime.observe(elapsed);
+    if (elapsed >= LinearActuator::INTERVAL) Metrics.StepIsrOverruns.inc();
+
+    return true;
+}
+
+bool DebounceTimerHandler(struct repeating_timer* t)
+{
+    (void)t;
+
+    if (Inputs.onTimer()) Scheduler.signal(InputsTask);
+
     return true;
 }
 
 #pragma endregion
 
+#pragma region Network Events
+
+/// <summary>
+/// Network state change event. The HTTP and telnet servers are started as soon as the network is
+/// available. If the WiFi link is lost the servers are stopped and started again (re-armed) when the
+/// link has been recovered. A network failure is only indicated, the actuator and the local commands
+/// keep running.
+/// </summary>
+/// <param name="state">The new network state.</param>
+void onNetworkState(Wireless::State state)
+{
+    Serial.println(String("Network state: ") + Network.getStateName());
+
+    if (Network.isAvailable() && !ServicesStarted)
+    {
+        // Show WiFi info.
+        WiFiInfo wifiInfo;
+        Serial.print(wifiInfo.toString());
+
+        HttpServer.begin(Settings.Server.Http);
+
+        if (!Telnet.begin(Settings.Server.Telnet, Settings.Server.Sessions))
+        {
+            Serial.println("Starting the telnet server failed!");
+
+            // Just indicate the error (the HTTP server and the local commands are still available).
+            Led.pattern(3, 3);
+        }
+
+        ServicesStarted = true;
+
+        // Show TCP server info.
+        ServerInfo serverInfo;
+        Serial.print(serverInfo.toString());
+    }
+    else if ((state == Wireless::RECONNECTING) && ServicesStarted)
+    {
+        Telnet.stop();
+        HttpServer.stop();
+
+        ServicesStarted = false;
+    }
+    else if (state == Wireless::FAILED)
+    {
+        // Just indicate the error (the actuator and the local commands are still available).
+        Led.pattern(2, 3);
+    }
+}
+
+#pragma endregion
+
 #pragma region Telnet Events
 
 /// <summary>
@@ -137,6 +247,7 @@ bool TimerHandler(struct repeating_timer* t)
 void onTelnetConnect(String ip)
 {
     Serial.println(String("Telnet client connected: ") + ip);
+    Metrics.TelnetSessions.inc();
 
     Telnet.println(HEADER);
     Telnet.println(COPYRIGHT);
@@ -199,7 +310,6 @@ void setup()
     // Initialize serial - default baudrate is 115200 (and wait for port to open if on USB).
     Serial.begin();
     // while (!Serial) { delay(10); }
-    delay(1000);
 
     Serial.println(HEADER);
     Serial.println(COPYRIGHT);
@@ -219,12 +329,51 @@ void setup()
 
 #pragma endregion
 
+#pragma region Initialize Scheduler
+
+    // The main loop tasks (name, function, priority, period and budget in usec). The safety inputs and the motion
+    // supervision run every millisecond, the network services run in the background (once per scheduler pass).
+    // The budgets of the motion, history and settings tasks include a flash write (position, moves, settings).
+    InputsTask = Scheduler.add("inputs",   [] { Inputs.run(); },                                   0, 1000,                      500);
+                 Scheduler.add("motion",   [] { Actuator.run(); },                                 1, 1000,                      20000);
+                 Scheduler.add("led",      [] { Led.update(); },                                   2, 10000,                     100);
+                 Scheduler.add("network",  [] { Network.run(); },                                  3, 10000,                     5000);
+                 Scheduler.add("metrics",  [] { Metrics.run(); },                                  4, 10000,                     2000);
+                 Scheduler.add("history",  [] { History.run(!Engine.isRunning()); },               5, 100000,                    50000);
+                 Scheduler.add("settings", [] { Settings.run(!Engine.isRunning()); },              6, 100000,                    100000);
+                 Scheduler.add("user",     [] { UserIO.run(); },                                   7, TaskScheduler::BACKGROUND, 10000);
+                 Scheduler.add("telnet",   [] { if (ServicesStarted) Telnet.loop(); },             8, TaskScheduler::BACKGROUND, 20000);
+                 Scheduler.add("http",     [] { if (ServicesStarted) HttpServer.handleClient(); }, 9, TaskScheduler::BACKGROUND, 50000);
+
+#pragma endregion
+
 #pragma region Initialize Settings
 
+    // Register the metrics (the command counters and the task statistics are part of the commands and scheduler instances).
+    Metrics.init();
+    Commands.addMetrics();
+    Scheduler.addMetrics();
+
+    // Register the profiling sites of the commands (the task and HTTP route sites are added with the task and route).
+    Commands.addProfiles();
+
     // Initialize the file system and the application settings.
     LittleFS.begin();
     Settings.load();
 
+    Serial.println(String("Settings loaded from ") + (Settings.LoadedBinary ? SETTINGS_BINARY : SETTINGS_FILE) +
+                   " in " + Settings.LoadTime + " us" +
+                   (Settings.LoadedBinary ? String(".") : String(" (snapshot saved in ") + Settings.SnapshotTime + " us)."));
+
+    // Read the last position record (restored in Actuator.init()).
+    if (!Positions.begin())
+    {
+        Serial.println(String("No valid position record in ") + POSITION_FILE + " (calibration required).");
+    }
+
+    // Continue the move history (sequence numbers).
+    History.begin();
+
     // Print system info.
     SystemInfo systemInfo;
     Serial.print(systemInfo.toString());
@@ -242,6 +391,16 @@ void setup()
 
     Pins.add(Settings.Stepper.PinALM, INPUT_PULLUP, "ALM");
 
+    // The outputs of the enabled additional axes.
+    for (AppSettings::AxisSettings& axis : Settings.Axes.Axis)
+    {
+        if (!axis.Enabled) continue;
+
+        Pins.add(axis.PinPUL, OUTPUT, axis.Name + " PUL");
+        Pins.add(axis.PinDIR, OUTPUT, axis.Name + " DIR");
+        Pins.add(axis.PinENA, OUTPUT, axis.Name + " ENA");
+    }
+
     Pins.add(Settings.Actuator.LedRunning, OUTPUT, "Running");
     Pins.add(Settings.Actuator.LedInLimit, OUTPUT, "Limit");
     Pins.add(Settings.Actuator.LedAlarmOn, OUTPUT, "Alarm");
@@ -252,75 +411,51 @@ void setup()
 
     Serial.print(Pins.toString());
 
-    // Initialize debounced inputs.
+    // Initialize the safety inputs (GPIO interrupts).
     Inputs.init();
 
 #pragma endregion
 
 #pragma region Initialize Actuator
 
-    Actuator.init();
+    Engine.init();
     Serial.print(Actuator.toString());
+    Serial.print(Engine.toString());
+
+    // Precompute the track move times (updated before use).
+    Planner.update();
 
 #pragma endregion
 
-#pragma region Initialize WiFi
+#pragma region Initialize Timer
 
-    // Check for the WiFi module
-    if (WiFi.status() == WL_NO_MODULE)
+    // Initialize timer with maximum frequency (100 kHz).
+    if (Timer.setFrequency(Actuator.FREQUENCY, TimerHandler))
+    {
+        Serial.println("Starting Stepper Timer OK");
+    }
+    else
     {
-        Serial.println("Communication with WiFi module failed!");
+        Serial.println("Can't set Stepper Timer.");
 
         // Don't continue, just indicate the error.
-        Led.pattern(1, 3);
+        Led.pattern(1, 5);
 
         while (true)
             Led.update();
     }
 
-    Wireless wireless;
-    bool wifiOK = false;
-
-    // Try to connect to WiFi network and create WiFi access point.
-    Serial.print("Trying to connect WiFi to '");
-    Serial.print(Settings.WiFi.SSID);
-    Serial.println("'");
-
-    if (wireless.connectWiFi())
+    // Initialize the safety input debounce timer (1 kHz).
+    if (DebounceTimer.setInterval(GpioInputs::TICK, DebounceTimerHandler))
     {
-        Serial.println("WiFi connection successful");
-        wifiOK = true;
+        Serial.println("Starting Debounce Timer OK");
     }
     else
     {
-        Serial.println("WiFi connection not successful");
-        Serial.println("Trying to create WiFi accesss point");
+        Serial.println("Can't set Debounce Timer.");
 
-        if (wireless.createAP())
-        {
-            Serial.println("Creating a WiFi access point successful");
-            wifiOK = true;
-        }
-        else
-        {
-            Serial.println("Creating a WiFi access point not successful");
-        }
-    }
-
-    if (wifiOK)
-    {
-        // Show WiFi info.
-        WiFiInfo wifiInfo;
-        Serial.print(wifiInfo.toString());
-
-        // Set the clock using NTP.
-        wireless.setClock();
-        Serial.println(String("Current UTC time: ") + wireless.getTime());
-    }
-    else
-    {
         // Don't continue, just indicate the error.
-        Led.pattern(2, 3);
+        Led.pattern(1, 5);
 
         while (true)
             Led.update();
@@ -331,53 +466,71 @@ void setup()
 #pragma region Initialize Http
 
     // Web server setup - GET file
-    HttpServer.on("/", getRoot);
-    HttpServer.on("/about.html",                  getFile);
-    HttpServer.on("/index.html",                  getFile);
-    HttpServer.on("/info.html",                   getFile);
-    HttpServer.on("/settings.html",               getFile);
-    HttpServer.on("/favicon.ico",                 getFile);
-    HttpServer.on("/css/custom-styles.css",       getFile);
-    HttpServer.on("/css/dark-mode-switch.css",    getFile);
-    HttpServer.on("/js/dark-mode-switch.min.js",  getFile);
+    addRoute("/",                           getRoot);
+    addRoute("/about.html",                 getFile);
+    addRoute("/index.html",                 getFile);
+    addRoute("/info.html",                  getFile);
+    addRoute("/settings.html",              getFile);
+    addRoute("/favicon.ico",                getFile);
+    addRoute("/css/custom-styles.css",      getFile);
+    addRoute("/css/dark-mode-switch.css",   getFile);
+    addRoute("/js/dark-mode-switch.min.js", getFile);
 
     // Download the application settings.
-    HttpServer.on("/appsettings.json", getAppSettings);
+    addRoute("/appsettings.json", HTTP_GET, getAppSettings);
+
+    // Web server setup - PATCH settings (registered before the "/settings" info route accepting any method)
+    addRoute("/settings", HTTP_PATCH, patchSettings);
 
     // Web server setup - GET commands
-    HttpServer.on("/settings", getInfo);
-    HttpServer.on("/system",   getInfo);
-    HttpServer.on("/server",   getInfo);
-    HttpServer.on("/status",   getInfo);
-    HttpServer.on("/wifi",     getInfo);
-    HttpServer.on("/gpio",     getInfo);
+    addRoute("/settings/{}", HTTP_GET, getSettingsSection);
+    addRoute("/settings", getInfo);
+    addRoute("/system",   getInfo);
+    addRoute("/server",   getInfo);
+    addRoute("/status",   getInfo);
+    addRoute("/axes",     getInfo);
+    addRoute("/wifi",     getInfo);
+    addRoute("/gpio",     getInfo);
+    addRoute("/tasks",    getInfo);
+
+    // Web server setup - GET track planning (move time matrix and sequence)
+    addRoute("/yard/matrix",   HTTP_GET, getMatrix);
+    addRoute("/yard/sequence", getInfo);
 
     // Web server setup - POST commands
-    HttpServer.on("/plus",      postBaseCommand);
-    HttpServer.on("/minus",     postBaseCommand);
-    HttpServer.on("/forward",   postBaseCommand);
-    HttpServer.on("/backward",  postBaseCommand);
-    HttpServer.on("/calibrate", postBaseCommand);
-    HttpServer.on("/enable",    postBaseCommand);
-    HttpServer.on("/disable",   postBaseCommand);
-    HttpServer.on("/home",      postBaseCommand);
-    HttpServer.on("/stop",      postBaseCommand);
-    HttpServer.on("/release",   postBaseCommand);
-    HttpServer.on("/reboot",    postReboot);
+    addRoute("/plus",      postBaseCommand);
+    addRoute("/minus",     postBaseCommand);
+    addRoute("/forward",   postBaseCommand);
+    addRoute("/backward",  postBaseCommand);
+    addRoute("/calibrate", postBaseCommand);
+    addRoute("/enable",    postBaseCommand);
+    addRoute("/disable",   postBaseCommand);
+    addRoute("/home",      postBaseCommand);
+    addRoute("/stop",      postBaseCommand);
+    addRoute("/release",   postBaseCommand);
+    addRoute("/reboot",    postReboot);
 
     // Web server setup - PUT commands with argument
-    HttpServer.on("/step",   putIntegerCommand);
-    HttpServer.on("/move",   putFloatCommand);
-    HttpServer.on("/stepto", putIntegerCommand);
-    HttpServer.on("/moveto", putFloatCommand);
-    HttpServer.on("/track",  putIntegerCommand);
+    addRoute("/step",   putIntegerCommand);
+    addRoute("/move",   putFloatCommand);
+    addRoute("/stepto", putIntegerCommand);
+    addRoute("/moveto", putFloatCommand);
+    addRoute("/track",  putStringCommand);
 
-    // Upload the application settings.
-    HttpServer.on("/appsettings.json", postSettings);
+    // Web server setup - PUT coordinated move (all axes)
+    addRoute("/stepall", putLinearCommand);
 
-    HttpServer.onNotFound(notFound);
+    // Export the move history (CSV or JSON).
+    addRoute("/history", HTTP_GET, getHistory);
 
-    HttpServer.begin(Settings.Server.Http);
+    // Export the metrics (Prometheus text format).
+    addRoute("/metrics", HTTP_GET, getMetrics);
+    addRoute("/profile", HTTP_GET, getProfile);
+
+    // Upload the application settings (streamed to a temporary file).
+    addRoute("/appsettings.json", HTTP_POST, postSettings, uploadSettings);
+
+    HttpServer.onNotFound(notFound);
 
 #pragma endregion
 
@@ -390,45 +543,24 @@ void setup()
     Telnet.onDisconnect(onTelnetDisconnect);
     Telnet.onInputReceived(onTelnetInput);
 
-    if (!Telnet.begin(Settings.Server.Telnet))
-    {
-        Serial.println("Setup failed!");
-
-        // Don't continue, just indicate the error.
-        Led.pattern(3, 3);
+#pragma endregion
 
-        while (true)
-            Led.update();
-    }
+#pragma region Initialize WiFi
 
-    // Show TCP server info.
-    ServerInfo serverInfo;
-    Serial.print(serverInfo.toString());
+    // Start the network in the background (the servers are started when the network is available).
+    Network.onStateChanged(onNetworkState);
+    Network.begin();
 
 #pragma endregion
 
-#pragma region Initialize Timer
+    // Indicate setup end (the time from power-on until commands are accepted, the network is still starting).
+    Metrics.BootTime.set(millis() / 1000.0f);
+    Serial.println(String("Setup completed in ") + millis() + " ms.");
 
-    // Initialize timer with maximum frequency (100 kHz).
-    if (Timer.setFrequency(Actuator.FREQUENCY, TimerHandler))
+    if (Network.getState() != Wireless::FAILED)
     {
-        Serial.println("Starting Stepper Timer OK");
+        Led.pattern(1, 1);
     }
-    else
-    {
-        Serial.println("Can't set Stepper Timer.");
-
-        // Don't continue, just indicate the error.
-        Led.pattern(1, 5);
-
-        while (true)
-            Led.update();
-    }
-
-#pragma endregion
-
-    // Indicate setup end.
-    Led.pattern(1, 1);
 }
 
 #pragma endregion
@@ -437,14 +569,18 @@ void setup()
 
 /// <summary>
 /// Arduino loop function. Gets called continuosly to update input, output, and other operations.
+/// Every call runs a single scheduler pass (all due periodic tasks and the background tasks, see TaskScheduler).
 /// </summary>
 void loop()
 {
-    Led.update();
-    Inputs.run();
-    UserIO.run();
-    Telnet.loop();
-    HttpServer.handleClient();
+    unsigned long start = micros();
+
+    Scheduler.run();
+
+    uint32_t elapsed = micros() - start;
+
+    Metrics.LoopTime.observe(elapsed);
+    Profiler.record(PROFILE_LOOP, elapsed);
 }
 
 #pragma endregion
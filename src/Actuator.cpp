@@ -11,16 +11,50 @@
 // --------------------------------------------------------------------------------------------------------------------
 #include <ArduinoJson.h>
 
+#include <hardware/structs/systick.h>
+#include <hardware/sync.h>
+
 #include "Actuator.h"
 #include "Commands.h"
 #include "AppSettings.h"
+#include "GpioInputs.h"
+#include "Metrics.h"
+#include "JsonArena.h"
+#include "MoveHistory.h"
+#include "PositionStore.h"
+#include "StepEngine.h"
 
 // Externals (globals) and callback routines.
 extern AppSettings Settings;
 extern CommandsClass Commands;
+extern GpioInputs Inputs;
 extern LinearActuator Actuator;
+extern MetricsClass Metrics;
+extern MoveHistory History;
+extern PositionStore Positions;
+extern StepEngine Engine;
 extern bool TimerHandler(struct repeating_timer* t);
 
+/// <summary>
+/// Step train callback (DMA interrupt) forwarding the completed steps to the actuator.
+/// </summary>
+/// <param name="steps">The number of completed steps.</param>
+static void onStepTrain(uint32_t steps)
+{
+    Actuator.onSteps(steps);
+}
+
+/// <summary>
+/// Divides and rounds to the nearest integer (halfway values away from zero).
+/// </summary>
+/// <param name="value">The dividend.</param>
+/// <param name="divisor">The (positive) divisor.</param>
+/// <returns>The rounded quotient.</returns>
+static int64_t divideRounded(int64_t value, int64_t divisor)
+{
+    return (value < 0) ? (value - divisor / 2) / divisor : (value + divisor / 2) / divisor;
+}
+
 String LinearActuator::_getTimeUTC()
 {
     time_t now = time(nullptr);
@@ -35,7 +69,7 @@ String LinearActuator::_getTimeUTC()
 /// </summary>
 void LinearActuator::_ccw()
 {
-    digitalWrite(_DIR, HIGH);
+    _dirOutput.set();
     _direction = LinearActuator::Direction::CCW;
 }
 
@@ -44,30 +78,72 @@ void LinearActuator::_ccw()
 /// </summary>
 void LinearActuator::_cw()
 {
-    digitalWrite(_DIR, LOW);
+    _dirOutput.clr();
     _direction = LinearActuator::Direction::CW;
 }
 
+/// <summary>
+/// Sets the stepper driver direction for the target. The direction pin is set ahead of the first pulse.
+/// </summary>
+void LinearActuator::_setDirection()
+{
+    if (_position < _target)
+    {
+        if (_direction != LinearActuator::Direction::CW)
+        {
+            _cw();
+            sleep_ms(DIR_DELAY);
+        }
+    }
+    else if (_position > _target)
+    {
+        if (_direction != LinearActuator::Direction::CCW)
+        {
+            _ccw();
+            sleep_ms(DIR_DELAY);
+        }
+    }
+}
+
+/// <summary>
+/// Gets the settings of an additional axis (axis index 1..).
+/// </summary>
+/// <returns>The axis settings.</returns>
+AppSettings::AxisSettings& LinearActuator::_getAxisSettings()
+{
+    return Settings.Axes.Axis[_axis - 1];
+}
+
+/// <summary>
+/// Precomputes the scale factor (steps per full rotation including microsteps) used by the conversions.
+/// This is called whenever the microsteps or the rotation settings are changed.
+/// </summary>
+void LinearActuator::_updateScale()
+{
+    _stepsPerRevolution = long(_stepsPerRotation) * _microsteps;
+}
+
 /// <summary>
 /// Gets the speed in steps per second from number of (10 usec) intervals.
 /// Note that the speed is kept within the minimum and maximum speed range.
 /// </summary>
 /// <param name="value">The number of intervals.</param>
 /// <returns>The speed in steps per second.</returns>
-float LinearActuator::_getSpeedFromIntervals(uint value)
+StepSpeed LinearActuator::_getSpeedFromIntervals(uint value)
 {
-    float speed = (value > 0) ? float(LinearActuator::FREQUENCY / value) : 0;
-    return max(LinearActuator::FREQUENCY / INT_MAX, min(LinearActuator::MAX_SPEED, speed));
+    StepSpeed speed = StepSpeed::fromRaw((value > 0) ? (FREQUENCY << 8) / value : 0);
+    return max(MIN_SPEED, min(MAX_SPEED, speed));
 }
 
 /// <summary>
 /// Gets the number of (10 usec) intervals from the speed in steps per seconds.
+/// The frequency is scaled as the speed (Q24.8), so a single (hardware) 32 bit division is used.
 /// </summary>
 /// <param name="value">The speed in steps per second.</param>
 /// <returns>The number of intervals.</returns>
-uint LinearActuator::_getIntervalsFromSpeed(float value)
+uint LinearActuator::_getIntervalsFromSpeed(StepSpeed value)
 {
-    uint intervals = (value > 0) ? uint(LinearActuator::FREQUENCY / value) : 0;
+    uint intervals = (value.raw() > 0) ? (FREQUENCY << 8) / uint(value.raw()) : 0;
     return max(2, min(INT_MAX, intervals));
 }
 
@@ -76,9 +152,10 @@ uint LinearActuator::_getIntervalsFromSpeed(float value)
 /// </summary>
 /// <param name="value">The speed in steps per second.</param>
 /// <returns>The speed in RPM.</returns>
-float LinearActuator::_getRPMFromSpeed(float value)
+Rpm LinearActuator::_getRPMFromSpeed(StepSpeed value)
 {
-    return 60.0 * value / (_microsteps * _stepsPerRotation);
+    // Q24.8 steps per second to Q16.16 rotations per minute.
+    return Rpm::fromRaw(divideRounded(int64_t(value.raw()) * 60 * 256, _stepsPerRevolution));
 }
 
 /// <summary>
@@ -86,19 +163,21 @@ float LinearActuator::_getRPMFromSpeed(float value)
 /// </summary>
 /// <param name="value">The speed in RPM.</param>
 /// <returns>The speed in steps per second.</returns>
-float LinearActuator::_getSpeedFromRPM(float value)
+StepSpeed LinearActuator::_getSpeedFromRPM(Rpm value)
 {
-    return value * (_microsteps * _stepsPerRotation) / 60.0;
+    // Q16.16 rotations per minute to Q24.8 steps per second.
+    return StepSpeed::fromRaw(divideRounded(int64_t(value.raw()) * _stepsPerRevolution, 60 * 256));
 }
 
 /// <summary>
-/// Gets the number of steps from distance in mm.
+/// Gets the number of steps from distance in mm. The result is rounded to the nearest step, so the same
+/// distance always maps to the same step position.
 /// </summary>
 /// <param name="value">The distance [mm].</param>
 /// <returns>The number of steps.</returns>
-long LinearActuator::_getStepsFromDistance(float value)
+long LinearActuator::_getStepsFromDistance(Millimetres value)
 {
-    return long(value * (_stepsPerRotation * _microsteps) / _distancePerRotation);
+    return long(divideRounded(int64_t(value.raw()) * _stepsPerRevolution, _distancePerRotation.raw()));
 }
 
 /// <summary>
@@ -106,9 +185,9 @@ long LinearActuator::_getStepsFromDistance(float value)
 /// </summary>
 /// <param name="value">The number of steps.</param>
 /// <returns>The distance [mm].</returns>
-float LinearActuator::_getDistanceFromSteps(long value)
+Millimetres LinearActuator::_getDistanceFromSteps(long value)
 {
-    return float(value * _distancePerRotation / (_stepsPerRotation * _microsteps));
+    return Millimetres::fromRaw(divideRounded(int64_t(value) * _distancePerRotation.raw(), _stepsPerRevolution));
 }
 
 /// <summary>
@@ -142,11 +221,50 @@ bool LinearActuator::_isValidMicrostep(ushort value)
     }
 }
 
+/// <summary>
+/// Gets the maximum speed supported by the step pulse generator.
+/// </summary>
+/// <returns>The maximum speed in steps per second.</returns>
+StepSpeed LinearActuator::_getSpeedLimit()
+{
+    return (_driver == DRIVER_PIO) ? StepPlanner::MAX_SPEED : MAX_SPEED;
+}
+
+/// <summary>
+/// Gets the time of a single step at the speed as output by the step pulse generator: a number of timer
+/// intervals (timer interrupt), or a number of PIO ticks (step train). This is used to calculate the exact
+/// move times (see TrackPlanner).
+/// </summary>
+/// <param name="value">The speed in steps per second.</param>
+/// <returns>The step time (nanoseconds).</returns>
+uint32_t LinearActuator::getStepTime(StepSpeed value)
+{
+    if (_driver == DRIVER_PIO)
+    {
+        StepSpeed speed = max(StepPlanner::MIN_SPEED, min(StepPlanner::MAX_SPEED, value));
+        return StepPlanner::decode(StepPlanner::encode(StepPlanner::toPeriod(speed))) * (1000000000 / StepPlanner::TICK_FREQUENCY);
+    }
+
+    return _getIntervalsFromSpeed(value) * (1000000000 / FREQUENCY);
+}
+
+/// <summary>
+/// Stops the step train (if used) and sets the position to the steps actually output.
+/// This is called from the GPIO interrupt (see halt()) and the main loop.
+/// </summary>
+void LinearActuator::_abortTrain()
+{
+    if (_driver == DRIVER_PIO)
+    {
+        _position = _trainStart + long(_train.abort()) * static_cast<int>(_direction);
+    }
+}
+
 /// <summary>
 /// Gets the current speed in RPM.
 /// </summary>
 /// <returns>The speed [RPM].</returns>
-float  LinearActuator::getRPM()
+Rpm    LinearActuator::getRPM()
 {
     return _getRPMFromSpeed(_speed);
 }
@@ -155,7 +273,7 @@ float  LinearActuator::getRPM()
 /// Gets the current speed in steps per second.
 /// </summary>
 /// <returns>The speed [steps per second].</returns>
-float  LinearActuator::getSpeed()
+StepSpeed LinearActuator::getSpeed()
 {
     return _speed;
 }
@@ -174,17 +292,17 @@ float  LinearActuator::getElapsed()
 /// Gets the current percentage of the move.
 /// </summary>
 /// <returns>The move percentage.</returns>
-float  LinearActuator::getPercentage()
+Percent LinearActuator::getPercentage()
 {
-    if (_steps > 0) return 100.0f * (1.0f - (float(abs(_target - _position)) / float(_steps)));
-    return 0.0f;
+    if (_steps > 0) return Percent::fromRaw(int64_t(_steps - abs(_target - _position)) * 100 * Percent::ONE / _steps);
+    return Percent();
 }
 
 /// <summary>
 /// Gets the minimum speed.
 /// </summary>
 /// <returns>The minimum speed.</returns>
-float  LinearActuator::getMinSpeed()
+StepSpeed LinearActuator::getMinSpeed()
 {
     return _minspeed;
 }
@@ -194,7 +312,7 @@ float  LinearActuator::getMinSpeed()
 /// </summary>
 /// <param name="value">The minimum speed [steps per second].</param>
 /// <returns>A command specific message.</returns>
-String LinearActuator::setMinSpeed(float value)
+String LinearActuator::setMinSpeed(StepSpeed value)
 {
     if (getRunningFlag())
     {
@@ -202,8 +320,8 @@ String LinearActuator::setMinSpeed(float value)
     }
     else
     {
-        _minspeed = max(MIN_SPEED, min(MAX_SPEED, value));
-        return String("Minimum speed set to ") + _maxspeed;
+        _minspeed = max(MIN_SPEED, min(_getSpeedLimit(), value));
+        return String("Minimum speed set to ") + _minspeed.toString();
     }
 }
 
@@ -211,7 +329,7 @@ String LinearActuator::setMinSpeed(float value)
 /// Gets the maximum speed.
 /// </summary>
 /// <returns>The maximum speed.</returns>
-float  LinearActuator::getMaxSpeed()
+StepSpeed LinearActuator::getMaxSpeed()
 {
     return _maxspeed;
 }
@@ -221,7 +339,7 @@ float  LinearActuator::getMaxSpeed()
 /// </summary>
 /// <param name="value">The maximum speed [steps per second].</param>
 /// <returns>A command specific message.</returns>
-String LinearActuator::setMaxSpeed(float value)
+String LinearActuator::setMaxSpeed(StepSpeed value)
 {
     if (getRunningFlag())
     {
@@ -229,8 +347,8 @@ String LinearActuator::setMaxSpeed(float value)
     }
     else
     {
-        _maxspeed = max(MIN_SPEED, min(MAX_SPEED, value));
-        return String("Maximum speed set to ") + _maxspeed;
+        _maxspeed = max(MIN_SPEED, min(_getSpeedLimit(), value));
+        return String("Maximum speed set to ") + _maxspeed.toString();
     }
 }
 
@@ -261,6 +379,51 @@ String LinearActuator::setMaxSteps(long value)
     }
 }
 
+/// <summary>
+/// Gets the step pulse generator.
+/// </summary>
+/// <returns>The driver (DRIVER_TIMER or DRIVER_PIO).</returns>
+uint8_t LinearActuator::getDriver()
+{
+    return _driver;
+}
+
+/// <summary>
+/// Sets the step pulse generator. The PUL pin is connected to the PIO or to the GPIO output,
+/// and the speeds are kept within the range supported by the generator.
+/// </summary>
+/// <param name="value">The driver (DRIVER_TIMER or DRIVER_PIO).</param>
+/// <returns>A command specific message.</returns>
+String LinearActuator::setDriver(uint8_t value)
+{
+    if (getRunningFlag())
+    {
+        return String("Still moving - ignoring set driver request");
+    }
+    else if (value == DRIVER_PIO)
+    {
+        if (!_train.isReady())
+        {
+            return String("PIO step train not available - using the timer interrupt");
+        }
+
+        _driver = DRIVER_PIO;
+        _train.attach();
+
+        return String("Driver set to PIO");
+    }
+    else
+    {
+        _driver = DRIVER_TIMER;
+        _train.detach();
+
+        _minspeed = min(_minspeed, MAX_SPEED);
+        _maxspeed = min(_maxspeed, MAX_SPEED);
+
+        return String("Driver set to Timer");
+    }
+}
+
 /// <summary>
 /// Gets the microsteps.
 /// </summary>
@@ -286,6 +449,7 @@ String LinearActuator::setMicrosteps(ushort value)
         if (_isValidMicrostep(value))
         {
             _microsteps = max(1, value);
+            _updateScale();
             return String("Microsteps set to ") + _microsteps;
         }
         else
@@ -304,6 +468,31 @@ long   LinearActuator::getPosition()
     return _position;
 }
 
+/// <summary>
+/// Gets the track at the current position. For axis 0 the yard track table is searched (binary search),
+/// the additional axes have a few numbered tracks only.
+/// </summary>
+/// <returns>The track name (empty if between tracks).</returns>
+String LinearActuator::getTrack()
+{
+    long position = _position;
+
+    if (_axis == 0)
+    {
+        int index = Settings.Yard.findTrack(position);
+        return (index >= 0) ? Settings.Yard.Tracks[index].Name : String();
+    }
+
+    const auto& tracks = _getAxisSettings().Tracks;
+
+    for (size_t i = 0; i < tracks.size(); i++)
+    {
+        if (labs(position - tracks[i]) <= AppSettings::YardSettings::TRACK_WINDOW) return String(i);
+    }
+
+    return String();
+}
+
 /// <summary>
 /// Gets the remaining steps to reach the target.
 /// </summary>
@@ -339,7 +528,7 @@ String LinearActuator::setTarget(long value)
 /// Gets the current position in mm.
 /// </summary>
 /// <returns>The position [mm].</returns>
-float  LinearActuator::getDistance()
+Millimetres LinearActuator::getDistance()
 {
     return  _getDistanceFromSteps(_position);
 }
@@ -357,9 +546,9 @@ LinearActuator::Direction LinearActuator::getDirection()
 /// Gets the retract distance in mm.
 /// </summary>
 /// <returns>The retract distance.</returns>
-float  LinearActuator::getRetract()
+Millimetres LinearActuator::getRetract()
 {
-    return Settings.Actuator.Retract;
+    return Millimetres::fromFloat(Settings.Actuator.Retract);
 }
 
 /// <summary>
@@ -367,19 +556,19 @@ float  LinearActuator::getRetract()
 /// </summary>
 /// <param name="value">The retract distance [mm].</param>
 /// <returns>A command specific message.</returns>
-String LinearActuator::setRetract(float value)
+String LinearActuator::setRetract(Millimetres value)
 {
-    Settings.Actuator.Retract = max(0, value);
-    return String("Retract distance set to ") + value;
+    Settings.Actuator.Retract = max(Millimetres(), value).toFloat();
+    return String("Retract distance set to ") + value.toString();
 }
 
 /// <summary>
 /// Gets the minimum step distance in mm.
 /// </summary>
 /// <returns>The minimum step distance.</returns>
-float  LinearActuator::getMinStep()
+Millimetres LinearActuator::getMinStep()
 {
-    return Settings.Actuator.MinStep;
+    return Millimetres::fromFloat(Settings.Actuator.MinStep);
 }
 
 /// <summary>
@@ -387,19 +576,19 @@ float  LinearActuator::getMinStep()
 /// </summary>
 /// <param name="value">The minimum step distance [mm].</param>
 /// <returns>A command specific message.</returns>
-String LinearActuator::setMinStep(float value)
+String LinearActuator::setMinStep(Millimetres value)
 {
-    Settings.Actuator.MinStep = max(0, value);
-    return String("Minimum step distance set to ") + value;
+    Settings.Actuator.MinStep = max(Millimetres(), value).toFloat();
+    return String("Minimum step distance set to ") + value.toString();
 }
 
 /// <summary>
 /// Gets the small step distance in mm.
 /// </summary>
 /// <returns>The small step distance.</returns>
-float  LinearActuator::getSmallStep()
+Millimetres LinearActuator::getSmallStep()
 {
-    return Settings.Actuator.SmallStep;
+    return Millimetres::fromFloat(Settings.Actuator.SmallStep);
 }
 
 /// <summary>
@@ -407,10 +596,10 @@ float  LinearActuator::getSmallStep()
 /// </summary>
 /// <param name="value">The small step distance [mm].</param>
 /// <returns>A command specific message.</returns>
-String LinearActuator::setSmallStep(float value)
+String LinearActuator::setSmallStep(Millimetres value)
 {
-    Settings.Actuator.SmallStep = max(0, value);
-    return String("Small step distance set to ") + value;
+    Settings.Actuator.SmallStep = max(Millimetres(), value).toFloat();
+    return String("Small step distance set to ") + value.toString();
 }
 
 /// <summary>
@@ -467,31 +656,128 @@ bool   LinearActuator::getCalibratedFlag()
     return _calibrated;
 }
 
+/// <summary>
+/// Gets the halted flag (halted by an input interrupt, stop() not yet called).
+/// </summary>
+/// <returns>The flag value.</returns>
+bool   LinearActuator::getHaltedFlag()
+{
+    return _halted;
+}
+
+/// <summary>
+/// Gets the restored flag (the position has been restored from the position record at boot).
+/// </summary>
+/// <returns>The flag value.</returns>
+bool   LinearActuator::getRestoredFlag()
+{
+    return _restored;
+}
+
+/// <summary>
+/// Gets the homing phase name.
+/// </summary>
+/// <returns>The homing phase.</returns>
+String LinearActuator::getHoming()
+{
+    switch (_homing)
+    {
+    case HOMING_FAST:    return "Fast";
+    case HOMING_BACKOFF: return "Backoff";
+    case HOMING_SLOW:    return "Slow";
+    case HOMING_CLEAR:   return "Clear";
+    default:             return "Idle";
+    }
+}
+
 /// <summary>
 /// Initialize the stepper instance using the application settings.
 /// Enable the driver and allow acceleration and deceleration.
+/// The additional axes (axis index 1..) have no LEDs and no alarm input, and use the timer interrupt only.
 /// </summary>
-void LinearActuator::init()
+/// <param name="axis">The axis index.</param>
+void LinearActuator::init(uint8_t axis)
 {
+    _axis = axis;
+
     // Set output and inut pin numbers.
-    _PUL = Settings.Stepper.PinPUL;
-    _DIR = Settings.Stepper.PinDIR;
-    _ENA = Settings.Stepper.PinENA;
-    _ALM = Settings.Stepper.PinALM;
+    if (_axis == 0)
+    {
+        _PUL = Settings.Stepper.PinPUL;
+        _DIR = Settings.Stepper.PinDIR;
+        _ENA = Settings.Stepper.PinENA;
+        _ALM = Settings.Stepper.PinALM;
+    }
+    else
+    {
+        _PUL = _getAxisSettings().PinPUL;
+        _DIR = _getAxisSettings().PinDIR;
+        _ENA = _getAxisSettings().PinENA;
+        _ALM = NUM_BANK0_GPIOS;
+    }
+
+    // Set the output masks (the pins are configured as outputs in setup()).
+    _pulOutput.init(_PUL);
+    _dirOutput.init(_DIR);
+    _enaOutput.init(_ENA);
+
+    _ledRunning.init((_axis == 0) ? Settings.Actuator.LedRunning : NUM_BANK0_GPIOS);
+    _ledInLimit.init((_axis == 0) ? Settings.Actuator.LedInLimit : NUM_BANK0_GPIOS);
+    _ledAlarmOn.init((_axis == 0) ? Settings.Actuator.LedAlarmOn : NUM_BANK0_GPIOS);
+
+    // Select the timer routine for the PUL pin (compile time pin mask).
+    _timerRoutine = selectForPin<TimerRoutineSelector>(_PUL);
+
+    // Prepare the PIO step train (used if selected in the settings).
+    if (_axis == 0) _train.init(_PUL, onStepTrain);
 
     // Set stepper settings.
-    setMinSpeed(Settings.Stepper.MinSpeed);
-    setMaxSpeed(Settings.Stepper.MaxSpeed);
+    apply();
+
+    // Reset position (restore the last stopped position) and enable outputs.
+    reset();
+    if (_axis == 0) _restorePosition();
+    enable();
+}
+
+/// <summary>
+/// Applies the stepper settings (speed, ramp, microsteps, and rotation) from the application settings.
+/// This is used for live updates, the position is not reset. Pin numbers are only used in init().
+/// Note that the settings are ignored if the stepper is still moving.
+/// </summary>
+void LinearActuator::apply()
+{
+    if (_axis > 0)
+    {
+        AppSettings::AxisSettings& settings = _getAxisSettings();
+
+        // The additional axes are driven by the timer interrupt (step engine).
+        _driver = DRIVER_TIMER;
+
+        setMinSpeed(StepSpeed::fromFloat(settings.MinSpeed));
+        setMaxSpeed(StepSpeed::fromFloat(settings.MaxSpeed));
+        setMaxSteps(settings.MaxSteps);
+        setMicrosteps(settings.MicroSteps);
+
+        if (settings.StepsPerRotation > 0) _stepsPerRotation = settings.StepsPerRotation;
+        if (settings.DistancePerRotation > 0) _distancePerRotation = Millimetres::fromFloat(settings.DistancePerRotation);
+
+        _updateScale();
+        return;
+    }
+
+    setDriver(Settings.Stepper.Driver);
+    setMinSpeed(StepSpeed::fromFloat(Settings.Stepper.MinSpeed));
+    setMaxSpeed(StepSpeed::fromFloat(Settings.Stepper.MaxSpeed));
     setMaxSteps(Settings.Stepper.MaxSteps);
     setMicrosteps(Settings.Stepper.MicroSteps);
 
     // Set fixed stepper settings.
     if (Settings.Stepper.StepsPerRotation > 0) _stepsPerRotation = Settings.Stepper.StepsPerRotation;
-    if (Settings.Stepper.DistancePerRotation > 0) _distancePerRotation = Settings.Stepper.DistancePerRotation;
+    if (Settings.Stepper.DistancePerRotation > 0) _distancePerRotation = Millimetres::fromFloat(Settings.Stepper.DistancePerRotation);
 
-    // Reset position and enable outputs.
-    reset();
-    enable();
+    // Precompute the scale factor for the conversions.
+    _updateScale();
 }
 
 /// <summary>
@@ -499,14 +785,26 @@ void LinearActuator::init()
 /// </summary>
 void LinearActuator::update()
 {
-    Settings.Actuator.Retract   = getRetract();
-    Settings.Actuator.MinStep   = getMinStep();
-    Settings.Actuator.SmallStep = getSmallStep();
+    if (_axis > 0)
+    {
+        AppSettings::AxisSettings& settings = _getAxisSettings();
 
-    Settings.Stepper.MinSpeed   = getMinSpeed();
-    Settings.Stepper.MaxSpeed   = getMaxSpeed();
+        settings.MinSpeed   = getMinSpeed().toFloat();
+        settings.MaxSpeed   = getMaxSpeed().toFloat();
+        settings.MaxSteps   = getMaxSteps();
+        settings.MicroSteps = getMicrosteps();
+        return;
+    }
+
+    Settings.Actuator.Retract   = getRetract().toFloat();
+    Settings.Actuator.MinStep   = getMinStep().toFloat();
+    Settings.Actuator.SmallStep = getSmallStep().toFloat();
+
+    Settings.Stepper.MinSpeed   = getMinSpeed().toFloat();
+    Settings.Stepper.MaxSpeed   = getMaxSpeed().toFloat();
     Settings.Stepper.MaxSteps   = getMaxSteps();
     Settings.Stepper.MicroSteps = getMicrosteps();
+    Settings.Stepper.Driver     = getDriver();
 }
 
 /// <summary>
@@ -514,7 +812,7 @@ void LinearActuator::update()
 /// </summary>
 void LinearActuator::enable()
 {
-    digitalWrite(_ENA, LOW);
+    _enaOutput.clr();
     _enabled = true;
 }
 
@@ -523,20 +821,32 @@ void LinearActuator::enable()
 /// </summary>
 void LinearActuator::disable()
 {
-    // Clear the running flag.
+    // Clear the running flag (before the step train is stopped) and count an interrupted move as aborted.
+    bool running = _running;
     _running = false;
-    digitalWrite(_PUL, LOW);
+
+    if (running)
+    {
+        _abortTrain();
+        _endMove(_alarm ? MoveHistory::OUTCOME_ALARM : MoveHistory::OUTCOME_STOPPED);
+        Metrics.MovesAborted.inc();
+    }
+
+    if (_driver == DRIVER_TIMER) _pulOutput.clr();
 
     // Clear the enabled flag.
     _enabled = false;
-    digitalWrite(_ENA, HIGH);
+    _enaOutput.set();
 
     _target  = _position;
-    _speed   = 0.0f;
+    _speed   = StepSpeed();
     _steps   = 0;
     _start   = 0;
     _n = 0;
 
+    _follower = false;
+    _pending  = 0;
+
     // Clear the stopped flag.
     _stopped = false;
 }
@@ -544,26 +854,63 @@ void LinearActuator::disable()
 
 /// <summary>
 /// Stops the move immediately. Resets the target to the current position.
+/// This also completes a move halted by an input interrupt (see halt()).
 /// </summary>
 void LinearActuator::stop()
 {
     // Get the elapsed time, clear the running flag and set the stopped flag.
-    if (_running)
+    if (_running || _halted)
     {
-        _elapsed = float(millis() - _start) / 1000.0f;
+        // Clear the running flag before the step train is stopped (see onTimer).
+        bool running = _running;
         _running = false;
+
+        if (running) _abortTrain();
+
+        _endMove(_getStopOutcome());
+        _elapsed = float(millis() - _start) / 1000.0f;
+        _halted  = false;
         _stopped = true;
 
-        digitalWrite(_PUL, LOW);
+        if (_driver == DRIVER_TIMER) _pulOutput.clr();
+        Metrics.MovesAborted.inc();
 
         _target = _position;
-        _speed = 0.0f;
+        _speed = StepSpeed();
         _steps = 0;
         _start = 0;
         _n = 0;
+
+        _follower = false;
+        _pending  = 0;
     }
 }
 
+/// <summary>
+/// Stops the pulse generation immediately. This is called from the GPIO interrupt of the safety inputs,
+/// so only the running flag and the pulse output are changed. The position at the input edge is latched
+/// (exact to the step, as the step timer interrupt cannot preempt the GPIO interrupt). The move is
+/// completed (target, counters, metrics) by calling stop() from the main loop.
+/// </summary>
+/// <param name="pin">The input pin number.</param>
+/// <returns>True if a running move has been halted.</returns>
+bool LinearActuator::halt(uint8_t pin)
+{
+    if (!_running)
+        return false;
+
+    _running = false;
+
+    if (_driver == DRIVER_PIO) _abortTrain();
+    else _pulOutput.clr();
+
+    _latchPosition = _position;
+    _latchPin = pin;
+    _halted = true;
+
+    return true;
+}
+
 /// <summary>
 /// Sets the target to zero (home).
 /// </summary>
@@ -586,7 +933,7 @@ String LinearActuator::reset()
     }
 
     _n = 0;
-    _speed = 0.0f;
+    _speed = StepSpeed();
     _steps = 0;
     _start = 0;
     _target   = 0;
@@ -608,23 +955,39 @@ String LinearActuator::reset()
 String LinearActuator::moveAway()
 {
     Direction direction = getDirection();
-    return moveRelativeDistance((-1.0f) * Settings.Actuator.Retract * float(static_cast<int>(direction)));
+    return moveRelativeDistance(-getRetract() * static_cast<int>(direction));
 }
 
 /// <summary>
-/// Move to specified track (0..9).
+/// Move to specified track. The yard tracks (axis 0) are selected by name or number (position order),
+/// the tracks of an additional axis by number (0..9).
 /// </summary>
-/// <param name="value">The track number.</param>
+/// <param name="track">The track name or number.</param>
 /// <returns>A command specific message.</returns>
-String LinearActuator::moveTrack(uint8_t value)
+String LinearActuator::moveTrack(const String& track)
 {
-    if (value >= 0 && value < Settings.Yard.Tracks.size())
+    if (_axis == 0)
     {
-        return Actuator.moveAbsolute(Settings.Yard.Tracks[value]);
+        int index = Settings.Yard.parseTrack(track);
+
+        if (index < 0)
+        {
+            return String("Unknown track '") + track + "'";
+        }
+
+        return moveAbsolute(Settings.Yard.Tracks[index].Position);
+    }
+
+    const auto& tracks = _getAxisSettings().Tracks;
+    long value = track.toInt();
+
+    if ((track == String(value)) && (value >= 0) && (value < long(tracks.size())))
+    {
+        return moveAbsolute(tracks[value]);
     }
     else
     {
-        return String("Track number out of range [0..") + (Settings.Yard.Tracks.size() - 1) + "]";
+        return String("Track number out of range [0..") + (tracks.size() - 1) + "]";
     }
 }
 
@@ -642,12 +1005,22 @@ String LinearActuator::moveAbsolute(long value)
         return String("Still moving - ignoring move request");
     }
 
+    // The not clean position record must be written before the pulses start (see _persistPosition()).
+    if (!_persistPosition(false))
+    {
+        return String("Another axis is running - ignoring move request");
+    }
+
     // Set target and number of steps.
     _target = value;
     _steps = abs(_target - _position);
 
     // Calculate the delta speed from max and min speed values.
-    _deltaspeed = (_maxspeed - _minspeed) / _maxsteps;
+    _deltaspeed = (_maxspeed - _minspeed).convert<SpeedDelta>() / _maxsteps;
+
+    // The move info is calculated using floats (not time critical).
+    float minspeed   = _minspeed.toFloat();
+    float deltaspeed = _deltaspeed.toFloat();
 
     long  conststeps = 0;       // The number of steps with constant (maximum) speed. 
 
@@ -674,7 +1047,7 @@ String LinearActuator::moveAbsolute(long value)
     // Calculate the time for the complete ramp.
     for (int i = 0; i < _maxsteps; i++)
     {
-        maxtime += 1 / (_minspeed + i * _deltaspeed);
+        maxtime += 1 / (minspeed + i * deltaspeed);
     }
 
     if (_rampsteps < 4)
@@ -685,48 +1058,46 @@ String LinearActuator::moveAbsolute(long value)
     // Calculate the ramp time and maximum speed for the actual ramp.
     if (_rampsteps < _maxsteps)
     {
-        maxspeed = _minspeed + _rampsteps * _deltaspeed;
+        maxspeed = minspeed + _rampsteps * deltaspeed;
 
         for (int i = 0; i < _rampsteps; i++)
         {
-            ramptime += 1 / (_minspeed + i * _deltaspeed);
+            ramptime += 1 / (minspeed + i * deltaspeed);
         }
     }
     else
     {
-        maxspeed = _maxspeed;
+        maxspeed = _maxspeed.toFloat();
         ramptime = maxtime;
     }
 
     // Calculate the constant speed time and total time.
-    consttime = conststeps / _maxspeed;
+    consttime = conststeps / _maxspeed.toFloat();
     totaltime = 2 * ramptime + consttime;
-    acceleration = (maxspeed - _minspeed) / ramptime;
+    acceleration = (maxspeed - minspeed) / ramptime;
 
     // First check for direction and delay if changing.
-    if (_position < _target)
-    {
-        if (_direction != LinearActuator::Direction::CW)
-        {
-            _cw();
-            sleep_ms(DIR_DELAY);
-        }
-    }
-    else if (_position > _target)
-    {
-        if (_direction != LinearActuator::Direction::CCW)
-        {
-            _ccw();
-            sleep_ms(DIR_DELAY);
-        }
-    }
+    _setDirection();
+
+    // The position is unknown until the move has ended (the record has been written above).
+    _beginMove();
 
-    // Get start time and set the running flag and clear the stop flag...
+    // Get start time and set the running flag and clear the stop flag (and the latched position)...
+    _latchPin = NO_LATCH;
     _n = 0;
+    _count = 0;
     _elapsed = 0.0f;
     _start = millis();
     _stopped = false;
+
+    if (_driver == DRIVER_PIO)
+    {
+        _trainStart = _position;
+        _train.start(_steps, _rampsteps, _minspeed, _deltaspeed);
+    }
+
     _running = true;
+    Metrics.MovesStarted.inc();
 
     if (_rampsteps < _maxsteps)
     {
@@ -735,9 +1106,9 @@ String LinearActuator::moveAbsolute(long value)
                       "    Target (steps):    " + _target      + "\r\n" +
                       "    Total Steps:       " + _steps       + "\r\n" +
                       "    Direction:         " + _direction   + "\r\n" +
-                      "    Min. Speed:        " + _minspeed    + "\r\n" +
-                      "    Max. Speed:        " + _maxspeed    + "\r\n" +
-                      "    Delta Speed:       " + _deltaspeed  + "\r\n" +
+                      "    Min. Speed:        " + _minspeed.toString()   + "\r\n" +
+                      "    Max. Speed:        " + _maxspeed.toString()   + "\r\n" +
+                      "    Delta Speed:       " + _deltaspeed.toString(4) + "\r\n" +
                       "    Ramp Steps (max):  " + _maxsteps    + "\r\n" +
                       "    Ramp Steps:        " + _rampsteps   + "\r\n" +
                       "    Ramp Speed (max):  " + maxspeed     + "\r\n" +
@@ -753,9 +1124,9 @@ String LinearActuator::moveAbsolute(long value)
                       "    Target (steps):    " + _target      + "\r\n" +
                       "    Total Steps:       " + _steps       + "\r\n" +
                       "    Direction:         " + _direction   + "\r\n" +
-                      "    Min. Speed:        " + _minspeed    + "\r\n" +
-                      "    Max. Speed:        " + _maxspeed    + "\r\n" +
-                      "    Delta Speed:       " + _deltaspeed  + "\r\n" +
+                      "    Min. Speed:        " + _minspeed.toString()   + "\r\n" +
+                      "    Max. Speed:        " + _maxspeed.toString()   + "\r\n" +
+                      "    Delta Speed:       " + _deltaspeed.toString(4) + "\r\n" +
                       "    Ramp Steps (max):  " + _maxsteps    + "\r\n" +
                       "    Ramp Time (max):   " + maxtime      + "\r\n" +
                       "    Acceleration:      " + acceleration + "\r\n" +
@@ -780,18 +1151,77 @@ String LinearActuator::moveRelative(long value)
 /// </summary>
 /// <param name="value">The distance [mm].</param>
 /// <returns>A command specific message.</returns>
-String LinearActuator::moveAbsoluteDistance(float value)
+String LinearActuator::moveAbsoluteDistance(Millimetres value)
 {
     return moveAbsolute(_getStepsFromDistance(value));
 }
 
 /// <summary>
-/// Sets the target relative to the current position.
+/// Sets the target relative to the current position. The target is calculated from the absolute
+/// distance, so the rounding error does not accumulate over several relative moves.
 /// </summary>
 /// <param name="value">The distance [mm].</param>
-String LinearActuator::moveRelativeDistance(float value)
+String LinearActuator::moveRelativeDistance(Millimetres value)
+{
+    return moveAbsolute(_getStepsFromDistance(_getDistanceFromSteps(_position) + value));
+}
+
+/// <summary>
+/// Starts a move to the absolute position as follower in a coordinated move. No pulses are generated until
+/// the step engine requests a step (see follow()), the speed follows the axis running the speed profile.
+/// The move ends when the target has been reached.
+/// </summary>
+/// <param name="value">The number of steps.</param>
+/// <returns>A command specific message.</returns>
+String LinearActuator::moveFollow(long value)
+{
+    // Do not move if still moving.
+    if (getRunningFlag())
+    {
+        return String("Still moving - ignoring move request");
+    }
+
+    if (_driver != DRIVER_TIMER)
+    {
+        return String("Following requires the timer driver - ignoring move request");
+    }
+
+    if (!_persistPosition(false))
+    {
+        return String("Another axis is running - ignoring move request");
+    }
+
+    _target = value;
+    _steps = abs(_target - _position);
+
+    _setDirection();
+    _beginMove();
+
+    _latchPin = NO_LATCH;
+    _n = 0;
+    _count = 0;
+    _pending = 0;
+    _follower = true;
+    _elapsed = 0.0f;
+    _start = millis();
+    _stopped = false;
+
+    _running = true;
+    Metrics.MovesStarted.inc();
+
+    return String("Following to ") + _target + " (" + _steps + " steps)";
+}
+
+/// <summary>
+/// Sets the target to the position after the requested steps (follower). This is called by the step engine
+/// when the axis running the speed profile has ended (stopped or halted), so the follower ends as well.
+/// </summary>
+void LinearActuator::release()
 {
-    return moveRelative(_getStepsFromDistance(value));
+    if (_follower && _running)
+    {
+        _target = _position + (_pending + _count) * static_cast<int>(_direction);
+    }
 }
 
 /// <summary>
@@ -818,8 +1248,21 @@ void LinearActuator::alarmOff(uint8_t pin)
 /// </summary>
 void LinearActuator::switchOn(uint8_t pin)
 {
+    // While homing limit switch 1 is handled by the homing routine (see run()).
+    if ((_homing != HOMING_IDLE) && (pin == Settings.Actuator.SwitchLimit1))
+    {
+        _limit = true;
+        return;
+    }
+
     stop();
 
+    // Limit switch 2 should not be hit while homing (abort).
+    if ((_homing != HOMING_IDLE) && (pin == Settings.Actuator.SwitchLimit2))
+    {
+        _endHoming(false);
+    }
+
     // The stop switch has been turned on (disable stepper motor).
     if (pin == Settings.Actuator.SwitchStop)
     {
@@ -842,56 +1285,371 @@ void LinearActuator::switchOff(uint8_t pin)
     {
         enable();
     }
-    else if (pin == Settings.Actuator.SwitchLimit1)
+    else if ((pin == Settings.Actuator.SwitchLimit1) || (pin == Settings.Actuator.SwitchLimit2))
     {
         _limit = false;
+    }
+}
 
-        // If calibrating, reset current position to new home position (zero).
-        if (_calibrating)
-        {
-            reset();
-            _calibrated = true;
-            _calibrating = false;
-        }
+/// <summary>
+/// Start the calibration (homing) routine by moving in negative direction (actuator length).
+/// Eventually the first limit switch should be engaged near the home position. The homing is
+/// continued in run() (see there for the phases).
+/// </summary>
+String LinearActuator::calibrate()
+{
+    // Do not move if still moving.
+    if (getRunningFlag())
+    {
+        return String("Still moving - ignoring calibrate request");
     }
-    else if (pin == Settings.Actuator.SwitchLimit2)
+
+    // The limit switches are connected to axis 0 only.
+    if (_axis > 0)
     {
-        _limit = false;
+        return String("Calibration is only supported on axis 0 - ignoring calibrate request");
+    }
+
+    // Both limit switches active is a wiring fault (the retract would move towards limit switch 2).
+    if (Inputs.SwitchLimit1.Active && Inputs.SwitchLimit2.Active)
+    {
+        return String("Both limit switches are active - ignoring calibrate request");
+    }
+
+    _calibrating = true;
+    _calibrated  = false;
 
-        // If calibrating, stop calibrating (this should not happen).
-        if (_calibrating)
+    // If limit switch 1 is already active, start with the retract (the switch edge is needed).
+    // The limit flag is also set by limit switch 2, so the debounced state of limit switch 1 is used.
+    // With only limit switch 2 active the fast search moves away from it towards limit switch 1.
+    if (Inputs.SwitchLimit1.Active)
+    {
+        _homing = HOMING_BACKOFF;
+        _homingSince = 0;
+
+        return _moveSlow(_getStepsFromDistance(getRetract()));
+    }
+
+    _homing = HOMING_FAST;
+
+    return moveRelativeDistance(-Millimetres::fromFloat(Settings.Actuator.Length));
+}
+
+/// <summary>
+/// Moves the relative distance at minimum speed (no ramp).
+/// </summary>
+/// <param name="value">The number of steps.</param>
+/// <returns>A command specific message.</returns>
+String LinearActuator::_moveSlow(long value)
+{
+    // The speed delta is calculated at the start of the move, so the maximum speed can be restored.
+    StepSpeed maxspeed = _maxspeed;
+    _maxspeed = _minspeed;
+    String result = moveRelative(value);
+    _maxspeed = maxspeed;
+
+    return result;
+}
+
+/// <summary>
+/// Ends the homing routine.
+/// </summary>
+/// <param name="success">True if the home position has been set.</param>
+void LinearActuator::_endHoming(bool success)
+{
+    _homing = HOMING_IDLE;
+    _calibrating = false;
+    _calibrated  = success;
+}
+
+/// <summary>
+/// Advances the homing routine (called from the main loop). The position is latched by the step
+/// engine at the limit switch edge (see halt()), so the switch debounce does not affect the accuracy.
+///
+///     HOMING_FAST     - Fast approach to limit switch 1 (normal profile, actuator length).
+///     HOMING_BACKOFF  - Retract from limit switch 1 (retract distance).
+///     HOMING_SLOW     - Slow re-approach at minimum speed (twice the retract distance).
+///                       The position latched at the switch edge becomes the (refined) zero.
+///     HOMING_CLEAR    - Retract from limit switch 1, the calibration has been completed.
+///
+/// Homing is aborted if a move ends without reaching the switch, if the switch is still active after
+/// a retract, or if the stepper has been disabled (stop switch, alarm).
+/// </summary>
+void LinearActuator::run()
+{
+    _updateLeds();
+    _recordMove();
+
+    // Persist the position after a move has ended (or the position has been reset or calibrated).
+    // This is retried every loop, the record is written once all axes are idle (see _persistPosition()).
+    if (!_running && !_halted) _persistPosition(true);
+
+    // Wait for the move to end, and for a halted move to be completed (see GpioInputs::run()).
+    if ((_homing == HOMING_IDLE) || _running || _halted)
+        return;
+
+    if (!_enabled)
+    {
+        _endHoming(false);
+        return;
+    }
+
+    long retract = _getStepsFromDistance(getRetract());
+    bool latched = (_latchPin == Settings.Actuator.SwitchLimit1);
+
+    switch (_homing)
+    {
+    case HOMING_FAST:
+        if (latched)
+        {
+            _moveSlow(retract);
+            _homing = HOMING_BACKOFF;
+            _homingSince = 0;
+        }
+        else
         {
-            _calibrated = false;
-            _calibrating = false;
+            _endHoming(false);
         }
+        break;
+
+    case HOMING_BACKOFF:
+    case HOMING_CLEAR:
+        // Wait until the debounced switch state has settled.
+        if (_homingSince == 0)
+        {
+            _homingSince = millis();
+        }
+        else if (millis() - _homingSince >= HOMING_SETTLE)
+        {
+            if (Inputs.SwitchLimit1.Active)
+            {
+                _endHoming(false);
+            }
+            else if (_homing == HOMING_CLEAR)
+            {
+                _endHoming(true);
+            }
+            else
+            {
+                _moveSlow(-2 * retract);
+                _homing = HOMING_SLOW;
+            }
+        }
+        break;
+
+    case HOMING_SLOW:
+        if (latched)
+        {
+            // Set the latched position as the home position (zero).
+            _position -= _latchPosition;
+            _target = _position;
+
+            _moveSlow(retract);
+            _homing = HOMING_CLEAR;
+            _homingSince = 0;
+        }
+        else
+        {
+            _endHoming(false);
+        }
+        break;
+
+    default:
+        break;
     }
 }
 
 /// <summary>
-/// Start the calibration routine by moving in negative direction (actuator length).
-/// Eventually the first limit switch should be engaged near the home position.
+/// Writes the position record of axis 0 if the state has changed (see PositionStore). The flash write stalls
+/// the step timer interrupt, so nothing is written while any axis is running. A clean record remains pending
+/// (run() retries it until all axes are idle). A move of axis 0 is only started if the not clean record has
+/// been written, so a clean record is never restored after a later move has started (power loss).
 /// </summary>
-String LinearActuator::calibrate()
+/// <param name="clean">True if the stepper has been stopped (the position is exact).</param>
+/// <returns>True if the record is current (written or unchanged), false if it is pending.</returns>
+bool LinearActuator::_persistPosition(bool clean)
 {
-    // Do not move if still moving.
-    if (getRunningFlag())
+    if ((_axis != 0) || Positions.isCurrent(_position, _calibrated, clean, _alarm))
     {
-        return String("Still moving - ignoring calibrate request");
+        return true;
     }
 
-    _calibrating = true;
-    return moveRelativeDistance(-Settings.Actuator.Length);
+    if (Engine.isRunning())
+    {
+        return false;
+    }
+
+    Positions.write(_position, _calibrated, clean, _alarm);
+
+    return true;
+}
+
+/// <summary>
+/// Writes the not clean position record of axis 0 before a coordinated move starts any axis (the followers
+/// are started before the master, see StepEngine::moveLinear()).
+/// </summary>
+/// <returns>True if the record is current, false if another axis is running.</returns>
+bool LinearActuator::markMoving()
+{
+    return _persistPosition(false);
+}
+
+/// <summary>
+/// Restores the position and the calibration state from the last position record. The record is only used
+/// if the stepper had been stopped (clean) without an alarm, and the stepper alarm input is not active.
+/// </summary>
+void LinearActuator::_restorePosition()
+{
+    PositionStore::Record record;
+
+    // The alarm input is active low (the pin is configured in setup()).
+    bool alarm = (digitalRead(_ALM) == LOW);
+
+    if (!Positions.getLast(record) || !record.Clean || record.Alarm || alarm)
+    {
+        return;
+    }
+
+    _position   = record.Position;
+    _target     = _position;
+    _calibrated = record.Calibrated;
+    _restored   = true;
+}
+
+/// <summary>
+/// Captures the start of a move (position, target, steps, and time) in the move record. The record of
+/// the previous move is added first, if the move has been started before run() was called.
+/// </summary>
+void LinearActuator::_beginMove()
+{
+    _recordMove();
+
+    _move = MoveHistory::Record();
+    _move.Time   = time(nullptr);
+    _move.Axis   = _axis;
+    _move.Start  = _position;
+    _move.Target = _target;
+    _move.Steps  = _steps;
+
+    _peakSpeed = StepSpeed();
+    _moveStart = micros();
+}
+
+/// <summary>
+/// Captures the end of a move (position, elapsed time, peak speed, and outcome) in the move record.
+/// This is called in the timer interrupt when the target has been reached, so it has to be short.
+/// </summary>
+/// <param name="outcome">The outcome of the move (see MoveHistory::Outcome).</param>
+void LinearActuator::_endMove(uint8_t outcome)
+{
+    _move.End       = _position;
+    _move.Elapsed   = micros() - _moveStart;
+    _move.PeakSpeed = _peakSpeed.raw();
+    _move.Outcome   = outcome;
+    _moveEnded = true;
+}
+
+/// <summary>
+/// Gets the outcome of a stopped move: the stepper alarm, a limit switch (the input pin halting the move),
+/// or stopped (stop command or stop switch).
+/// </summary>
+/// <returns>The outcome (see MoveHistory::Outcome).</returns>
+uint8_t LinearActuator::_getStopOutcome()
+{
+    if (_alarm)
+        return MoveHistory::OUTCOME_ALARM;
+
+    if ((_latchPin == Settings.Actuator.SwitchLimit1) || (_latchPin == Settings.Actuator.SwitchLimit2))
+        return MoveHistory::OUTCOME_LIMIT;
+
+    return MoveHistory::OUTCOME_STOPPED;
+}
+
+/// <summary>
+/// Adds the move record to the history when the move has ended (called from the main loop).
+/// </summary>
+void LinearActuator::_recordMove()
+{
+    if (_moveEnded)
+    {
+        _moveEnded = false;
+        History.add(_move);
+    }
+}
+
+/// <summary>
+/// Updates the running, limit and alarm LEDs (called from the main loop).
+/// </summary>
+void LinearActuator::_updateLeds()
+{
+    _ledRunning.put(_running);
+    _ledInLimit.put(_limit);
+    _ledAlarmOn.put(_alarm);
 }
 
 /// <summary>
 /// Timer callback - move a single step if not yet at target. The timer is triggered every 10 microseconds (100 kHz).
 /// This ISR routine has to be as short as possible (less than 10 microseconds) in order to be called repeatedly.
 /// Note that two flags (_running and _stopped are used to indicate the movement status to the main program.
+/// The routine is instantiated for every PUL pin mask, the pulse edges are written directly (see SioPins).
 /// </summary>
-void LinearActuator::onTimer()
+template <uint32_t PUL_MASK>
+void LinearActuator::_onTimer()
 {
-    static long  count;     // Counter for delay between steps.
-    static long  intervals; // Number of intervals between steps.
+    // The step train generates the pulses (PIO and DMA), only the end of the move is detected.
+    if (_driver == DRIVER_PIO)
+    {
+        if (_running && _train.isDone())
+        {
+            _position = _target;
+            _running = false;
+            _stopped = true;
+            _elapsed = float(millis() - _start) / 1000.0f;
+            Metrics.MovesCompleted.inc();
+            _endMove(MoveHistory::OUTCOME_COMPLETED);
+            _speed = StepSpeed();
+            _start = 0;
+            _n = 0;
+        }
+
+        return;
+    }
+
+    // A follower outputs the requested steps only (a pulse takes two intervals), see StepEngine.
+    if (_follower)
+    {
+        if (!_running) return;
+
+        if (_count == 1)
+        {
+            SioPins<PUL_MASK>::clr();
+            Metrics.Steps.inc();
+            ++_n;
+
+            _position += static_cast<int>(_direction);
+            _count = 0;
+        }
+        else if ((_pending > 0) && (_position != _target))
+        {
+            SioPins<PUL_MASK>::set();
+            --_pending;
+            _count = 1;
+        }
+        else if (_position == _target)
+        {
+            _running = false;
+            _stopped = true;
+            _follower = false;
+            _pending = 0;
+            _elapsed = float(millis() - _start) / 1000.0f;
+            Metrics.MovesCompleted.inc();
+            _endMove(MoveHistory::OUTCOME_COMPLETED);
+            _start = 0;
+            _n = 0;
+        }
+
+        return;
+    }
 
     // // Generate stepper driver output pulses only if the running flag is set.
     if (_running)
@@ -900,21 +1658,23 @@ void LinearActuator::onTimer()
         if (_position != _target)
         {
             // Start pulse at the first interval and update speed and delay intervals.
-            if (count == 0)
+            if (_count == 0)
             {
-                digitalWrite(_PUL, HIGH);
+                SioPins<PUL_MASK>::set();
 
                 // Calculate speed from step count.
-                if (_n <= _rampsteps) _speed = _minspeed + _n * _deltaspeed;
-                else if (_n >= (_steps - _rampsteps)) _speed = _minspeed + (_steps - _n) * _deltaspeed;
+                if (_n <= _rampsteps) _speed = _minspeed + (_deltaspeed * _n).convert<StepSpeed>();
+                else if (_n >= (_steps - _rampsteps)) _speed = _minspeed + (_deltaspeed * (_steps - _n)).convert<StepSpeed>();
 
-                intervals = _getIntervalsFromSpeed(_speed);
+                _intervals = _getIntervalsFromSpeed(_speed);
+                if (_speed > _peakSpeed) _peakSpeed = _speed;
             }
 
             // Turn output low (end pulse) update step count and position.
-            if (count == 1)
+            if (_count == 1)
             {
-                digitalWrite(_PUL, LOW);
+                SioPins<PUL_MASK>::clr();
+                Metrics.Steps.inc();
                 ++_n;
 
                 if (_position < _target)
@@ -936,24 +1696,41 @@ void LinearActuator::onTimer()
                 _running = false;
                 _stopped = true;
                 _elapsed = float(millis() - _start) / 1000.0f;
-                intervals = 0;
-                _speed = 0.0f;
+                Metrics.MovesCompleted.inc();
+                _endMove(MoveHistory::OUTCOME_COMPLETED);
+                _intervals = 0;
+                _speed = StepSpeed();
                 _start = 0;
                 _n = 0;
             }
         }
 
         // Increment interval count (delay between steps).
-        ++count;
+        ++_count;
         
         // When the interval count has been reached, reset count and start again.
-        if (count >= intervals)
+        if (_count >= _intervals)
         {
-            count = 0;
+            _count = 0;
         }
     }
 }
 
+/// <summary>
+/// Step train callback (DMA interrupt) - updates the position, the step count and the speed for the
+/// completed steps (a buffer of step words).
+/// </summary>
+/// <param name="steps">The number of completed steps.</param>
+void LinearActuator::onSteps(uint32_t steps)
+{
+    _position += long(steps) * static_cast<int>(_direction);
+    _n += steps;
+    _speed = _train.getSpeed(_n);
+    if (_speed > _peakSpeed) _peakSpeed = _speed;
+
+    Metrics.Steps.inc(steps);
+}
+
 /// <summary>
 /// This returns a move info string when when the ISR routine indicates that the move has stopped.
 /// </summary>
@@ -973,6 +1750,73 @@ String LinearActuator::getMoveInfo()
     }
 }
 
+/// <summary>
+/// Benchmarks the output of a pulse edge: digitalWrite() as used before, and the direct SIO register write
+/// as used in the timer interrupt (the mask is kept in a register, as the compile time mask in SioPins).
+/// The running LED pin is toggled, so the stepper motor does not move. The processor clock cycles are
+/// counted using the SysTick timer with the interrupts disabled (the loop overhead is subtracted).
+/// </summary>
+/// <returns>A command specific message.</returns>
+String LinearActuator::benchmark()
+{
+    static constexpr const uint32_t LOOPS = 1000;   // The number of pulses (two edges each).
+    static constexpr const uint32_t MAX_COUNT = 0x00FFFFFF;
+
+    if (getRunningFlag())
+    {
+        return String("Still moving - ignoring benchmark request");
+    }
+
+    uint8_t  pin  = Settings.Actuator.LedRunning;
+    uint32_t mask = _ledRunning.getMask();
+
+    // Save the SysTick settings and start counting the processor clock cycles (24 bit, counting down).
+    uint32_t csr = systick_hw->csr;
+    uint32_t rvr = systick_hw->rvr;
+
+    systick_hw->rvr = MAX_COUNT;
+    systick_hw->cvr = 0;
+    systick_hw->csr = M0PLUS_SYST_CSR_CLKSOURCE_BITS | M0PLUS_SYST_CSR_ENABLE_BITS;
+
+    uint32_t state = save_and_disable_interrupts();
+
+    uint32_t start = systick_hw->cvr;
+    for (volatile uint32_t i = 0; i < LOOPS; i++) {}
+    uint32_t overhead = (start - systick_hw->cvr) & MAX_COUNT;
+
+    start = systick_hw->cvr;
+    for (volatile uint32_t i = 0; i < LOOPS; i++)
+    {
+        digitalWrite(pin, HIGH);
+        digitalWrite(pin, LOW);
+    }
+    uint32_t arduino = (start - systick_hw->cvr) & MAX_COUNT;
+
+    start = systick_hw->cvr;
+    for (volatile uint32_t i = 0; i < LOOPS; i++)
+    {
+        sio_hw->gpio_set = mask;
+        sio_hw->gpio_clr = mask;
+    }
+    uint32_t sio = (start - systick_hw->cvr) & MAX_COUNT;
+
+    restore_interrupts(state);
+
+    systick_hw->rvr = rvr;
+    systick_hw->csr = csr;
+
+    _updateLeds();
+
+    // Cycles per edge (two edges per loop).
+    uint32_t arduinoCycles = (arduino > overhead) ? (arduino - overhead) / (2 * LOOPS) : 0;
+    uint32_t sioCycles     = (sio > overhead) ? (sio - overhead) / (2 * LOOPS) : 0;
+
+    return String("Output Benchmark (pin ") + pin + "):\r\n" +
+                  "    Edges:        " + (2 * LOOPS)   + "\r\n" +
+                  "    digitalWrite: " + arduinoCycles + " cycles per edge\r\n" +
+                  "    SIO:          " + sioCycles     + " cycles per edge\r\n";
+}
+
 /// <summary>
 /// Returns a (pretty) string representation of the updated JSON document.
 /// </summary>
@@ -980,28 +1824,34 @@ String LinearActuator::getMoveInfo()
 String LinearActuator::toJsonString()
 {
     String json;
-
-    _doc.clear();
-    _doc["Timestamp"]   = _getTimeUTC();
-    _doc["Calibrating"] = getCalibratingFlag();
-    _doc["Calibrated"]  = getCalibratedFlag();
-    _doc["Enabled"]     = getEnabledFlag();
-    _doc["Running"]     = getRunningFlag();
-    _doc["Limit"]       = getLimitFlag();
-    _doc["Alarm"]       = getAlarmFlag();
-    _doc["Delta"]       = getDelta();
-    _doc["Elapsed"]     = getElapsed();
-    _doc["Percentage"]  = getPercentage();
-    _doc["Target"]      = getTarget();
-    _doc["Position"]    = getPosition();
-    _doc["Distance"]    = getDistance();
-    _doc["Direction"]   = getDirection();
-    _doc["RPM"]         = getRPM();
-    _doc["Speed"]       = getSpeed();
-    _doc["MinSpeed"]    = getMinSpeed();
-    _doc["MaxSpeed"]    = getMaxSpeed();
-    _doc["MaxSteps"]    = getMaxSteps();
-    serializeJsonPretty(_doc, json);
+    String track = getTrack();
+
+    JsonArenaDocument doc(JSON_SIZE);
+    doc["Timestamp"]   = _getTimeUTC();
+    doc["Axis"]        = getAxis();
+    doc["Calibrating"] = getCalibratingFlag();
+    doc["Calibrated"]  = getCalibratedFlag();
+    doc["Restored"]    = getRestoredFlag();
+    doc["Homing"]      = getHoming();
+    doc["Enabled"]     = getEnabledFlag();
+    doc["Running"]     = getRunningFlag();
+    doc["Limit"]       = getLimitFlag();
+    doc["Alarm"]       = getAlarmFlag();
+    doc["Delta"]       = getDelta();
+    doc["Elapsed"]     = getElapsed();
+    doc["Percentage"]  = getPercentage().toFloat();
+    doc["Target"]      = getTarget();
+    doc["Position"]    = getPosition();
+    doc["Track"]       = track.length() ? track.c_str() : nullptr;
+    doc["Distance"]    = getDistance().toFloat();
+    doc["Direction"]   = getDirection();
+    doc["RPM"]         = getRPM().toFloat();
+    doc["Speed"]       = getSpeed().toFloat();
+    doc["MinSpeed"]    = getMinSpeed().toFloat();
+    doc["MaxSpeed"]    = getMaxSpeed().toFloat();
+    doc["MaxSteps"]    = getMaxSteps();
+    doc["Driver"]      = (getDriver() == DRIVER_PIO) ? "PIO" : "Timer";
+    serializeJsonPretty(doc, json);
 
     return json;
 }
@@ -1012,26 +1862,33 @@ String LinearActuator::toJsonString()
 /// <returns>The printable string.</returns>
 String LinearActuator::toString()
 {
+    String track = getTrack();
+
     return String("Actuator Status:") + "\r\n" +
                   "    Timestamp:   " + _getTimeUTC()        + "\r\n" +
+                  "    Axis:        " + getAxis()            + "\r\n" +
                   "    Calibrating: " + getCalibratingFlag() + "\r\n" +
                   "    Calibrated:  " + getCalibratedFlag()  + "\r\n" +
+                  "    Restored:    " + getRestoredFlag()    + "\r\n" +
+                  "    Homing:      " + getHoming()          + "\r\n" +
                   "    Enabled:     " + getEnabledFlag()     + "\r\n" +
                   "    Running:     " + getRunningFlag()     + "\r\n" +
                   "    Limit:       " + getLimitFlag()       + "\r\n" +
                   "    Alarm:       " + getAlarmFlag()       + "\r\n" +
                   "    Delta:       " + getDelta()           + "\r\n" +
                   "    Elapsed:     " + getElapsed()         + "\r\n" +
-                  "    Percentage:  " + getPercentage()      + "\r\n" +
+                  "    Percentage:  " + getPercentage().toString() + "\r\n" +
                   "    Target:      " + getTarget()          + "\r\n" +
                   "    Position:    " + getPosition()        + "\r\n" +
-                  "    Distance:    " + getDistance()        + "\r\n" +
+                  "    Track:       " + (track.length() ? track : String("(between tracks)")) + "\r\n" +
+                  "    Distance:    " + getDistance().toString(3) + "\r\n" +
                   "    Direction:   " + getDirection()       + "\r\n" +
-                  "    RPM:         " + getRPM()             + "\r\n" +
-                  "    Speed:       " + getSpeed()           + "\r\n" +
-                  "    MinSpeed:    " + getMinSpeed()        + "\r\n" +
-                  "    MaxSpeed:    " + getMaxSpeed()        + "\r\n" +
-                  "    MaxSteps:    " + getMaxSteps()        + "\r\n";
+                  "    RPM:         " + getRPM().toString()      + "\r\n" +
+                  "    Speed:       " + getSpeed().toString()    + "\r\n" +
+                  "    MinSpeed:    " + getMinSpeed().toString() + "\r\n" +
+                  "    MaxSpeed:    " + getMaxSpeed().toString() + "\r\n" +
+                  "    MaxSteps:    " + getMaxSteps()        + "\r\n" +
+                  "    Driver:      " + ((getDriver() == DRIVER_PIO) ? "PIO" : "Timer") + "\r\n";
 }
 
 
@@ -14,6 +14,13 @@
 
 #include <Arduino.h>
 
+#include "AppSettings.h"
+#include "Fixed.h"
+#include "MoveHistory.h"
+#include "PositionStore.h"
+#include "SioOutput.h"
+#include "StepTrain.h"
+
 /// <summary>
 /// This class holds the the stepper motor instance and adds calibration and properties.
 /// It uses the external (global) AppSettings instance for initialization.
@@ -51,39 +58,108 @@
 /// the number the timer callback routine is called before a new pulse is generated.
 /// The starting interval is determined by the minimum speed and decreased to reach the maximum speed.
 /// Before reaching the target, the interval is increased again until the minimum speed is reached.
+/// 
+/// Alternatively (Settings.Stepper.Driver) the pulses are generated by a PIO state machine fed by DMA
+/// (see StepTrain). The same speed profile is planned into buffers, so no CPU time is spent per step
+/// and speeds up to 250000 steps per second (i.e. 128 microsteps at 600 RPM) are possible.
+/// 
+/// The outputs are written directly using the SIO registers (see SioOutput). The timer interrupt routine
+/// is a template parameterized on the PUL pin mask, the instantiation for the configured pin is selected
+/// in init(), so every pulse edge is a single store.
+///
+/// Several instances are driven by the step engine (see StepEngine). Axis 0 is the global Actuator using the
+/// Stepper, Actuator and Yard settings, the additional axes use the Axes settings and the timer interrupt.
+/// In a coordinated (linear) move the axis with the most steps runs the speed profile, the other axes are
+/// followers and output the steps distributed by the step engine (see follow()).
+///
+/// The position of axis 0 is persisted before and after every move (see PositionStore) and restored at
+/// boot, so a routine power cycle does not require a new calibration.
+///
+/// Every move is recorded (see MoveHistory). The start is captured when the move is started, the end
+/// (position, elapsed time, peak speed, and outcome) where the move ends (in the timer interrupt for a
+/// completed move), and the record is added to the history from the main loop (see run()).
+///
+/// Distances, speeds and percentages are fixed-point values (see Fixed.h), as the RP2040 has no floating
+/// point unit. The scale factor (steps per rotation including microsteps) is precomputed when the settings
+/// are applied, and the millimetre to step conversion is rounded (exact and reproducible).
 /// </summary>
 class LinearActuator
 {
 public:
     static constexpr const uint  FREQUENCY = 100000;              // The timer frequency 100 kHz (pulsewidth = 10 usec).
     static constexpr const uint  INTERVAL  = 1000000 / FREQUENCY; // The time between callbacks (microseconds).
-    static constexpr const float MIN_SPEED = 1;                   // The minimum speed (1 step per second).
-    static constexpr const float MAX_SPEED = FREQUENCY / 2.0;     // The maximum speed (50000 steps per second).
+    static constexpr const StepSpeed MIN_SPEED = StepSpeed::fromInt(1);             // The minimum speed (1 step per second).
+    static constexpr const StepSpeed MAX_SPEED = StepSpeed::fromInt(FREQUENCY / 2); // The maximum speed (50000 steps per second).
     static constexpr const float DIR_DELAY  = 200;                // The delay (ms) for direction change.
 
+    static constexpr const uint8_t DRIVER_TIMER = 0;              // The step pulses are generated by the timer interrupt.
+    static constexpr const uint8_t DRIVER_PIO   = 1;              // The step pulses are generated by PIO and DMA (StepTrain).
+
     enum Direction
     {
         CW  = 1,                                    // Clockwise direction.
         CCW = -1                                    // Counter Clockwise direction.
     };
 
+    enum Homing
+    {
+        HOMING_IDLE,                                // Not homing.
+        HOMING_FAST,                                // Fast approach to limit switch 1 (normal profile).
+        HOMING_BACKOFF,                             // Retract from limit switch 1.
+        HOMING_SLOW,                                // Slow re-approach to limit switch 1 (minimum speed).
+        HOMING_CLEAR                                // Retract from limit switch 1 after the refined zero.
+    };
+
+    static constexpr const uint8_t       NO_LATCH      = 0xFF; // The latch pin value if no position has been latched.
+    static constexpr const unsigned long HOMING_SETTLE = 50;   // The time (ms) for the switch state to settle (debounce).
+
 private:
-    StaticJsonDocument<384> _doc;                   // The Json document representing the status data.
+    static const size_t JSON_SIZE = 448;            // The JSON document capacity (status data, borrowed from the arena).
+
+    uint8_t _axis = 0;                              // The axis index (0: Stepper settings, 1..: Axes settings).
 
     uint8_t _PUL;                                   // GPIO pin number for the pulse (PUL+) pin.
     uint8_t _DIR;                                   // GPIO pin number for the direction (DIR+) pin.
     uint8_t _ENA;                                   // GPIO pin number for the enable (ENA+) pin.
     uint8_t _ALM;                                   // GPIO pin number for the alarm (ALM+) pin.
 
-    uint8_t _ledRunning;                            // GPIO pin number for the running LED.
-    uint8_t _ledInLimit;                            // GPIO pin number for the limit LED.
-    uint8_t _ledAlarmOn;                            // GPIO pin number for the alarm LED.
+    SioOutput _pulOutput;                           // The PUL output (mask used outside of the timer interrupt).
+    SioOutput _dirOutput;                           // The DIR output.
+    SioOutput _enaOutput;                           // The ENA output.
+
+    SioOutput _ledRunning;                          // The running LED output.
+    SioOutput _ledInLimit;                          // The limit LED output.
+    SioOutput _ledAlarmOn;                          // The alarm LED output.
+
+    typedef void (LinearActuator::*TimerRoutine)(); // The timer routine (instantiated for the PUL pin mask).
+
+    /// <summary>
+    /// Selects the timer routine instantiation for the PUL pin mask (see selectForPin()).
+    /// </summary>
+    struct TimerRoutineSelector
+    {
+        template <uint32_t MASK>
+        static constexpr TimerRoutine get() { return &LinearActuator::_onTimer<MASK>; }
+    };
+
+    TimerRoutine _timerRoutine = &LinearActuator::_onTimer<0>; // The timer routine for the configured PUL pin.
 
     volatile bool _running = false;                 // Flag indicating that moving is enabled (used in ISR).
     volatile bool _stopped = false;                 // Flag indicating that moving has ended (used in ISR).
+    volatile bool _halted  = false;                 // Flag indicating that moving has been halted by an input interrupt.
+    volatile uint8_t _latchPin = NO_LATCH;          // The input pin which halted the move (used in ISR).
+    volatile long    _latchPosition = 0;            // The position latched at the input edge (used in ISR).
+
+    uint8_t   _driver = DRIVER_TIMER;               // The step pulse generator.
+    StepTrain _train;                               // The PIO and DMA step train generator.
+    long      _trainStart = 0;                      // The position at the start of the step train.
+
+    Homing        _homing = HOMING_IDLE;            // The homing phase (two-phase calibration).
+    unsigned long _homingSince = 0;                 // The time the current homing move has ended (millis).
 
     bool _calibrating = false;                      // Flag indicating that the calibration routine is running.
     bool _calibrated  = false;                      // Flag indicating that the calibration has been completed.
+    bool _restored    = false;                      // Flag indicating that the position has been restored at boot.
     bool _enabled     = false;                      // Flag indicating that the motor is enabled.
     bool _limit       = false;                      // Flag indicating that a limit switch has turned on.
     bool _alarm       = false;                      // Flag indicating that the stepper driver alarm has been turned on.
@@ -91,65 +167,101 @@ private:
 
     Direction _direction = Direction::CW;           // Stepper driver direction (CW: 1, CCW: -1).
 
-    float         _distancePerRotation = 8.0f;      // Distance per full rotation (mm).
-    ushort        _stepsPerRotation    = 200;       // Steps per full rotation (360).
-    ushort        _microsteps          = 1;         // Stepper driver microstep settings.
-    float         _minspeed            = 2000.0f;   // The minimum stepper speed in steps per second.
-    float         _maxspeed            = 5000.0f;   // The maximum stepper speed in steps per second.
-    float         _maxsteps            = 1.0f;      // The number of steps for a ramp from minimum to maximum speed.
+    Millimetres   _distancePerRotation = Millimetres::fromInt(8);  // Distance per full rotation (mm).
+    ushort        _stepsPerRotation    = 200;                      // Steps per full rotation (360).
+    ushort        _microsteps          = 1;                        // Stepper driver microstep settings.
+    long          _stepsPerRevolution  = 200;                      // Steps per full rotation including microsteps (scale factor).
+    StepSpeed     _minspeed            = StepSpeed::fromInt(2000); // The minimum stepper speed in steps per second.
+    StepSpeed     _maxspeed            = StepSpeed::fromInt(5000); // The maximum stepper speed in steps per second.
+    long          _maxsteps            = 1;                        // The number of steps for a ramp from minimum to maximum speed.
 
     long          _rampsteps  = 0;                  // The number of steps for ramping.
-    float         _deltaspeed = 0.0f;               // The speed delta for every step.
-    float         _speed = 0.0f;                    // The current speed (steps per second).
+    SpeedDelta    _deltaspeed;                      // The speed delta for every step.
+    StepSpeed     _speed;                           // The current speed (steps per second).
 
     long          _position = 0;                    // Absolute stepper position (steps).
     long          _target   = 0;                    // Absolute target position (steps).
     long          _steps    = 0;                    // Number of total steps requested in move.
     long          _n        = 0;                    // Step counter.
 
+    long          _count     = 0;                   // Counter for delay between steps (used in ISR).
+    long          _intervals = 0;                   // Number of intervals between steps (used in ISR).
+
+    volatile bool _follower = false;                // Flag indicating that the steps are output as requested by the step engine.
+    volatile long _pending  = 0;                    // The number of steps requested by the step engine (used in ISR).
+
     unsigned long _start   = 0;                     // Time at start of move (millis).
     float         _elapsed = 0;                     // Elapsed time for last move (seconds).
 
+    MoveHistory::Record _move;                      // The record of the current (or last) move.
+    uint32_t      _moveStart = 0;                   // Time at start of move (micros).
+    StepSpeed     _peakSpeed;                       // The peak speed of the current move (used in ISR).
+    volatile bool _moveEnded = false;               // Flag indicating that the move record is complete (used in ISR).
+
     String _getTimeUTC();                           // Get the current time (UTC) as a string.
     void   _ccw();                                  // Turn off the direction pin.
     void   _cw();                                   // Turn on the direction pin.
+    void   _setDirection();                         // Set the direction for the target (delay if changing).
+
+    AppSettings::AxisSettings& _getAxisSettings();  // Gets the settings of an additional axis.
 
-    float  _getSpeedFromIntervals(uint intervals);  // Convert the intervals to speed.
-    uint   _getIntervalsFromSpeed(float speed);     // Convert the speed to intervals.
+    void        _updateScale();                     // Precompute the scale factor (steps per rotation).
+
+    StepSpeed   _getSpeedFromIntervals(uint value); // Convert the intervals to speed.
+    uint        _getIntervalsFromSpeed(StepSpeed value); // Convert the speed to intervals.
            
-    float  _getSpeedFromRPM(float speed);           // Convert the RPM in speed (steps per second).
-    float  _getRPMFromSpeed(float speed);           // Convert the speed (steps per second) in RPM.
+    StepSpeed   _getSpeedFromRPM(Rpm value);        // Convert the RPM in speed (steps per second).
+    Rpm         _getRPMFromSpeed(StepSpeed value);  // Convert the speed (steps per second) in RPM.
            
-    long   _getStepsFromDistance(float vlue);       // Convert distance [mm] to steps.
-    float  _getDistanceFromSteps(long value);       // Convert steps to distance [mm].
+    long        _getStepsFromDistance(Millimetres value); // Convert distance [mm] to steps (rounded).
+    Millimetres _getDistanceFromSteps(long value);  // Convert steps to distance [mm].
            
-    bool   _isValidMicrostep(ushort valu);          // Returns true if microstep value is valid.
+    bool        _isValidMicrostep(ushort valu);     // Returns true if microstep value is valid.
+
+    StepSpeed   _getSpeedLimit();                   // Gets the maximum speed supported by the step pulse generator.
+    void   _abortTrain();                           // Stops the step train and sets the position (interrupt safe).
+
+    String _moveSlow(long value);                   // Move relative distance [steps] at minimum speed.
+    void   _endHoming(bool success);                // End the homing (calibration) routine.
+    void   _updateLeds();                           // Update the running, limit and alarm LEDs.
+    bool   _persistPosition(bool clean);            // Write the position record if changed (axis 0, all axes idle).
+    void   _restorePosition();                      // Restore the position from the last clean record (axis 0).
+    void   _beginMove();                            // Capture the start of the move (move record).
+    void   _endMove(uint8_t outcome);               // Capture the end of the move (called in ISR).
+    uint8_t _getStopOutcome();                      // Gets the outcome of a stopped move (alarm, limit, or stopped).
+    void   _recordMove();                           // Add the completed move record to the history (main loop).
+
+    template <uint32_t PUL_MASK>
+    void   _onTimer();                              // The timer routine (pulse generation) for the PUL pin mask.
 
 public : 
-    float     getRPM();                             // Gets the current speed in RPM.
-    float     getSpeed();                           // Gets the current speed in steps per second.
+    Rpm       getRPM();                             // Gets the current speed in RPM.
+    StepSpeed getSpeed();                           // Gets the current speed in steps per second.
     float     getElapsed();                         // Gets the current elapsed time in seconds.
-    float     getPercentage();                      // Gets the current percentage of the move.
-    float     getMinSpeed();                        // Gets the minimum speed in steps per second.
-    String    setMinSpeed(float value);             // Sets the minimum speed in steps per second.
-    float     getMaxSpeed();                        // Gets the maximum speed in steps per second.
-    String    setMaxSpeed(float value);             // Sets the maximum speed in steps per second.
+    Percent   getPercentage();                      // Gets the current percentage of the move.
+    StepSpeed getMinSpeed();                        // Gets the minimum speed in steps per second.
+    String    setMinSpeed(StepSpeed value);         // Sets the minimum speed in steps per second.
+    StepSpeed getMaxSpeed();                        // Gets the maximum speed in steps per second.
+    String    setMaxSpeed(StepSpeed value);         // Sets the maximum speed in steps per second.
     long      getMaxSteps();                        // Gets the ramp steps to maximum speed.
     String    setMaxSteps(long value);              // Sets the ramp steps to maximum speed.
+    uint8_t   getDriver();                          // Gets the step pulse generator.
+    String    setDriver(uint8_t value);             // Sets the step pulse generator.
     ushort    getMicrosteps();                      // Gets the microsteps for the stepper driver.
     String    setMicrosteps(ushort value);          // Sets the microsteps for the stepper driver.
     long      getPosition();                        // Gets the current position in steps.
+    String    getTrack();                           // Gets the track at the current position (empty if between tracks).
     long      getDelta();                           // Gets the remaining steps to the target position.
     long      getTarget();                          // Gets the target position in steps.
     String    setTarget(long value);                // Sets the target position in steps.
-    float     getDistance();                        // Gets the current position in mm.
-    Direction getDirection();                       // Gets the current direction.
-    float     getRetract();                         // Gets the retract distance in mm.
-    String    setRetract(float value);              // Sets the retract distance in mm.
-    float     getMinStep();                         // Gets the minimum step distance in mm.
-    String    setMinStep(float value);              // Sets the minimum step distance in mm.
-    float     getSmallStep();                       // Gets the small step distance in mm.
-    String    setSmallStep(float value);            // Sets the small step distance in mm.
+    Millimetres getDistance();                      // Gets the current position in mm.
+    Direction   getDirection();                     // Gets the current direction.
+    Millimetres getRetract();                       // Gets the retract distance in mm.
+    String      setRetract(Millimetres value);      // Sets the retract distance in mm.
+    Millimetres getMinStep();                       // Gets the minimum step distance in mm.
+    String      setMinStep(Millimetres value);      // Sets the minimum step distance in mm.
+    Millimetres getSmallStep();                     // Gets the small step distance in mm.
+    String      setSmallStep(Millimetres value);    // Sets the small step distance in mm.
 
     bool getEnabledFlag();                          // True if acceleration and deceleration have been enabled.
     bool getRunningFlag();                          // True if the stepper is running (position != target).
@@ -157,24 +269,41 @@ public :
     bool getAlarmFlag();                            // True if the stepper alarm signal is on.
     bool getCalibratingFlag();                      // True if calibrating.
     bool getCalibratedFlag();                       // True if calibration was successful.
+    bool getHaltedFlag();                           // True if halted by an input interrupt (stop not yet completed).
+    bool getRestoredFlag();                         // True if the position has been restored at boot.
+    String getHoming();                             // Gets the homing phase name.
+    uint32_t getStepTime(StepSpeed value);          // Gets the time of a single step at the speed (nanoseconds).
+
+    inline uint8_t getAxis() { return _axis; }      // Gets the axis index.
+    inline long getStepCount() { return _n; }       // Gets the steps output in the current move (used by the step engine).
+    inline bool getFollowerFlag() { return _follower; } // True if the steps are requested by the step engine.
 
-    void init();                                    // Initialize the stepper instance.
+    void init(uint8_t axis = 0);                    // Initialize the stepper instance.
+    void apply();                                   // Apply the stepper settings (without reset).
     void update();                                  // Update stepper settings with current values.
     void enable();                                  // Enables the stepper outputs.
     void disable();                                 // Disables the stepper outputs.
     void stop();                                    // Stop moving (resetting target position, disable output).
+    bool halt(uint8_t pin);                         // Stop the pulse generation and latch the position (interrupt safe).
+    void run();                                     // Advance the homing routine and record the moves (main loop).
 
     String home();                                  // Move to position zero (home).
     String reset();                                 // Reset the current position to zero.
     String calibrate();                             // Run the calibration routine.
 
     String getMoveInfo();                           // Return move info.
+    String benchmark();                             // Return the output cycle counts (digitalWrite vs. SIO).
     String moveAway();                              // Retract a short distance in the opposite direction.
-    String moveTrack(uint8_t value);                // Move to specified track (0..9).
+    String moveTrack(const String& track);          // Move to specified track (name or number).
     String moveAbsolute(long value);                // Move to absolute position [steps].
     String moveRelative(long value);                // Move relative distance [steps].
-    String moveAbsoluteDistance(float value);       // Move to absolute position [mm].
-    String moveRelativeDistance(float value);       // Move relative distance [mm].
+    String moveAbsoluteDistance(Millimetres value); // Move to absolute position [mm].
+    String moveRelativeDistance(Millimetres value); // Move relative distance [mm].
+    String moveFollow(long value);                  // Move to absolute position [steps] as follower (see StepEngine).
+    bool   markMoving();                            // Write the not clean position record (axis 0, see StepEngine).
+
+    inline void follow() { ++_pending; }            // Request a single step (follower, called in ISR).
+    void release();                                 // Complete the requested steps only (follower, called in ISR).
 
     void alarmOn(uint8_t pin);                      // Alarm callback routine (on event).
     void alarmOff(uint8_t pin);                     // Alarm callback routine (off event).
@@ -182,7 +311,8 @@ public :
     void switchOn(uint8_t pin);                     // Switch callback routine (on event).
     void switchOff(uint8_t pin);                    // Switch callback routine (off event).
 
-    void onTimer();                                 // Delay timer callback routine.
+    inline void onTimer() { (this->*_timerRoutine)(); } // Delay timer callback routine.
+    void onSteps(uint32_t steps);                   // Step train callback routine (steps completed).
 
     String toJsonString();                          // Get a serialized JSON representation.
     String toString();                              // Get a string representation.
@@ -9,9 +9,12 @@
 // <modified>14-5-2023 9:52 AM</modified>
 // <author>Peter Trimmel</author>
 // --------------------------------------------------------------------------------------------------------------------
-#include <StringSplitter.h>
+#include <algorithm>
 
 #include "AppSettings.h"
+#include "Profiler.h"
+
+static_assert(AppSettings::JSON_SIZE <= JsonArenaClass::SIZE, "The settings document must fit into the JSON arena.");
 
 /// <summary>
 /// Used for printing error messages when reading or writing the settings file.
@@ -19,357 +22,567 @@
 extern SerialUSB Serial; 
 
 /// <summary>
-/// Tabify the string (breaking on LF) by adding four spaces.
+/// The section names (in the order of the section bits).
+/// </summary>
+const char* AppSettings::SECTION_NAMES[AppSettings::SECTIONS] = { "Yard", "Actuator", "Stepper", "Server", "WiFi", "AP", "Axes" };
+
+/// <summary>
+/// Tabify the string (breaking on LF) by adding four spaces. The number of lines is not limited
+/// (the yard section holds a line per track).
 /// </summary>
 /// <param name="text">The text containing lines to be indented.</param>
 /// <returns>The indented text.</returns>
 String AppSettings::_addTab(String text)
 {
-    StringSplitter *splitter = new StringSplitter(text, '\n', AppSettings::MAX_LINES);
-    int itemCount = splitter->getItemCount();
     String result;
+    int start = 0;
 
-    for (int i = 0; i < itemCount; i++)
+    while (start < (int)text.length())
     {
-        result += String("    ") + splitter->getItemAtIndex(i) + String('\n');
+        int end = text.indexOf('\n', start);
+
+        if (end < 0) end = text.length();
+
+        result += String("    ") + text.substring(start, end) + String('\n');
+        start = end + 1;
     }
 
     return result;
 }
 
 /// <summary>
-/// Updates the static JSON document from the current settings.
+/// Updates the JSON document from the current settings.
 /// </summary>
-void AppSettings::_update()
+/// <param name="doc">The JSON document (borrowed from the arena).</param>
+void AppSettings::_update(JsonDocument& doc)
 {
-    _doc.clear();
+    doc.clear();
 
-    _doc["Yard"]     = Yard.toJson();
-    _doc["Actuator"] = Actuator.toJson();
-    _doc["Stepper"]  = Stepper.toJson();
-    _doc["Server"]   = Server.toJson();
-    _doc["WiFi"]     = WiFi.toJson();
-    _doc["AP"]       = AP.toJson();
+    Yard.toJson(doc.createNestedObject("Yard"));
+    Actuator.toJson(doc.createNestedObject("Actuator"));
+    Stepper.toJson(doc.createNestedObject("Stepper"));
+    Server.toJson(doc.createNestedObject("Server"));
+    WiFi.toJson(doc.createNestedObject("WiFi"));
+    AP.toJson(doc.createNestedObject("AP"));
+    Axes.toJson(doc.createNestedObject("Axes"));
 }
 
 /// <summary>
-/// Update data fields from JSON representation.
+/// Checks whether the JSON value is valid for a field of the specified type and range.
+/// Missing (null) values are valid, as the field is left unchanged.
 /// </summary>
-/// <param name="json">The JSON object containing the settings.</param>
-void AppSettings::YardSettings::fromJson(JsonObject json)
+/// <param name="value">The JSON value.</param>
+/// <param name="min">The minimum value.</param>
+/// <param name="max">The maximum value.</param>
+/// <returns>True if valid.</returns>
+template <typename T>
+static bool isValidField(JsonVariantConst value, double min, double max)
 {
-    if (json != nullptr)
-    {
-        JsonArray tracks = json["Tracks"];
+    if (value.isNull()) return true;
+    if (!value.is<T>()) return false;
 
-        if ((tracks != nullptr) && (tracks.size() == YardSettings::MAX_TRACKS))
-        {
-            for (int i = 0; i < tracks.size(); i++)
-            {
-                Tracks[i] = tracks[i];
-            }
-        }
-    }
+    double number = value.as<T>();
+    return (number >= min) && (number <= max);
 }
 
-/// <summary>
-/// Creates a JSON object with the current settings.
-/// </summary>
-/// <returns>The new JsonObject (pointing to the static JSON document).</returns>
-JsonObject AppSettings::YardSettings::toJson()
+template <>
+bool isValidField<bool>(JsonVariantConst value, double min, double max)
 {
-    _doc.clear();
+    return value.isNull() || value.is<bool>();
+}
 
-    JsonArray tracks = _doc.createNestedArray("Tracks");
-    tracks.add(Tracks[0]);
-    tracks.add(Tracks[1]);
-    tracks.add(Tracks[2]);
-    tracks.add(Tracks[3]);
-    tracks.add(Tracks[4]);
-    tracks.add(Tracks[5]);
-    tracks.add(Tracks[6]);
-    tracks.add(Tracks[7]);
-    tracks.add(Tracks[8]);
-    tracks.add(Tracks[9]);
+template <>
+bool isValidField<String>(JsonVariantConst value, double min, double max)
+{
+    if (value.isNull()) return true;
+    if (!value.is<const char*>()) return false;
 
-    return _doc.as<JsonObject>();
+    size_t length = strlen(value.as<const char*>());
+    return (length >= min) && (length <= max);
 }
 
 /// <summary>
-/// Returns a (pretty) string representation of the current settings.
+/// Updates the field if the JSON value is present and valid.
 /// </summary>
-/// <returns>The serialized JSON document.</returns>
-String AppSettings::YardSettings::toJsonString()
+/// <returns>False if the JSON value is invalid (the field is unchanged).</returns>
+template <typename T>
+static bool fromJsonField(JsonVariantConst value, T& field, double min, double max)
 {
-    String json;
-    serializeJsonPretty(toJson(), json);
-    return json;
+    if (!isValidField<T>(value, min, max)) return false;
+    if (!value.isNull()) field = value.as<T>();
+
+    return true;
 }
 
 /// <summary>
-/// Creates a printable string representation of the settings.
+/// Returns the error message for an invalid field value.
 /// </summary>
-/// <returns>The printable string.</returns>
-String AppSettings::YardSettings::toString()
+template <typename T>
+static String invalidField(const char* name, double min, double max)
 {
-    return String("Yard:") + "\r\n" +
-                  "    Track 0: " + Tracks[0] + "\r\n" +
-                  "    Track 1: " + Tracks[1] + "\r\n" +
-                  "    Track 2: " + Tracks[2] + "\r\n" +
-                  "    Track 3: " + Tracks[3] + "\r\n" +
-                  "    Track 4: " + Tracks[4] + "\r\n" +
-                  "    Track 5: " + Tracks[5] + "\r\n" +
-                  "    Track 6: " + Tracks[6] + "\r\n" +
-                  "    Track 7: " + Tracks[7] + "\r\n" +
-                  "    Track 8: " + Tracks[8] + "\r\n" +
-                  "    Track 9: " + Tracks[9] + "\r\n";
+    if (std::is_same<T, bool>::value)
+        return String("Invalid value for ") + name + " (true or false expected).";
+    else if (std::is_same<T, String>::value)
+        return String("Invalid value for ") + name + " (string of length " + (long)min + " - " + (long)max + " expected).";
+    else if (std::is_integral<T>::value)
+        return String("Invalid value for ") + name + " (integer " + (long)min + " - " + (long)max + " expected).";
+    else
+        return String("Invalid value for ") + name + " (number " + String(min, 1) + " - " + String(max, 1) + " expected).";
 }
 
 /// <summary>
-/// Update data fields from JSON representation.
+/// Returns the largest value (used to calculate the width of the printed names).
 /// </summary>
-/// <param name="json">The JSON object containing the settings.</param>
-void AppSettings::ActuatorSettings::fromJson(JsonObject json)
+static constexpr size_t largest(std::initializer_list<size_t> values)
 {
-    if (json != nullptr)
+    size_t result = 0;
+
+    for (size_t value : values)
     {
-        SwitchLimit1 = json["SwitchLimit1"] | SwitchLimit1;
-        SwitchLimit2 = json["SwitchLimit2"] | SwitchLimit2;
-        SwitchStop   = json["SwitchStop"]   | SwitchStop;
+        if (value > result) result = value;
+    }
+
+    return result;
+}
 
-        LedRunning = json["LedRunning"] | LedRunning;
-        LedInLimit = json["LedInLimit"] | LedInLimit;
-        LedAlarmOn = json["LedAlarmOn"] | LedAlarmOn;
+/// <summary>
+/// Checks that the JSON object contains known fields only.
+/// </summary>
+static bool hasKnownFields(JsonObject json, const char* const names[], size_t count, String& message)
+{
+    for (JsonPair pair : json)
+    {
+        size_t i = 0;
+        while ((i < count) && (strcmp(names[i], pair.key().c_str()) != 0)) i++;
 
-        SmallStep = json["SmallStep"] | SmallStep;
-        MinStep   = json["MinStep"]   | MinStep;
-        Retract   = json["Retract"]   | Retract;
-        Length    = json["Length"]    | Length;
+        if (i == count)
+        {
+            message = String("Unknown field ") + pair.key().c_str() + ".";
+            return false;
+        }
     }
+
+    return true;
 }
 
 /// <summary>
-/// Creates a JSON object with the current settings.
+/// Adds a printable line (name and value) to the text. The names are padded to the same width.
 /// </summary>
-/// <returns>The new JsonObject (pointing to the static JSON document).</returns>
-JsonObject AppSettings::ActuatorSettings::toJson()
+template <typename T>
+static void appendField(String& text, const char* name, const T& value, size_t width)
 {
-    _doc.clear();
-    _doc["SwitchLimit1"] = SwitchLimit1;
-    _doc["SwitchLimit2"] = SwitchLimit2;
-    _doc["SwitchStop"]   = SwitchStop;
+    text += "    ";
+    text += name;
+    text += ':';
 
-    _doc["LedRunning"] = LedRunning;
-    _doc["LedInLimit"] = LedInLimit;
-    _doc["LedAlarmOn"] = LedAlarmOn;
+    for (size_t i = strlen(name) + 1; i <= width; i++) text += ' ';
 
-    _doc["SmallStep"] = SmallStep;
-    _doc["MinStep"]   = MinStep;
-    _doc["Retract"]   = Retract;
-    _doc["Length"]    = Length;
+    text += value;
+    text += "\r\n";
+}
 
-    return _doc.as<JsonObject>();
+template <>
+void appendField<bool>(String& text, const char* name, const bool& value, size_t width)
+{
+    appendField(text, name, value ? "true" : "false", width);
 }
 
+#define SETTINGS_NAME(type, name, value, min, max)       #name,
+#define SETTINGS_NAME_SIZE(type, name, value, min, max)  sizeof(#name),
+#define SETTINGS_VALIDATE(type, name, value, min, max)   if (!isValidField<type>(json[#name], min, max)) { message = invalidField<type>(#name, min, max); return false; }
+#define SETTINGS_FROM_JSON(type, name, value, min, max)  valid &= fromJsonField<type>(json[#name], name, min, max);
+#define SETTINGS_TO_JSON(type, name, value, min, max)    json[#name] = name;
+#define SETTINGS_TO_STRING(type, name, value, min, max)  appendField(text, #name, name, width);
+#define SETTINGS_WRITE(type, name, value, min, max)      out.write(name);
+#define SETTINGS_READ(type, name, value, min, max)       in.read(name);
+
 /// <summary>
-/// Returns a (pretty) string representation of the current settings.
+/// Implements the generated members of a settings section (see SETTINGS_SECTION):
+///
+///     validate()      - Checks that all fields are known and all values are valid (nothing is changed).
+///     fromJson()      - Updates all fields present with a valid value (returns false if a value was invalid).
+///     toJson()        - Fills the JSON object with all fields.
+///     toJsonString()  - Returns the serialized (pretty) JSON representation.
+///     toString()      - Returns the printable representation.
+///     write()         - Writes all fields to the binary snapshot.
+///     read()          - Reads all fields from the binary snapshot (same order as written).
+///
 /// </summary>
-/// <returns>The serialized JSON document.</returns>
-String AppSettings::ActuatorSettings::toJsonString()
-{
-    String json;
-    serializeJsonPretty(toJson(), json);
-    return json;
+#define SETTINGS_IMPLEMENT(Class, Title, FIELDS)                                \
+bool AppSettings::Class::validate(JsonObject json, String& message)             \
+{                                                                               \
+    static const char* const NAMES[] = { FIELDS(SETTINGS_NAME) };               \
+                                                                                \
+    if (!hasKnownFields(json, NAMES, FIELD_COUNT, message)) return false;       \
+    FIELDS(SETTINGS_VALIDATE)                                                   \
+                                                                                \
+    return true;                                                                \
+}                                                                               \
+                                                                                \
+bool AppSettings::Class::fromJson(JsonObject json)                              \
+{                                                                               \
+    bool valid = true;                                                          \
+    FIELDS(SETTINGS_FROM_JSON)                                                  \
+                                                                                \
+    return valid;                                                               \
+}                                                                               \
+                                                                                \
+void AppSettings::Class::toJson(JsonObject json)                                \
+{                                                                               \
+    FIELDS(SETTINGS_TO_JSON)                                                    \
+}                                                                               \
+                                                                                \
+String AppSettings::Class::toJsonString()                                       \
+{                                                                               \
+    JsonArenaDocument doc(JSON_SIZE);                                           \
+    toJson(doc.to<JsonObject>());                                               \
+                                                                                \
+    String json;                                                                \
+    serializeJsonPretty(doc, json);                                             \
+    return json;                                                                \
+}                                                                               \
+                                                                                \
+String AppSettings::Class::toString()                                           \
+{                                                                               \
+    const size_t width = largest({ FIELDS(SETTINGS_NAME_SIZE) });               \
+    String text = String(Title) + ":\r\n";                                      \
+    FIELDS(SETTINGS_TO_STRING)                                                  \
+                                                                                \
+    return text;                                                                \
+}                                                                               \
+                                                                                \
+void AppSettings::Class::write(BinaryWriter& out)                               \
+{                                                                               \
+    FIELDS(SETTINGS_WRITE)                                                      \
+}                                                                               \
+                                                                                \
+void AppSettings::Class::read(BinaryReader& in)                                 \
+{                                                                               \
+    FIELDS(SETTINGS_READ)                                                       \
 }
 
+SETTINGS_IMPLEMENT(ActuatorSettings, "Actuator", ACTUATOR_FIELDS)
+SETTINGS_IMPLEMENT(StepperSettings,  "Stepper",  STEPPER_FIELDS)
+SETTINGS_IMPLEMENT(ServerSettings,   "Server",   SERVER_FIELDS)
+SETTINGS_IMPLEMENT(WiFiSettings,     "WiFi",     WIFI_FIELDS)
+SETTINGS_IMPLEMENT(APSettings,       "AP",       AP_FIELDS)
+
 /// <summary>
-/// Creates a printable string representation of the settings.
+/// Checks the tracks array of an additional axis (all track positions are required). A missing array is valid.
 /// </summary>
-/// <returns>The printable string.</returns>
-String AppSettings::ActuatorSettings::toString()
+static bool isValidTracks(JsonVariantConst tracks, String& message)
 {
-    return String("Actuator:") + "\r\n" +
-                  "    SwitchLimit1: " + SwitchLimit1 + "\r\n" +
-                  "    SwitchLimit1: " + SwitchLimit2 + "\r\n" +
-                  "    SwitchStop:   " + SwitchStop   + "\r\n" +
-                  "    LedRunning:   " + LedRunning   + "\r\n" +
-                  "    LedInLimit:   " + LedInLimit   + "\r\n" +
-                  "    LedAlarmOn:   " + LedAlarmOn   + "\r\n" +
-                  "    SmallStep:    " + SmallStep    + "\r\n" +
-                  "    MinStep:      " + MinStep      + "\r\n" +
-                  "    Retract:      " + Retract      + "\r\n" +
-                  "    Length:       " + Length       + "\r\n";
+    if (tracks.isNull()) return true;
+
+    if (!tracks.is<JsonArrayConst>() || (tracks.size() != AppSettings::AxisSettings::MAX_TRACKS))
+    {
+        message = String("Invalid value for Tracks (array of ") + AppSettings::AxisSettings::MAX_TRACKS + " positions expected).";
+        return false;
+    }
+
+    for (JsonVariantConst track : tracks.as<JsonArrayConst>())
+    {
+        if (!track.is<long>())
+        {
+            message = String("Invalid value for Tracks (array of ") + AppSettings::AxisSettings::MAX_TRACKS + " positions expected).";
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /// <summary>
-/// Update data fields from JSON representation.
+/// Updates the track positions from the (validated) tracks array. A missing array leaves the tracks unchanged.
 /// </summary>
-/// <param name="json">The JSON object containing the settings.</param>
-void AppSettings::StepperSettings::fromJson(JsonObject json)
+static void tracksFromJson(JsonArray tracks, std::array<long, AppSettings::AxisSettings::MAX_TRACKS>& positions)
 {
-    if (json != nullptr)
+    if (tracks != nullptr)
     {
-        PinPUL              = json["PinPUL"]              | PinPUL;
-        PinDIR              = json["PinDIR"]              | PinDIR;
-        PinENA              = json["PinENA"]              | PinENA;
-        PinALM              = json["PinALM"]              | PinALM;
-        MinSpeed            = json["MinSpeed"]            | MinSpeed;
-        MaxSpeed            = json["MaxSpeed"]            | MaxSpeed;
-        MaxSteps            = json["MaxSteps"]            | MaxSteps;
-        MicroSteps          = json["MicroSteps"]          | MicroSteps;
-        StepsPerRotation    = json["StepsPerRotation"]    | StepsPerRotation;
-        DistancePerRotation = json["DistancePerRotation"] | DistancePerRotation;
+        for (size_t i = 0; i < positions.size(); i++)
+        {
+            positions[i] = tracks[i];
+        }
     }
 }
 
 /// <summary>
-/// Creates a JSON object with the current settings.
+/// Adds the tracks array to the JSON object.
 /// </summary>
-/// <returns>The new JsonObject (pointing to the static JSON document).</returns>
-JsonObject AppSettings::StepperSettings::toJson()
+static void tracksToJson(JsonObject json, const std::array<long, AppSettings::AxisSettings::MAX_TRACKS>& positions)
 {
-    _doc.clear();
-    _doc["PinPUL"]              = PinPUL;
-    _doc["PinDIR"]              = PinDIR;
-    _doc["PinENA"]              = PinENA;
-    _doc["PinALM"]              = PinALM;
-    _doc["MinSpeed"]            = MinSpeed;
-    _doc["MaxSpeed"]            = MaxSpeed;
-    _doc["MaxSteps"]            = MaxSteps;
-    _doc["MicroSteps"]          = MicroSteps;
-    _doc["StepsPerRotation"]    = StepsPerRotation;
-    _doc["DistancePerRotation"] = DistancePerRotation;
+    JsonArray tracks = json.createNestedArray("Tracks");
 
-    return _doc.as<JsonObject>();
+    for (long track : positions)
+    {
+        tracks.add(track);
+    }
 }
 
 /// <summary>
-/// Returns a (pretty) string representation of the current settings.
+/// Checks a track name (letters, digits, '_' and '-', at most MAX_NAME characters).
 /// </summary>
-/// <returns>The serialized JSON document.</returns>
-String AppSettings::StepperSettings::toJsonString()
+static bool isValidTrackName(const char* name)
 {
-    String json;
-    serializeJsonPretty(toJson(), json);
-    return json;
+    size_t length = strlen(name);
+
+    if ((length == 0) || (length > AppSettings::YardSettings::MAX_NAME)) return false;
+
+    for (size_t i = 0; i < length; i++)
+    {
+        if (!isAlphaNumeric(name[i]) && (name[i] != '_') && (name[i] != '-')) return false;
+    }
+
+    return true;
 }
 
 /// <summary>
-/// Creates a printable string representation of the settings.
+/// Checks the yard track table, an object of named positions or an array of positions (named by index).
+/// At least one and at most MAX_TRACKS tracks are required, the names and the positions must be unique.
+/// A missing table is valid.
 /// </summary>
-/// <returns>The printable string.</returns>
-String AppSettings::StepperSettings::toString()
+static bool isValidYardTracks(JsonVariantConst tracks, String& message)
 {
-    return String("Stepper:") + "\r\n" +
-                  "    PinPUL:              " + PinPUL              + "\r\n" +
-                  "    PinDIR:              " + PinDIR              + "\r\n" +
-                  "    PinENA:              " + PinENA              + "\r\n" +
-                  "    PinALM:              " + PinALM              + "\r\n" +
-                  "    MinSpeed:            " + MinSpeed            + "\r\n" +
-                  "    MaxSpeed:            " + MaxSpeed            + "\r\n" +
-                  "    MaxSteps:            " + MaxSteps            + "\r\n" +
-                  "    MicroSteps:          " + MicroSteps          + "\r\n" +
-                  "    StepsPerRotation:    " + StepsPerRotation    + "\r\n" +
-                  "    DistancePerRotation: " + DistancePerRotation + "\r\n";
+    const size_t MAX_TRACKS = AppSettings::YardSettings::MAX_TRACKS;
+
+    if (tracks.isNull()) return true;
+
+    String invalid = String("Invalid value for Tracks (object of 1 - ") + MAX_TRACKS + " named positions expected).";
+    const char* names[MAX_TRACKS];
+    long positions[MAX_TRACKS];
+    size_t count = 0;
+
+    if (tracks.is<JsonArrayConst>())
+    {
+        for (JsonVariantConst track : tracks.as<JsonArrayConst>())
+        {
+            if ((count == MAX_TRACKS) || !track.is<long>())
+            {
+                message = invalid;
+                return false;
+            }
+
+            positions[count++] = track.as<long>();
+        }
+    }
+    else if (tracks.is<JsonObjectConst>())
+    {
+        for (JsonPairConst track : tracks.as<JsonObjectConst>())
+        {
+            if ((count == MAX_TRACKS) || !track.value().is<long>())
+            {
+                message = invalid;
+                return false;
+            }
+
+            if (!isValidTrackName(track.key().c_str()))
+            {
+                message = String("Invalid track name '") + track.key().c_str() + "' (1 - " + AppSettings::YardSettings::MAX_NAME +
+                          " letters, digits, '_' or '-' expected).";
+                return false;
+            }
+
+            for (size_t i = 0; i < count; i++)
+            {
+                if (strcasecmp(names[i], track.key().c_str()) == 0)
+                {
+                    message = String("Duplicate track name '") + track.key().c_str() + "'.";
+                    return false;
+                }
+            }
+
+            names[count] = track.key().c_str();
+            positions[count++] = track.value().as<long>();
+        }
+    }
+
+    if (count == 0)
+    {
+        message = invalid;
+        return false;
+    }
+
+    std::sort(positions, positions + count);
+
+    for (size_t i = 1; i < count; i++)
+    {
+        if (positions[i] == positions[i - 1])
+        {
+            message = String("Duplicate track position ") + positions[i] + ".";
+            return false;
+        }
+    }
+
+    return true;
 }
 
 /// <summary>
-/// Update data fields from JSON representation.
+/// Gets the nearest track to the position. As the tracks are sorted by position, a binary search finds
+/// the first track at or above the position, the nearest track is either this one or the one below.
 /// </summary>
-/// <param name="json">The JSON object containing the settings.</param>
-void AppSettings::ServerSettings::fromJson(JsonObject json)
+/// <param name="position">The position (steps).</param>
+/// <returns>The track index (or -1 if there are no tracks).</returns>
+int AppSettings::YardSettings::findNearest(long position) const
 {
-    if (json != nullptr)
+    if (Count == 0) return -1;
+
+    size_t low  = 0;
+    size_t high = Count - 1;
+
+    while (low < high)
+    {
+        size_t middle = (low + high) / 2;
+
+        if (Tracks[middle].Position < position)
+            low = middle + 1;
+        else
+            high = middle;
+    }
+
+    if ((low > 0) && (position - Tracks[low - 1].Position < Tracks[low].Position - position))
     {
-        Http   = json["HttpPort"]   | Http;
-        Telnet = json["TelnetPort"] | Telnet;
-        Prompt = json["Prompt"]     | Prompt;
+        low--;
     }
+
+    return low;
 }
 
 /// <summary>
-/// Creates a JSON object with the current settings.
+/// Gets the track at the position (the nearest track within TRACK_WINDOW steps).
 /// </summary>
-/// <returns>The new JsonObject (pointing to the static JSON document).</returns>
-JsonObject AppSettings::ServerSettings::toJson()
+/// <param name="position">The position (steps).</param>
+/// <returns>The track index (or -1 if the position is between tracks).</returns>
+int AppSettings::YardSettings::findTrack(long position) const
 {
-    _doc.clear();
-    _doc["Http"]   = Http;
-    _doc["Telnet"] = Telnet;
-    _doc["Prompt"] = Prompt;
+    int index = findNearest(position);
 
-    return _doc.as<JsonObject>();
+    return ((index >= 0) && (labs(position - Tracks[index].Position) <= TRACK_WINDOW)) ? index : -1;
 }
 
 /// <summary>
-/// Returns a (pretty) string representation of the current settings.
+/// Gets the track by name (case insensitive).
 /// </summary>
-/// <returns>The serialized JSON document.</returns>
-String AppSettings::ServerSettings::toJsonString()
+/// <param name="name">The track name.</param>
+/// <returns>The track index (or -1 if not found).</returns>
+int AppSettings::YardSettings::findName(const String& name) const
 {
-    String json;
-    serializeJsonPretty(toJson(), json);
-    return json;
+    for (size_t i = 0; i < Count; i++)
+    {
+        if (Tracks[i].Name.equalsIgnoreCase(name)) return i;
+    }
+
+    return -1;
 }
 
 /// <summary>
-/// Creates a printable string representation of the settings.
+/// Gets the track by name, or by index (position order) if no track has this name.
 /// </summary>
-/// <returns>The printable string.</returns>
-String AppSettings::ServerSettings::toString()
+/// <param name="text">The track name or index.</param>
+/// <returns>The track index (or -1 if not found).</returns>
+int AppSettings::YardSettings::parseTrack(const String& text) const
+{
+    int index = findName(text);
+
+    if ((index < 0) && (text.length() > 0) && (text.length() < 4))
+    {
+        for (size_t i = 0; i < text.length(); i++)
+        {
+            if (!isDigit(text[i])) return -1;
+        }
+
+        if (size_t(text.toInt()) < Count) index = text.toInt();
+    }
+
+    return index;
+}
+
+/// <summary>
+/// Validates the JSON representation (the track table is replaced as a whole).
+/// </summary>
+/// <param name="json">The JSON object containing the settings.</param>
+/// <param name="message">The error message (if not valid).</param>
+/// <returns>True if valid.</returns>
+bool AppSettings::YardSettings::validate(JsonObject json, String& message)
 {
-    return String("Server:") + "\r\n" +
-                  "    Http:   " + Http   + "\r\n" +
-                  "    Telnet: " + Telnet + "\r\n" +
-                  "    Prompt: " + Prompt + "\r\n";
+    static const char* const NAMES[] = { "Tracks" };
+
+    if (!hasKnownFields(json, NAMES, 1, message)) return false;
+
+    return isValidYardTracks(json["Tracks"], message);
 }
 
 /// <summary>
-/// Update data fields from JSON representation.
+/// Update data fields from JSON representation. The tracks are sorted by position.
 /// </summary>
 /// <param name="json">The JSON object containing the settings.</param>
-void AppSettings::WiFiSettings::fromJson(JsonObject json)
+/// <returns>False if the track table is invalid (the tracks are unchanged).</returns>
+bool AppSettings::YardSettings::fromJson(JsonObject json)
 {
-    if (json != nullptr)
+    String message;
+
+    if (!validate(json, message)) return false;
+
+    JsonVariant tracks = json["Tracks"];
+
+    if (tracks.isNull()) return true;
+
+    Count = 0;
+
+    if (tracks.is<JsonArray>())
+    {
+        for (JsonVariant track : tracks.as<JsonArray>())
+        {
+            Tracks[Count].Name     = String(Count);
+            Tracks[Count].Position = track.as<long>();
+            Count++;
+        }
+    }
+    else
+    {
+        for (JsonPair track : tracks.as<JsonObject>())
+        {
+            Tracks[Count].Name     = track.key().c_str();
+            Tracks[Count].Position = track.value().as<long>();
+            Count++;
+        }
+    }
+
+    for (size_t i = Count; i < MAX_TRACKS; i++)
     {
-        DHCP     = json["DHCP"]     | DHCP;
-        SSID     = json["SSID"]     | SSID;
-        Password = json["Password"] | Password;
-        Hostname = json["Hostname"] | Hostname;
-        Address  = json["Address"]  | Address;
-        Gateway  = json["Gateway"]  | Gateway;
-        Subnet   = json["Subnet"]   | Subnet;
-        DNS      = json["DNS"]      | DNS;
+        Tracks[i] = Track();
     }
+
+    std::sort(Tracks.begin(), Tracks.begin() + Count,
+              [](const Track& a, const Track& b) { return a.Position < b.Position; });
+
+    return true;
 }
 
 /// <summary>
-/// Creates a JSON object with the current settings.
+/// Fills the JSON object with the current settings (the track names are not copied).
 /// </summary>
-/// <returns>The new JsonObject (pointing to the static JSON document).</returns>
-JsonObject AppSettings::WiFiSettings::toJson()
+/// <param name="json">The JSON object to be filled.</param>
+void AppSettings::YardSettings::toJson(JsonObject json)
 {
-    _doc.clear();
-    _doc["DHCP"]     = DHCP;
-    _doc["SSID"]     = SSID;
-    _doc["Password"] = Password;
-    _doc["Hostname"] = Hostname;
-    _doc["Address"]  = Address;
-    _doc["Gateway"]  = Gateway;
-    _doc["Subnet"]   = Subnet;
-    _doc["DNS"]      = DNS;
+    JsonObject tracks = json.createNestedObject("Tracks");
 
-    return _doc.as<JsonObject>();
+    for (size_t i = 0; i < Count; i++)
+    {
+        tracks[Tracks[i].Name.c_str()] = Tracks[i].Position;
+    }
 }
 
 /// <summary>
 /// Returns a (pretty) string representation of the current settings.
 /// </summary>
 /// <returns>The serialized JSON document.</returns>
-String AppSettings::WiFiSettings::toJsonString()
+String AppSettings::YardSettings::toJsonString()
 {
+    JsonArenaDocument doc(JSON_SIZE);
+    toJson(doc.to<JsonObject>());
+
     String json;
-    serializeJsonPretty(toJson(), json);
+    serializeJsonPretty(doc, json);
     return json;
 }
 
@@ -377,148 +590,857 @@ String AppSettings::WiFiSettings::toJsonString()
 /// Creates a printable string representation of the settings.
 /// </summary>
 /// <returns>The printable string.</returns>
-String AppSettings::WiFiSettings::toString()
+String AppSettings::YardSettings::toString()
 {
-    return String("WiFi:") + "\r\n" +
-                  "    DHCP:     " + ((DHCP == 1) ? "true" : "false") + "\r\n" +
-                  "    SSID:     " + SSID     + "\r\n" +
-                  "    Password: " + Password + "\r\n" +
-                  "    Hostname: " + Hostname + "\r\n" +
-                  "    Address:  " + Address  + "\r\n" +
-                  "    Gateway:  " + Gateway  + "\r\n" + 
-                  "    Subnet:   " + Subnet   + "\r\n" +
-                  "    DNS:      " + DNS      + "\r\n";
+    String text = "Yard:\r\n";
+
+    for (size_t i = 0; i < Count; i++)
+    {
+        text += String("    Track ") + Tracks[i].Name + ": " + Tracks[i].Position + "\r\n";
+    }
+
+    return text;
 }
 
 /// <summary>
-/// Update data fields from JSON representation.
+/// Writes the binary representation of the settings (used for the binary snapshot).
 /// </summary>
-/// <param name="json">The JSON object containing the settings.</param>
-void AppSettings::APSettings::fromJson(JsonObject json)
+/// <param name="out">The binary writer.</param>
+void AppSettings::YardSettings::write(BinaryWriter& out)
 {
-    if (json != nullptr)
+    out.write(uint16_t(Count));
+
+    for (size_t i = 0; i < Count; i++)
     {
-        SSID     = json["SSID"]     | SSID;
-        Password = json["Password"] | Password;
-        Hostname = json["Hostname"] | Hostname;
+        out.write(Tracks[i].Name);
+        out.write(Tracks[i].Position);
     }
 }
 
 /// <summary>
-/// Creates a JSON object with the current settings.
+/// Reads the binary representation of the settings (same order as written).
 /// </summary>
-/// <returns>The new JsonObject (pointing to the static JSON document).</returns>
-JsonObject AppSettings::APSettings::toJson()
+/// <param name="in">The binary reader.</param>
+void AppSettings::YardSettings::read(BinaryReader& in)
 {
-    _doc.clear();
-    _doc["SSID"]     = SSID;
-    _doc["Password"] = Password;
-    _doc["Hostname"] = Hostname;
+    uint16_t count = 0;
+    in.read(count);
+
+    Count = std::min(size_t(count), size_t(MAX_TRACKS));
 
-    return _doc.as<JsonObject>();
+    for (size_t i = 0; i < MAX_TRACKS; i++)
+    {
+        if (i < Count)
+        {
+            in.read(Tracks[i].Name);
+            in.read(Tracks[i].Position);
+        }
+        else
+        {
+            Tracks[i] = Track();
+        }
+    }
 }
 
 /// <summary>
-/// Returns a (pretty) string representation of the current settings.
+/// Validates the JSON representation of an additional axis (fields and tracks, nothing is changed).
 /// </summary>
-/// <returns>The serialized JSON document.</returns>
-String AppSettings::APSettings::toJsonString()
+/// <param name="json">The JSON object containing the settings.</param>
+/// <param name="message">The error message (if not valid).</param>
+/// <returns>True if valid.</returns>
+bool AppSettings::AxisSettings::validate(JsonObject json, String& message)
 {
-    String json;
-    serializeJsonPretty(toJson(), json);
-    return json;
+    static const char* const NAMES[] = { AXIS_FIELDS(SETTINGS_NAME) "Tracks" };
+
+    if (!hasKnownFields(json, NAMES, FIELD_COUNT + 1, message)) return false;
+    AXIS_FIELDS(SETTINGS_VALIDATE)
+
+    return isValidTracks(json["Tracks"], message);
 }
 
 /// <summary>
-/// Creates a printable string representation of the settings.
+/// Update data fields from JSON representation (valid values only).
 /// </summary>
-/// <returns>The printable string.</returns>
-String AppSettings::APSettings::toString()
+/// <param name="json">The JSON object containing the settings.</param>
+/// <returns>False if a value was invalid.</returns>
+bool AppSettings::AxisSettings::fromJson(JsonObject json)
 {
-    return String("AP :") + "\r\n" +
-                  "    SSID:     " + SSID     + "\r\n" +
-                  "    Password: " + Password + "\r\n" +
-                  "    Hostname: " + Hostname + "\r\n";
+    String message;
+    bool valid = true;
+    AXIS_FIELDS(SETTINGS_FROM_JSON)
+
+    if (isValidTracks(json["Tracks"], message))
+        tracksFromJson(json["Tracks"], Tracks);
+    else
+        valid = false;
+
+    return valid;
 }
 
 /// <summary>
-/// Loads all application settings reading from the 'appsettings.json' file.
-/// The default values are preserved if the particular setting is not found.
+/// Fills the JSON object with the current settings.
 /// </summary>
-/// <returns>True if successful.</returns>
-bool AppSettings::load()
+/// <param name="json">The JSON object to be filled.</param>
+void AppSettings::AxisSettings::toJson(JsonObject json)
 {
-    File file = LittleFS.open(SETTINGS_FILE, "r");
-    DeserializationError error = deserializeJson(_doc, file);
-    file.close();
+    AXIS_FIELDS(SETTINGS_TO_JSON)
+    tracksToJson(json, Tracks);
+}
 
-    if (error)
-    {
-        Serial.print(String("Deserialize settings from ") + SETTINGS_FILE + " failed: ");
-        Serial.println(error.f_str());
-        return false;
-    }
-    else
+/// <summary>
+/// Creates a printable string representation of the axis settings (the tracks are printed in a single line).
+/// </summary>
+/// <param name="index">The axis index.</param>
+/// <returns>The printable string.</returns>
+String AppSettings::AxisSettings::toString(int index)
+{
+    const size_t width = largest({ AXIS_FIELDS(SETTINGS_NAME_SIZE) });
+    String text = String("Axis") + index + ":\r\n";
+    AXIS_FIELDS(SETTINGS_TO_STRING)
+
+    String tracks;
+
+    for (int i = 0; i < MAX_TRACKS; i++)
     {
-        Yard.fromJson(_doc["Yard"]);
-        Actuator.fromJson(_doc["Actuator"]);
-        Stepper.fromJson(_doc["Stepper"]);
-        Server.fromJson(_doc["Server"]);
-        WiFi.fromJson(_doc["WiFi"]);
-        AP.fromJson(_doc["AP"]);
+        if (i > 0) tracks += ", ";
+        tracks += Tracks[i];
     }
 
-    return true;
+    appendField(text, "Tracks", tracks, width);
+    return text;
 }
 
 /// <summary>
-/// Saves the current settings (JSON document) in the 'appsettings.json' file.
+/// Writes the binary representation of the settings (used for the binary snapshot).
 /// </summary>
-/// <returns>True if successful.</returns>
-bool AppSettings::save()
+/// <param name="out">The binary writer.</param>
+void AppSettings::AxisSettings::write(BinaryWriter& out)
 {
-    _update();
-
-    File file = LittleFS.open(SETTINGS_FILE, "w");
-    size_t size = serializeJsonPretty(_doc, file);
-    file.close();
+    AXIS_FIELDS(SETTINGS_WRITE)
 
-    if (size == 0) {
-        Serial.print(String("Serialize  to ") + SETTINGS_FILE + " failed.");
-        return false;
+    for (long track : Tracks)
+    {
+        out.write(track);
     }
-
-    return true;
 }
 
 /// <summary>
-/// Returns a (pretty) string representation of the updated JSON document.
+/// Reads the binary representation of the settings (same order as written).
 /// </summary>
-/// <returns>The serialized JSON document.</returns>
-String AppSettings::toJsonString()
+/// <param name="in">The binary reader.</param>
+void AppSettings::AxisSettings::read(BinaryReader& in)
 {
-    _update();
-    
-    String json;
-    serializeJsonPretty(_doc, json);
-    return json;
+    AXIS_FIELDS(SETTINGS_READ)
+
+    for (long& track : Tracks)
+    {
+        in.read(track);
+    }
 }
 
 /// <summary>
-/// Returns a printable string representation of the application settings.
+/// The JSON names of the additional axes (not copied into the JSON document).
 /// </summary>
-/// <returns>The printable string.</returns>
-String AppSettings::toString()
+static const char* const AXIS_NAMES[AppSettings::AxesSettings::MAX_AXES] = { "Axis1", "Axis2" };
+
+/// <summary>
+/// Validates the JSON representation of the additional axes ("Axis1", "Axis2", ...).
+/// </summary>
+/// <param name="json">The JSON object containing the settings.</param>
+/// <param name="message">The error message (if not valid).</param>
+/// <returns>True if valid.</returns>
+bool AppSettings::AxesSettings::validate(JsonObject json, String& message)
 {
-    _update();
+    for (JsonPair pair : json)
+    {
+        int index = -1;
+
+        for (int i = 0; i < MAX_AXES; i++)
+        {
+            if (strcmp(pair.key().c_str(), AXIS_NAMES[i]) == 0) index = i;
+        }
+
+        if (index < 0)
+        {
+            message = String("Unknown axis ") + pair.key().c_str() + ".";
+            return false;
+        }
 
+        if (!pair.value().isNull() && !pair.value().is<JsonObject>())
+        {
+            message = String(pair.key().c_str()) + " must be an object.";
+            return false;
+        }
+
+        if (!Axis[index].validate(pair.value().as<JsonObject>(), message))
+        {
+            message = String(pair.key().c_str()) + ": " + message;
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Update data fields from JSON representation (valid values only).
+/// </summary>
+/// <param name="json">The JSON object containing the settings.</param>
+/// <returns>False if a value was invalid.</returns>
+bool AppSettings::AxesSettings::fromJson(JsonObject json)
+{
+    bool valid = true;
+
+    for (int i = 0; i < MAX_AXES; i++)
+    {
+        JsonObject axis = json[AXIS_NAMES[i]];
+
+        if (!axis.isNull())
+        {
+            valid &= Axis[i].fromJson(axis);
+        }
+    }
+
+    return valid;
+}
+
+/// <summary>
+/// Fills the JSON object with the current settings.
+/// </summary>
+/// <param name="json">The JSON object to be filled.</param>
+void AppSettings::AxesSettings::toJson(JsonObject json)
+{
+    for (int i = 0; i < MAX_AXES; i++)
+    {
+        Axis[i].toJson(json.createNestedObject(AXIS_NAMES[i]));
+    }
+}
+
+/// <summary>
+/// Returns a (pretty) string representation of the current settings.
+/// </summary>
+/// <returns>The serialized JSON document.</returns>
+String AppSettings::AxesSettings::toJsonString()
+{
+    JsonArenaDocument doc(JSON_SIZE);
+    toJson(doc.to<JsonObject>());
+
+    String json;
+    serializeJsonPretty(doc, json);
+    return json;
+}
+
+/// <summary>
+/// Creates a printable string representation of the settings.
+/// </summary>
+/// <returns>The printable string.</returns>
+String AppSettings::AxesSettings::toString()
+{
+    String text = "Axes:\r\n";
+
+    for (int i = 0; i < MAX_AXES; i++)
+    {
+        text += _addTab(Axis[i].toString(i + 1));
+    }
+
+    return text;
+}
+
+/// <summary>
+/// Writes the binary representation of the settings (used for the binary snapshot).
+/// </summary>
+/// <param name="out">The binary writer.</param>
+void AppSettings::AxesSettings::write(BinaryWriter& out)
+{
+    for (AxisSettings& axis : Axis)
+    {
+        axis.write(out);
+    }
+}
+
+/// <summary>
+/// Reads the binary representation of the settings (same order as written).
+/// </summary>
+/// <param name="in">The binary reader.</param>
+void AppSettings::AxesSettings::read(BinaryReader& in)
+{
+    for (AxisSettings& axis : Axis)
+    {
+        axis.read(in);
+    }
+}
+
+/// <summary>
+/// Loads all application settings. The binary snapshot is used if it is valid and has been created from the
+/// current 'appsettings.json' file. Otherwise the settings are read from the 'appsettings.json' file and a
+/// new binary snapshot is saved. The time used to read the settings is available in LoadTime, the time used
+/// to save the new snapshot in SnapshotTime (microseconds, zero if the snapshot has been used).
+/// </summary>
+/// <returns>True if successful.</returns>
+bool AppSettings::load()
+{
+    PROFILE_SCOPE(PROFILE_SETTINGS_LOAD);
+
+    unsigned long start = micros();
+
+    SnapshotTime = 0;
+    LoadedBinary = _loadBinary();
+
+    if (!LoadedBinary)
+    {
+        bool loaded = _loadJson();
+
+        LoadTime = micros() - start;
+
+        if (!loaded)
+        {
+            return false;
+        }
+
+        start = micros();
+        _saveBinary();
+        SnapshotTime = micros() - start;
+    }
+    else
+    {
+        LoadTime = micros() - start;
+    }
+
+    _setPersisted();
+
+    return true;
+}
+
+/// <summary>
+/// Loads all application settings reading from the 'appsettings.json' file.
+/// The default values are preserved if the particular setting is not found or invalid.
+/// </summary>
+/// <returns>True if successful.</returns>
+bool AppSettings::_loadJson()
+{
+    JsonArenaDocument doc(JSON_SIZE);
+    File file = LittleFS.open(SETTINGS_FILE, "r");
+    DeserializationError error = deserializeJson(doc, file);
+    file.close();
+
+    if (error)
+    {
+        Serial.print(String("Deserialize settings from ") + SETTINGS_FILE + " failed: ");
+        Serial.println(error.f_str());
+        return false;
+    }
+    else
+    {
+        // Invalid values are ignored (the default values are preserved).
+        bool valid = Yard.fromJson(doc["Yard"]) &
+                     Actuator.fromJson(doc["Actuator"]) &
+                     Stepper.fromJson(doc["Stepper"]) &
+                     Server.fromJson(doc["Server"]) &
+                     WiFi.fromJson(doc["WiFi"]) &
+                     AP.fromJson(doc["AP"]) &
+                     Axes.fromJson(doc["Axes"]);
+
+        if (!valid)
+        {
+            Serial.println(String("Invalid settings in ") + SETTINGS_FILE + " have been ignored.");
+        }
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Gets the size and the last write time of the 'appsettings.json' file.
+/// </summary>
+/// <param name="size">The file size.</param>
+/// <param name="time">The last write time.</param>
+/// <returns>True if the file exists.</returns>
+bool AppSettings::_getJsonInfo(uint32_t& size, uint32_t& time)
+{
+    File file = LittleFS.open(SETTINGS_FILE, "r");
+
+    if (!file)
+    {
+        size = 0;
+        time = 0;
+        return false;
+    }
+
+    size = file.size();
+    time = (uint32_t)file.getLastWrite();
+    file.close();
+
+    return true;
+}
+
+/// <summary>
+/// Loads the settings from the binary snapshot using a single read. The snapshot is only used if the
+/// version matches, the CRC is valid, and the 'appsettings.json' file has not been changed since.
+/// </summary>
+/// <returns>True if successful.</returns>
+bool AppSettings::_loadBinary()
+{
+    File file = LittleFS.open(SETTINGS_BINARY, "r");
+
+    if (!file)
+    {
+        return false;
+    }
+
+    static uint8_t buffer[BINARY_SIZE];         // Not on the stack (main loop only).
+    size_t size = file.read(buffer, sizeof(buffer));
+    file.close();
+
+    BinaryHeader header;
+
+    if (size < sizeof(header))
+    {
+        return false;
+    }
+
+    memcpy(&header, buffer, sizeof(header));
+
+    if ((header.Magic != BINARY_MAGIC) || (header.Version != BINARY_VERSION) || (sizeof(header) + header.Length != size))
+    {
+        return false;
+    }
+
+    uint32_t jsonSize;
+    uint32_t jsonTime;
+
+    // A missing JSON file does not invalidate the snapshot.
+    if (_getJsonInfo(jsonSize, jsonTime) && ((jsonSize != header.JsonSize) || (jsonTime != header.JsonTime)))
+    {
+        return false;
+    }
+
+    const uint8_t* data = &buffer[sizeof(header)];
+
+    if (crc32(data, header.Length) != header.Crc)
+    {
+        Serial.println(String("Settings snapshot ") + SETTINGS_BINARY + " is corrupt.");
+        return false;
+    }
+
+    BinaryReader in(data, header.Length);
+
+    Yard.read(in);
+    Actuator.read(in);
+    Stepper.read(in);
+    Server.read(in);
+    WiFi.read(in);
+    AP.read(in);
+    Axes.read(in);
+
+    return !in.failed() && (in.position() == header.Length);
+}
+
+/// <summary>
+/// Saves the current settings as binary snapshot (header and settings data written at once).
+/// </summary>
+/// <returns>True if successful.</returns>
+bool AppSettings::_saveBinary()
+{
+    static uint8_t buffer[BINARY_SIZE];         // Not on the stack (main loop only).
+    BinaryHeader header;
+    BinaryWriter out(&buffer[sizeof(header)], sizeof(buffer) - sizeof(header));
+
+    Yard.write(out);
+    Actuator.write(out);
+    Stepper.write(out);
+    Server.write(out);
+    WiFi.write(out);
+    AP.write(out);
+    Axes.write(out);
+
+    if (out.failed())
+    {
+        Serial.println(String("Settings snapshot ") + SETTINGS_BINARY + " too large.");
+        invalidate();
+        return false;
+    }
+
+    header.Magic   = BINARY_MAGIC;
+    header.Version = BINARY_VERSION;
+    header.Length  = out.length();
+    header.Crc     = crc32(&buffer[sizeof(header)], out.length());
+    _getJsonInfo(header.JsonSize, header.JsonTime);
+
+    memcpy(buffer, &header, sizeof(header));
+
+    File file = LittleFS.open(SETTINGS_BINARY, "w");
+    size_t size = file.write(buffer, sizeof(header) + out.length());
+    file.close();
+
+    return size == sizeof(header) + out.length();
+}
+
+/// <summary>
+/// Removes the binary snapshot. This is required when the 'appsettings.json' file has been replaced.
+/// </summary>
+void AppSettings::invalidate()
+{
+    if (LittleFS.exists(SETTINGS_BINARY))
+    {
+        LittleFS.remove(SETTINGS_BINARY);
+    }
+}
+
+/// <summary>
+/// Saves the changed settings sections in the 'appsettings.json' file (see commit()).
+/// </summary>
+/// <returns>True if successful.</returns>
+bool AppSettings::save()
+{
+    return commit();
+}
+
+/// <summary>
+/// Saves the settings if any section has been changed since the last save. Changes are detected by comparing
+/// the CRC-32 of every section with the CRC-32 saved. If nothing has changed the file is not written at all.
+/// The file is written to a temporary file first and renamed, and the binary snapshot is updated.
+/// </summary>
+/// <returns>True if successful.</returns>
+bool AppSettings::commit()
+{
+    _commitPending = false;
+
+    if (getDirty() == 0)
+    {
+        return true;
+    }
+
+    PROFILE_SCOPE(PROFILE_SETTINGS_SAVE);
+
+    JsonArenaDocument doc(JSON_SIZE);
+    _update(doc);
+
+    if (doc.overflowed())
+    {
+        Serial.println(String("Serialize to ") + SETTINGS_FILE + " failed (document too small).");
+        return false;
+    }
+
+    File file = LittleFS.open(SETTINGS_TEMP, "w");
+    size_t size = serializeJsonPretty(doc, file);
+    file.close();
+
+    if ((size == 0) || !LittleFS.rename(SETTINGS_TEMP, SETTINGS_FILE)) {
+        Serial.print(String("Serialize  to ") + SETTINGS_FILE + " failed.");
+        LittleFS.remove(SETTINGS_TEMP);
+        return false;
+    }
+
+    _saveBinary();
+    _setPersisted();
+
+    return true;
+}
+
+/// <summary>
+/// Requests a deferred commit. Several changes within COMMIT_DELAY are saved in a single write.
+/// </summary>
+void AppSettings::requestCommit()
+{
+    _commitPending = true;
+    _commitRequested = millis();
+}
+
+/// <summary>
+/// Runs a requested commit after COMMIT_DELAY. The commit is held while an axis is running (the flash write
+/// stalls the step interrupts) and runs once all axes are idle. This is called from the main loop.
+/// </summary>
+/// <param name="idle">True if no axis is running.</param>
+void AppSettings::run(bool idle)
+{
+    if (idle && _commitPending && (millis() - _commitRequested >= COMMIT_DELAY))
+    {
+        commit();
+    }
+}
+
+/// <summary>
+/// Returns the sections changed since the last save.
+/// </summary>
+/// <returns>The bit mask of the changed sections.</returns>
+uint8_t AppSettings::getDirty()
+{
+    uint8_t dirty = 0;
+
+    for (int i = 0; i < SECTIONS; i++)
+    {
+        if (_getSectionCrc(i) != _persisted[i])
+        {
+            dirty |= (1 << i);
+        }
+    }
+
+    return dirty;
+}
+
+/// <summary>
+/// Calculates the CRC-32 of the binary representation of the section.
+/// </summary>
+/// <param name="index">The section index.</param>
+/// <returns>The CRC-32 value.</returns>
+uint32_t AppSettings::_getSectionCrc(int index)
+{
+    static uint8_t buffer[BINARY_SIZE];         // Not on the stack (main loop only).
+    BinaryWriter out(buffer, sizeof(buffer));
+
+    switch (index)
+    {
+    case 0: Yard.write(out);     break;
+    case 1: Actuator.write(out); break;
+    case 2: Stepper.write(out);  break;
+    case 3: Server.write(out);   break;
+    case 4: WiFi.write(out);     break;
+    case 5: AP.write(out);       break;
+    case 6: Axes.write(out);     break;
+    }
+
+    return crc32(buffer, out.length());
+}
+
+/// <summary>
+/// Marks all sections as saved (stores the current CRC-32 of every section).
+/// </summary>
+void AppSettings::_setPersisted()
+{
+    for (int i = 0; i < SECTIONS; i++)
+    {
+        _persisted[i] = _getSectionCrc(i);
+    }
+}
+
+/// <summary>
+/// Returns the section index (the name is not case sensitive).
+/// </summary>
+/// <param name="name">The section name.</param>
+/// <returns>The section index (or -1 if not found).</returns>
+int AppSettings::findSection(const String& name)
+{
+    for (int i = 0; i < SECTIONS; i++)
+    {
+        if (name.equalsIgnoreCase(SECTION_NAMES[i]))
+        {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/// <summary>
+/// Returns the section name.
+/// </summary>
+/// <param name="index">The section index.</param>
+/// <returns>The section name (or an empty string if the index is invalid).</returns>
+const char* AppSettings::getSectionName(int index)
+{
+    return ((index >= 0) && (index < SECTIONS)) ? SECTION_NAMES[index] : "";
+}
+
+/// <summary>
+/// Returns a (pretty) string representation of the section.
+/// </summary>
+/// <param name="index">The section index.</param>
+/// <returns>The serialized JSON document (or an empty string if the index is invalid).</returns>
+String AppSettings::toJsonString(int index)
+{
+    switch (index)
+    {
+    case 0: return Yard.toJsonString();
+    case 1: return Actuator.toJsonString();
+    case 2: return Stepper.toJsonString();
+    case 3: return Server.toJsonString();
+    case 4: return WiFi.toJsonString();
+    case 5: return AP.toJsonString();
+    case 6: return Axes.toJsonString();
+    default: return String();
+    }
+}
+
+/// <summary>
+/// Applies a JSON merge patch (RFC 7396) to the settings. The patch contains an object for every section to
+/// be changed, members not present in the patch are left unchanged. As the settings have a fixed set of
+/// fields, null values (remove member) are ignored. Arrays and the track table (Yard.Tracks) are replaced as a whole.
+/// The additional axes are patched per axis (i.e. { "Axes": { "Axis2": { "Enabled": true } } }).
+/// Nothing is changed if the patch contains an unknown section, a section which is not an object,
+/// an unknown field, or an invalid value.
+/// </summary>
+/// <param name="patch">The merge patch.</param>
+/// <param name="changed">The sections actually changed (bit mask).</param>
+/// <param name="message">The error message (if not successful).</param>
+/// <returns>True if successful.</returns>
+bool AppSettings::patch(JsonObject patch, uint8_t& changed, String& message)
+{
+    changed = 0;
+
+    for (JsonPair pair : patch)
+    {
+        int index = findSection(pair.key().c_str());
+
+        if (index < 0)
+        {
+            message = String("Unknown settings section ") + pair.key().c_str() + ".";
+            return false;
+        }
+
+        if (!pair.value().isNull() && !pair.value().is<JsonObject>())
+        {
+            message = String("Settings section ") + SECTION_NAMES[index] + " must be an object.";
+            return false;
+        }
+
+        if (!_validate(index, pair.value().as<JsonObject>(), message))
+        {
+            message = String(SECTION_NAMES[index]) + ": " + message;
+            return false;
+        }
+    }
+
+    for (JsonPair pair : patch)
+    {
+        int index = findSection(pair.key().c_str());
+        JsonObject json = pair.value().as<JsonObject>();
+
+        if (json.isNull()) continue;
+
+        uint32_t crc = _getSectionCrc(index);
+
+        switch (index)
+        {
+        case 0: Yard.fromJson(json);     break;
+        case 1: Actuator.fromJson(json); break;
+        case 2: Stepper.fromJson(json);  break;
+        case 3: Server.fromJson(json);   break;
+        case 4: WiFi.fromJson(json);     break;
+        case 5: AP.fromJson(json);       break;
+        case 6: Axes.fromJson(json);     break;
+        }
+
+        if (_getSectionCrc(index) != crc)
+        {
+            changed |= (1 << index);
+        }
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Verifies that the file contains a valid application settings document. The file is parsed directly
+/// from the file stream and a filter restricts the document to the known sections, so the memory used
+/// does not depend on the file size.
+/// </summary>
+/// <param name="path">The path of the file to be verified.</param>
+/// <returns>True if valid.</returns>
+bool AppSettings::verify(const char* path)
+{
+    File file = LittleFS.open(path, "r");
+
+    if (!file)
+    {
+        return false;
+    }
+
+    StaticJsonDocument<128> filter;
+    filter["Yard"]     = true;
+    filter["Actuator"] = true;
+    filter["Stepper"]  = true;
+    filter["Server"]   = true;
+    filter["WiFi"]     = true;
+    filter["AP"]       = true;
+    filter["Axes"]     = true;
+
+    JsonArenaDocument doc(JSON_SIZE);
+    DeserializationError error = deserializeJson(doc, file, DeserializationOption::Filter(filter));
+    file.close();
+
+    if (error)
+    {
+        Serial.print(String("Verifying settings in ") + path + " failed: ");
+        Serial.println(error.f_str());
+        return false;
+    }
+
+    if (!doc.is<JsonObject>() || (doc.size() == 0))
+    {
+        return false;
+    }
+
+    for (JsonPair section : doc.as<JsonObject>())
+    {
+        String message;
+
+        if (!section.value().is<JsonObject>())
+        {
+            return false;
+        }
+
+        if (!_validate(findSection(section.key().c_str()), section.value().as<JsonObject>(), message))
+        {
+            Serial.println(String("Verifying settings in ") + path + " failed: " + section.key().c_str() + ": " + message);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/// <summary>
+/// Validates the JSON representation of the section (nothing is changed).
+/// </summary>
+/// <param name="index">The section index.</param>
+/// <param name="json">The JSON object containing the section.</param>
+/// <param name="message">The error message (if not valid).</param>
+/// <returns>True if valid.</returns>
+bool AppSettings::_validate(int index, JsonObject json, String& message)
+{
+    switch (index)
+    {
+    case 0: return Yard.validate(json, message);
+    case 1: return Actuator.validate(json, message);
+    case 2: return Stepper.validate(json, message);
+    case 3: return Server.validate(json, message);
+    case 4: return WiFi.validate(json, message);
+    case 5: return AP.validate(json, message);
+    case 6: return Axes.validate(json, message);
+    default:
+        message = "Unknown settings section.";
+        return false;
+    }
+}
+
+/// <summary>
+/// Returns a (pretty) string representation of the updated JSON document.
+/// </summary>
+/// <returns>The serialized JSON document.</returns>
+String AppSettings::toJsonString()
+{
+    JsonArenaDocument doc(JSON_SIZE);
+    _update(doc);
+
+    String json;
+    serializeJsonPretty(doc, json);
+    return json;
+}
+
+/// <summary>
+/// Returns a printable string representation of the application settings.
+/// </summary>
+/// <returns>The printable string.</returns>
+String AppSettings::toString()
+{
     return String("Application Settings:") + "\r\n" +
         _addTab(Yard.toString()) +
         _addTab(Actuator.toString()) +
         _addTab(Stepper.toString()) +
         _addTab(Server.toString()) +
         _addTab(WiFi.toString()) +
-        _addTab(AP.toString());
+        _addTab(AP.toString()) +
+        _addTab(Axes.toString());
 }
 
 
@@ -17,158 +17,343 @@
 #include <LittleFS.h>
 
 #define SETTINGS_FILE "appsettings.json"
+#define SETTINGS_BINARY "appsettings.bin"
+#define SETTINGS_TEMP "appsettings.tmp"
+#define SETTINGS_MAX_SIZE 8192
 #define ARDIUNOJSON_TAB "    "
 
 #include <ArduinoJson.h>
 
+#include "BinaryStream.h"
+#include "JsonArena.h"
+
+#include <type_traits>
+
+/// <summary>
+/// The settings field tables. Every field of a settings section is defined exactly once as
+///
+///     X(type, name, default, min, max)
+///
+/// The field declarations, the JSON, text and binary (de)serializers, the validation, and the JSON document
+/// capacities are all generated from these tables (see SETTINGS_SECTION and SETTINGS_IMPLEMENT in AppSettings.cpp).
+/// The min and max values are the valid range (for strings the valid length, for bool values they are not used).
+/// Note that the binary snapshot version (BINARY_VERSION) has to be incremented if a table is changed.
+/// </summary>
+#define ACTUATOR_FIELDS(X)                                                                                                \
+    X(uint8_t,  SwitchStop,          7,      0, 28)         /* The emergency stop input pin number. */                    \
+    X(uint8_t,  SwitchLimit1,        8,      0, 28)         /* The limit 1 input pin number (limit1). */                  \
+    X(uint8_t,  SwitchLimit2,        9,      0, 28)         /* The limit 2 input pin number (limit2). */                  \
+    X(uint8_t,  LedRunning,          4,      0, 28)         /* Led output pin number (is running). */                     \
+    X(uint8_t,  LedInLimit,          5,      0, 28)         /* Led output pin number (limit hit). */                      \
+    X(uint8_t,  LedAlarmOn,          6,      0, 28)         /* Led output pin number (alarm on). */                       \
+    X(float,    SmallStep,           1.0,    0, 100)        /* Small move distance (mm). */                               \
+    X(float,    MinStep,             2.5,    0, 100)        /* Minimal move distance (mm). */                             \
+    X(float,    Retract,             5.0,    0, 100)        /* Retract distance when limit switch is hit (mm). */         \
+    X(float,    Length,              500.0,  0, 10000)      /* Length of the linear actuator (mm). */
+
+#define STEPPER_FIELDS(X)                                                                                                 \
+    X(uint8_t,  PinPUL,              0,      0, 28)         /* The output pin number for driver PUL input (step). */      \
+    X(uint8_t,  PinDIR,              1,      0, 28)         /* The output pin number for driver DIR input (direction). */ \
+    X(uint8_t,  PinENA,              2,      0, 28)         /* The output pin number for driver ENA input (enable). */    \
+    X(uint8_t,  PinALM,              3,      0, 28)         /* The input pin number for driver ALM output (alarm). */     \
+    X(float,    MinSpeed,            1000.0, 1, 250000)     /* The minimum stepper speed in steps per second. */          \
+    X(float,    MaxSpeed,            5000.0, 1, 250000)     /* The maximum stepper speed in steps per second. */          \
+    X(long,     MaxSteps,            2500,   0, 1000000)    /* The ramp steps to maximum speed. */                        \
+    X(uint16_t, MicroSteps,          1,      1, 256)        /* The multiplication factor for steps (microsteps). */       \
+    X(uint16_t, StepsPerRotation,    200,    1, 10000)      /* The number of steps per rotation (360). */                \
+    X(float,    DistancePerRotation, 1.0,    0, 1000)       /* The distance in mm per rotation (360). */                 \
+    X(uint8_t,  Driver,              0,      0, 1)          /* The step generator (0: timer interrupt, 1: PIO and DMA). */
+
+#define AXIS_FIELDS(X)                                                                                                    \
+    X(bool,     Enabled,             false,  0, 1)          /* The axis is used (driven by the step engine). */           \
+    X(String,   Name,                "",     0, 16)         /* The axis name (i.e. Turntable). */                         \
+    X(uint8_t,  PinPUL,              10,     0, 28)         /* The output pin number for driver PUL input (step). */      \
+    X(uint8_t,  PinDIR,              11,     0, 28)         /* The output pin number for driver DIR input (direction). */ \
+    X(uint8_t,  PinENA,              12,     0, 28)         /* The output pin number for driver ENA input (enable). */    \
+    X(float,    MinSpeed,            1000.0, 1, 50000)      /* The minimum stepper speed in steps per second. */          \
+    X(float,    MaxSpeed,            5000.0, 1, 50000)      /* The maximum stepper speed in steps per second. */          \
+    X(long,     MaxSteps,            2500,   0, 1000000)    /* The ramp steps to maximum speed. */                        \
+    X(uint16_t, MicroSteps,          1,      1, 256)        /* The multiplication factor for steps (microsteps). */       \
+    X(uint16_t, StepsPerRotation,    200,    1, 10000)      /* The number of steps per rotation (360). */                \
+    X(float,    DistancePerRotation, 1.0,    0, 1000)       /* The distance in mm per rotation (360). */
+
+#define SERVER_FIELDS(X)                                                                                                  \
+    X(uint16_t, Http,                80,     1, 65535)      /* The Http Server port number. */                            \
+    X(uint16_t, Telnet,              23,     1, 65535)      /* The Telnet Server port number. */                          \
+    X(uint8_t,  Sessions,            2,      1, 4)          /* The maximum number of concurrent telnet sessions. */       \
+    X(String,   Prompt,              ">",    0, 16)         /* The command line input prompt. */
+
+#define WIFI_FIELDS(X)                                                                                                    \
+    X(bool,     DHCP,                true,   0, 1)          /* The WiFi DHCP mode. */                                     \
+    X(String,   SSID,                "",     0, 32)         /* The WiFi SSID. */                                          \
+    X(String,   Password,            "",     0, 63)         /* The WiFi Passphrase. */                                    \
+    X(String,   Hostname,            "",     0, 32)         /* The WiFi Hostname. */                                      \
+    X(String,   Address,             "",     0, 15)         /* The static Address. */                                     \
+    X(String,   Gateway,             "",     0, 15)         /* The Gateway address. */                                    \
+    X(String,   Subnet,              "",     0, 15)         /* The SubnetMask. */                                         \
+    X(String,   DNS,                 "",     0, 15)         /* The domain name server. */
+
+#define AP_FIELDS(X)                                                                                                      \
+    X(String,   SSID,                "",     0, 32)         /* The WiFi Access Point SSID. */                             \
+    X(String,   Password,            "",     0, 63)         /* The WiFi Access Point passphrase. */                       \
+    X(String,   Hostname,            "",     0, 32)         /* The WiFi Access Point hostname. */
+
+/// <summary>
+/// Returns the number of bytes a string field needs in a JSON document (the maximum length and terminator).
+/// </summary>
+template <typename T>
+constexpr size_t settingsTextSize(long max) { return std::is_same<T, String>::value ? (size_t)max + 1 : 0; }
+
+#define SETTINGS_DECLARE(type, name, value, min, max)    type name = value;
+#define SETTINGS_COUNT(type, name, value, min, max)      + 1
+#define SETTINGS_KEY_SIZE(type, name, value, min, max)   + sizeof(#name)
+#define SETTINGS_TEXT_SIZE(type, name, value, min, max)  + settingsTextSize<type>(max)
+
+/// <summary>
+/// Declares the fields and the generated members of a settings section. The JSON document capacities are exact:
+/// JSON_SIZE is used to serialize the section (keys are not copied), INPUT_SIZE to deserialize it (keys are copied).
+/// </summary>
+#define SETTINGS_SECTION(FIELDS)                                                                                          \
+    FIELDS(SETTINGS_DECLARE)                                                                                              \
+                                                                                                                          \
+    static constexpr const size_t FIELD_COUNT = 0 FIELDS(SETTINGS_COUNT);                                                 \
+    static constexpr const size_t JSON_SIZE   = JSON_OBJECT_SIZE(FIELD_COUNT) + (0 FIELDS(SETTINGS_TEXT_SIZE));           \
+    static constexpr const size_t INPUT_SIZE  = JSON_SIZE + (0 FIELDS(SETTINGS_KEY_SIZE));                                \
+                                                                                                                          \
+    bool validate(JsonObject json, String& message);    /* Validates a JSON representation (nothing is changed). */       \
+    bool fromJson(JsonObject json);                     /* Update from JSON representation (valid values only). */        \
+    void toJson(JsonObject json);                       /* Fill the JSON representation. */                               \
+    String toJsonString();                              /* Get a serialized JSON representation. */                       \
+    String toString();                                  /* Get a string representation. */                                \
+    void write(BinaryWriter& out);                      /* Write the binary representation. */                            \
+    void read(BinaryReader& in);                        /* Read the binary representation. */
+
 class AppSettings
 {
+public:
+    static const int SECTIONS = 7;              // The number of settings sections.
+    static const unsigned long COMMIT_DELAY = 2000;     // The delay (ms) before requested changes are saved.
+
+    /// <summary>
+    /// The settings sections (bit mask used to mark changed sections).
+    /// </summary>
+    enum Section : uint8_t
+    {
+        SECTION_YARD     = 0x01,
+        SECTION_ACTUATOR = 0x02,
+        SECTION_STEPPER  = 0x04,
+        SECTION_SERVER   = 0x08,
+        SECTION_WIFI     = 0x10,
+        SECTION_AP       = 0x20,
+        SECTION_AXES     = 0x40,
+        SECTION_ALL      = 0x7F
+    };
+
 private:
-    static const int MAX_LINES = 12;            // The maximum number of lines in tabbed printout.
-    StaticJsonDocument<1536> _doc;              // The Json document representing the application settings.
+    static const char* SECTION_NAMES[SECTIONS]; // The section names (as used in the JSON file).
+    static const uint32_t BINARY_MAGIC = 0x31535959;    // The binary snapshot magic ("YYS1").
+    static const uint16_t BINARY_VERSION = 5;   // The binary snapshot version (increment if the fields change).
+    static const size_t BINARY_SIZE = 2048;     // The maximum binary snapshot size (header and data).
+
+    /// <summary>
+    /// The binary snapshot header. The JSON file size and last write time are used to detect a changed JSON file.
+    /// </summary>
+    struct BinaryHeader
+    {
+        uint32_t Magic;                         // The magic number (BINARY_MAGIC).
+        uint16_t Version;                       // The snapshot version (BINARY_VERSION).
+        uint16_t Length;                        // The length of the settings data following the header.
+        uint32_t JsonSize;                      // The size of the JSON file the snapshot was created from.
+        uint32_t JsonTime;                      // The last write time of the JSON file the snapshot was created from.
+        uint32_t Crc;                           // The CRC-32 of the settings data.
+    };
 
     String _addTab(String text);                // Tabify the string (breaking on LF).
-    void _update();                             // Updates the Json document.
+    void _update(JsonDocument& doc);            // Updates the Json document.
+    bool _loadJson();                           // Loads the settings from the appsettings.json file.
+    bool _loadBinary();                         // Loads the settings from the binary snapshot (if valid).
+    bool _saveBinary();                         // Saves the settings as binary snapshot.
+    bool _getJsonInfo(uint32_t& size, uint32_t& time);  // Gets the JSON file size and last write time.
+
+    uint32_t _persisted[SECTIONS];              // The CRC-32 of every section as saved in the file.
+    bool _commitPending = false;                // Flag indicating that a (deferred) commit has been requested.
+    unsigned long _commitRequested = 0;         // Time of the last commit request (millis).
+
+    uint32_t _getSectionCrc(int index);         // Calculates the CRC-32 of the section (binary representation).
+    void _setPersisted();                       // Marks all sections as saved.
+    bool _validate(int index, JsonObject json, String& message);    // Validates the JSON representation of the section.
 
 public:
+    /// <summary>
+    /// The yard track table (axis 0). The tracks are named ("Tracks": { "Name": position, ... }) and sorted
+    /// by position, so a position is mapped to a track by a binary search (see findTrack()). A position is at
+    /// a track if within TRACK_WINDOW steps, otherwise it is between tracks. The table is replaced as a whole.
+    /// A plain array of positions (the previous format) is accepted, the tracks are named by their index.
+    /// </summary>
     class YardSettings
     {
-    private:
-        StaticJsonDocument<256> _doc;           // The Json document representing the settings.
-
     public:
-        static const int MAX_TRACKS = 10;       // The number of supported tracks.
-
-        std::array<long, YardSettings::MAX_TRACKS> Tracks = {
-            1600 * 0,                           // default track position track 0.
-            1600 * 33,                          // default track position track 1.
-            1600 * 66,                          // default track position track 2.
-            1600 * 99,                          // default track position track 3.
-            1600 * 132,                         // default track position track 4.
-            1600 * 165,                         // default track position track 5.
-            1600 * 198,                         // default track position track 6.
-            1600 * 231,                         // default track position track 7.
-            1600 * 264,                         // default track position track 8.
-            1600 * 297                          // default track position track 9.
+        static const int    MAX_TRACKS   = 64;  // The maximum number of tracks.
+        static const size_t MAX_NAME     = 15;  // The maximum length of a track name.
+        static const long   TRACK_WINDOW = 16;  // The maximum distance (steps) of a position at a track.
+
+        static constexpr const size_t JSON_SIZE  = JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(MAX_TRACKS);
+        static constexpr const size_t INPUT_SIZE = JSON_SIZE + sizeof("Tracks") + MAX_TRACKS * (MAX_NAME + 1);
+
+        /// <summary>
+        /// A named track position.
+        /// </summary>
+        struct Track
+        {
+            String Name;                        // The track name (letters, digits, '_' and '-').
+            long   Position = 0;                // The track position (steps).
         };
 
-        void fromJson(JsonObject json);         // Update from JSON representation.
+        std::array<Track, MAX_TRACKS> Tracks = { {
+            { "0", 1600 * 0   },                // default track position track 0.
+            { "1", 1600 * 33  },                // default track position track 1.
+            { "2", 1600 * 66  },                // default track position track 2.
+            { "3", 1600 * 99  },                // default track position track 3.
+            { "4", 1600 * 132 },                // default track position track 4.
+            { "5", 1600 * 165 },                // default track position track 5.
+            { "6", 1600 * 198 },                // default track position track 6.
+            { "7", 1600 * 231 },                // default track position track 7.
+            { "8", 1600 * 264 },                // default track position track 8.
+            { "9", 1600 * 297 }                 // default track position track 9.
+        } };
+
+        size_t Count = 10;                      // The number of tracks (sorted by position).
+
+        int findTrack(long position) const;     // Gets the track at the position (or -1 if between tracks).
+        int findNearest(long position) const;   // Gets the nearest track (or -1 if there are no tracks).
+        int findName(const String& name) const; // Gets the track by name (case insensitive, or -1 if unknown).
+        int parseTrack(const String& text) const;   // Gets the track by name or index (or -1 if unknown).
+
+        bool validate(JsonObject json, String& message);    // Validates a JSON representation (nothing is changed).
+        bool fromJson(JsonObject json);         // Update from JSON representation (valid values only).
+        void toJson(JsonObject json);           // Fill the JSON representation.
         String toJsonString(); 	                // Get a serialized JSON representation.
-        JsonObject toJson();                    // Get a JSON representation.
         String toString();                      // Get a string representation.
+        void write(BinaryWriter& out);          // Write the binary representation.
+        void read(BinaryReader& in);            // Read the binary representation.
     };
 
     class ActuatorSettings
     {
-    private:
-        StaticJsonDocument<256> _doc;           // The Json document representing the settings.
+    public:
+        SETTINGS_SECTION(ACTUATOR_FIELDS)
+    };
 
+    class StepperSettings
+    {
     public:
-        uint8_t  SwitchStop   = 7;              // The emergency stop input pin number.
-        uint8_t  SwitchLimit1 = 8;              // The limit 1 input pin number (limit1).
-        uint8_t  SwitchLimit2 = 9;              // The limit 2 input pin number (limit2).
+        SETTINGS_SECTION(STEPPER_FIELDS)
+    };
 
-        uint8_t  LedRunning   = 4;              // Led output pin number (is running).
-        uint8_t  LedInLimit   = 5;              // Led output pin number (limit hit).
-        uint8_t  LedAlarmOn   = 6;              // Led output pin number (alarm on).
+    /// <summary>
+    /// The settings of an additional axis (i.e. a second traverser or a turntable). The first axis is
+    /// described by the Actuator, Stepper and Yard sections. The additional axes use the timer interrupt
+    /// (step engine), the safety inputs (stop, limits) and LEDs are those of the first axis.
+    /// </summary>
+    class AxisSettings
+    {
+    public:
+        AXIS_FIELDS(SETTINGS_DECLARE)
 
-        float    SmallStep    = 1;              // Small move distance (mm).
-        float    MinStep      = 2.5;            // Minimal move distance (mm).
-        float    Retract      = 5.0;            // Retract distance when limit switch is hit (mm).
-        float    Length       = 500.0;          // Length of the linear actuator (mm).
+        static const int MAX_TRACKS = 10;       // The number of supported tracks.
 
-        void fromJson(JsonObject json);         // Update from JSON representation.
-        String toJsonString(); 	                // Get a serialized JSON representation.
-        JsonObject toJson();                    // Get a JSON representation.
-        String toString();                      // Get a string representation.
+        std::array<long, MAX_TRACKS> Tracks = {};   // The track positions (steps).
+
+        static constexpr const size_t FIELD_COUNT = 0 AXIS_FIELDS(SETTINGS_COUNT);
+        static constexpr const size_t JSON_SIZE   = JSON_OBJECT_SIZE(FIELD_COUNT + 1) + JSON_ARRAY_SIZE(MAX_TRACKS) +
+                                                    (0 AXIS_FIELDS(SETTINGS_TEXT_SIZE));
+        static constexpr const size_t INPUT_SIZE  = JSON_SIZE + (0 AXIS_FIELDS(SETTINGS_KEY_SIZE)) + sizeof("Tracks");
+
+        bool validate(JsonObject json, String& message);    // Validates a JSON representation (nothing is changed).
+        bool fromJson(JsonObject json);         // Update from JSON representation (valid values only).
+        void toJson(JsonObject json);           // Fill the JSON representation.
+        String toString(int index);             // Get a string representation.
+        void write(BinaryWriter& out);          // Write the binary representation.
+        void read(BinaryReader& in);            // Read the binary representation.
     };
 
-    class StepperSettings
+    /// <summary>
+    /// The additional axes (as JSON object "Axis1", "Axis2", ...). The axis index 0 is the first axis.
+    /// </summary>
+    class AxesSettings
     {
-    private:
-        StaticJsonDocument<256> _doc;           // The Json document representing the settings.
-
     public:
-        uint8_t  PinPUL              = 0;       // The output pin number for driver PUL input (step).
-        uint8_t  PinDIR              = 1;       // The output pin number for driver DIR input (direction).
-        uint8_t  PinENA              = 2;       // The output pin number for driver ENA input (enable).
-        uint8_t  PinALM              = 3;       // The input pin number for driver ALM output (alarm).
-
-        float    MinSpeed            = 1000.0;  // The minimum stepper speed in steps per second.
-        float    MaxSpeed            = 5000.0;  // The maximum stepper speed in steps per second.
-        long     MaxSteps            = 2500.0;  // The ramp steps to maximum speed.
-        uint8_t  MicroSteps          = 1;       // The multiplication factor for steps (microsteps).
-        uint16_t StepsPerRotation    = 200;     // The number of steps per rotation (360).
-        float    DistancePerRotation = 1.0;     // The distance in mm per rotation (360).
-
-        void fromJson(JsonObject json);         // Update from JSON representation.
+        static const int MAX_AXES = 2;          // The number of additional axes.
+
+        static constexpr const size_t JSON_SIZE  = JSON_OBJECT_SIZE(MAX_AXES) + MAX_AXES * AxisSettings::JSON_SIZE;
+        static constexpr const size_t INPUT_SIZE = JSON_OBJECT_SIZE(MAX_AXES) + MAX_AXES * (AxisSettings::INPUT_SIZE + sizeof("Axis1"));
+
+        std::array<AxisSettings, MAX_AXES> Axis;
+
+        bool validate(JsonObject json, String& message);    // Validates a JSON representation (nothing is changed).
+        bool fromJson(JsonObject json);         // Update from JSON representation (valid values only).
+        void toJson(JsonObject json);           // Fill the JSON representation.
         String toJsonString(); 	                // Get a serialized JSON representation.
-        JsonObject toJson();                    // Get a JSON representation.
-        String toString(); 	                    // Get a string representation.
+        String toString();                      // Get a string representation.
+        void write(BinaryWriter& out);          // Write the binary representation.
+        void read(BinaryReader& in);            // Read the binary representation.
     };
-    
+
     class ServerSettings
     {
-    private:
-        StaticJsonDocument<256> _doc;           // The Json document representing the settings.
-
     public:
-        uint16_t Http   = 80;                   // The Http Server port number.
-        uint16_t Telnet = 23;                   // The Telnet Server port number.
-        String   Prompt = ">";                  // The command line input prompt.
-
-        void fromJson(JsonObject json);         // Update from JSON representation.
-        String toJsonString(); 	                // Get a serialized JSON representation.
-        JsonObject toJson();                    // Get a JSON representation.
-        String toString();                      // Get a string representation.
+        SETTINGS_SECTION(SERVER_FIELDS)
     };
 
     class WiFiSettings
     {
-    private:
-        StaticJsonDocument<384> _doc;           // The Json document representing the settings.
-
     public:
-        bool   DHCP = true;		                // The WiFi DHCP mode.
-        String SSID;		                    // The WiFi SSID.
-        String Password;	                    // The WiFi Passphrase.
-        String Hostname;	                    // The WiFi Hostname.
-        String Address;                         // The static Address.
-        String Gateway;		                    // The Gateway address.
-        String Subnet;		                    // The SubnetMask.
-        String DNS;			                    // The domain name server.
-
-        void fromJson(JsonObject json);         // Update from JSON representation.
-        String toJsonString(); 	                // Get a serialized JSON representation.
-        JsonObject toJson();                    // Get a JSON representation.
-        String toString();                      // Get a string representation.
+        SETTINGS_SECTION(WIFI_FIELDS)
     };
 
     class APSettings
     {
-    private:
-        StaticJsonDocument<192> _doc;           // The Json document representing the settings.
-
     public:
-        String SSID;	                        // The WiFi Access Point SSID.
-        String Password;                        // The WiFi Access Point passphrase.
-        String Hostname;                        // The WiFi Access Point hostname
-
-        void fromJson(JsonObject json);         // Update from JSON representation.
-        String toJsonString(); 	                // Get a serialized JSON representation.
-        JsonObject toJson();                    // Get a JSON representation.
-        String toString();                      // Get a string representation.
+        SETTINGS_SECTION(AP_FIELDS)
     };
 
+    /// <summary>
+    /// The JSON document capacity for all settings (sections and section names, as read from the file).
+    /// </summary>
+    static constexpr const size_t JSON_SIZE = JSON_OBJECT_SIZE(SECTIONS) +
+        YardSettings::INPUT_SIZE     + sizeof("Yard") +
+        ActuatorSettings::INPUT_SIZE + sizeof("Actuator") +
+        StepperSettings::INPUT_SIZE  + sizeof("Stepper") +
+        ServerSettings::INPUT_SIZE   + sizeof("Server") +
+        WiFiSettings::INPUT_SIZE     + sizeof("WiFi") +
+        APSettings::INPUT_SIZE       + sizeof("AP") +
+        AxesSettings::INPUT_SIZE     + sizeof("Axes");
+
     YardSettings     Yard;                      // 
     ActuatorSettings Actuator;                  // 
     StepperSettings  Stepper;                   // 
     ServerSettings   Server;                    // 
     WiFiSettings     WiFi;                      // 
     APSettings       AP;                        // 
-
-    bool load();                                // Loads the settings from the appsettings.json file.
-    bool save();                                // Updates and saves the settings to the appsettings.json file.
+    AxesSettings     Axes;                      // The additional axes.
+
+    unsigned long LoadTime = 0;                 // The time used to load the settings (microseconds).
+    unsigned long SnapshotTime = 0;             // The time used to save a new binary snapshot (microseconds).
+    bool LoadedBinary = false;                  // Flag indicating that the settings were loaded from the binary snapshot.
+
+    bool load();                                // Loads the settings (binary snapshot or appsettings.json file).
+    bool save();                                // Saves the changed sections to the appsettings.json file.
+    bool commit();                              // Saves the changed sections to the appsettings.json file.
+    void requestCommit();                       // Requests a deferred commit (changes are saved after COMMIT_DELAY).
+    void run(bool idle);                        // Runs a requested commit (main loop, idle: no axis running).
+    uint8_t getDirty();                         // Returns the sections changed since the last save (bit mask).
+
+    int findSection(const String& name);        // Returns the section index (or -1 if not found).
+    const char* getSectionName(int index);      // Returns the section name.
+    String toJsonString(int index);             // Get a serialized JSON representation of the section.
+    bool patch(JsonObject patch, uint8_t& changed, String& message);  // Applies a JSON merge patch (RFC 7396).
+    void invalidate();                          // Removes the binary snapshot (the JSON file has been replaced).
+    bool verify(const char* path);              // Verifies that the file contains valid application settings.
 
     String toJsonString(); 	                    // Get a serialized JSON representation.
     String toString(); 		                    // Get a string representation.
@@ -0,0 +1,39 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="BinaryStream.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 3:05 PM</created>
+// <modified>18-10-2026 3:05 PM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include "BinaryStream.h"
+
+/// <summary>
+/// Calculates the CRC-32 (IEEE 802.3, reflected polynomial 0xEDB88320) of the data. A nibble table is
+/// used (64 bytes) as the data is small and calculated only when the settings are loaded or saved.
+/// </summary>
+/// <param name="data">The data.</param>
+/// <param name="size">The number of bytes.</param>
+/// <param name="crc">The previous CRC (used to calculate the CRC over several blocks).</param>
+/// <returns>The CRC-32 value.</returns>
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc)
+{
+    static const uint32_t TABLE[16] = {
+        0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+        0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+    };
+
+    crc = ~crc;
+
+    for (size_t i = 0; i < size; i++)
+    {
+        crc = TABLE[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+        crc = TABLE[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+    }
+
+    return ~crc;
+}
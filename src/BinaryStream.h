@@ -0,0 +1,124 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="BinaryStream.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 3:05 PM</created>
+// <modified>18-10-2026 3:05 PM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   Helper classes to write and read plain values and strings to and from a fixed memory buffer.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <type_traits>
+
+/// <summary>
+/// Calculates the CRC-32 (IEEE 802.3) of the data.
+/// </summary>
+uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+/// <summary>
+/// This class writes values (little endian, as in memory) and strings (length prefixed) to a buffer.
+/// If the buffer is too small the failed flag is set and all further writes are ignored.
+/// </summary>
+class BinaryWriter
+{
+private:
+    uint8_t* _buffer;                               // The buffer.
+    size_t   _size;                                 // The buffer size.
+    size_t   _position = 0;                         // The current write position.
+    bool     _failed   = false;                     // Flag indicating a buffer overflow.
+
+public:
+    BinaryWriter(uint8_t* buffer, size_t size) : _buffer(buffer), _size(size) {}
+
+    template <typename T>
+    void write(const T& value)                      // Writes a (trivially copyable) value.
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be written.");
+        writeBytes(&value, sizeof(T));
+    }
+
+    void write(const String& value)                 // Writes a string (16 bit length followed by the characters).
+    {
+        uint16_t length = value.length();
+        write(length);
+        writeBytes(value.c_str(), length);
+    }
+
+    void writeBytes(const void* data, size_t size)  // Writes the raw bytes.
+    {
+        if (_failed || (_position + size > _size))
+        {
+            _failed = true;
+            return;
+        }
+
+        memcpy(&_buffer[_position], data, size);
+        _position += size;
+    }
+
+    inline size_t length() const { return _position; }
+    inline bool failed() const { return _failed; }
+};
+
+/// <summary>
+/// This class reads values and strings written by the BinaryWriter from a buffer.
+/// If the buffer does not contain enough data the failed flag is set and the values are left unchanged.
+/// </summary>
+class BinaryReader
+{
+private:
+    const uint8_t* _buffer;                         // The buffer.
+    size_t         _size;                           // The number of bytes in the buffer.
+    size_t         _position = 0;                   // The current read position.
+    bool           _failed   = false;               // Flag indicating that not enough data is available.
+
+public:
+    BinaryReader(const uint8_t* buffer, size_t size) : _buffer(buffer), _size(size) {}
+
+    template <typename T>
+    void read(T& value)                             // Reads a (trivially copyable) value.
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "Only plain values can be read.");
+        readBytes(&value, sizeof(T));
+    }
+
+    void read(String& value)                        // Reads a string (16 bit length followed by the characters).
+    {
+        uint16_t length = 0;
+        read(length);
+
+        if (_failed || (_position + length > _size))
+        {
+            _failed = true;
+            return;
+        }
+
+        value = String();
+        value.concat((const char*)&_buffer[_position], length);
+        _position += length;
+    }
+
+    void readBytes(void* data, size_t size)         // Reads the raw bytes.
+    {
+        if (_failed || (_position + size > _size))
+        {
+            _failed = true;
+            return;
+        }
+
+        memcpy(data, &_buffer[_position], size);
+        _position += size;
+    }
+
+    inline size_t position() const { return _position; }
+    inline bool failed() const { return _failed; }
+};
@@ -13,6 +13,10 @@
 #include <StringSplitter.h>
 
 #include "Commands.h"
+#include "UserInterface.h"
+
+extern MetricsClass Metrics;
+extern UserInterface UserIO;
 
 /// <summary>
 /// Helper function to pad a string to a specified length.
@@ -82,10 +86,14 @@ int CommandsClass::_findBaseCommandByName(String name)
 void CommandsClass::_processBaseCommand(int index)
 {
     BaseCommand cmd = _baseCommands[index];
-    _lastCommand = cmd;
+    UserIO.getContext()->LastCommand = index;
+    _baseCounters[index].inc();
 
     if (cmd.func != nullptr)
+    {
+        PROFILE_SCOPE(_baseSites[index]);
         cmd.func();
+    }
 }
 
 /// <summary>
@@ -150,7 +158,10 @@ void CommandsClass::_processLongCommand(int index, String arg)
     cmd.Number = value;
 
     if (cmd.func != nullptr)
+    {
+        PROFILE_SCOPE(_longSites[index]);
         cmd.func(cmd.Number);
+    }
 }
 
 /// <summary>
@@ -215,7 +226,72 @@ void CommandsClass::_processFloatCommand(int index, String arg)
     cmd.Number = value;
 
     if (cmd.func != nullptr)
+    {
+        PROFILE_SCOPE(_floatSites[index]);
         cmd.func(cmd.Number);
+    }
+}
+
+/// <summary>
+/// Checks for a StringCommand by shortcut. Returns the command index (or -1 if not found).
+/// </summary>
+/// <param name="shortcut">The command shortcut.</param>
+/// <returns>The command index.</returns>
+int CommandsClass::_findStringCommandByShortcut(String shortcut)
+{
+    int index = -1;
+    shortcut.toLowerCase();
+
+    for (int i = 0; i < MAX_STRING_COMMANDS; i++)
+    {
+        if (_stringCommands[i].Shortcut == shortcut)
+        {
+            index = i;
+            break;
+        }
+    }
+
+    return index;
+}
+
+/// <summary>
+/// Checks for a StringCommand by name. Returns the command index (or -1 if not found).
+/// </summary>
+/// <param name="shortcut">The command name.</param>
+/// <returns>The command index.</returns>
+int CommandsClass::_findStringCommandByName(String name)
+{
+    int index = -1;
+    name.toLowerCase();
+
+    for (int i = 0; i < MAX_STRING_COMMANDS; i++)
+    {
+        if (_stringCommands[i].Name == name)
+        {
+            index = i;
+            break;
+        }
+    }
+
+    return index;
+}
+
+/// <summary>
+/// Process the StringCommand using the command index. Calls the command callback function (the argument is
+/// checked by the callback, i.e. a track name).
+/// </summary>
+/// <param name="index">The command index.</param>
+/// <param name="arg">The command argument.</param>
+void CommandsClass::_processStringCommand(int index, String arg)
+{
+    StringCommand cmd = _stringCommands[index];
+    cmd.Text = arg;
+
+    if (cmd.func != nullptr)
+    {
+        PROFILE_SCOPE(_stringSites[index]);
+        cmd.func(cmd.Text);
+    }
 }
 
 /// <summary>
@@ -225,13 +301,16 @@ void CommandsClass::_processFloatCommand(int index, String arg)
 /// <param name="command"></param>
 void CommandsClass::parse(String command)
 {
+    // The command state of the current user (telnet session, SerialBT, or HTTP).
+    UserContext* context = UserIO.getContext();
+
     // Check for empty input.
     if (command.length() == 0)
     {
         nop();
 
-        if (WaitForResponse)
-            WaitForResponse = false;
+        if (context->WaitForResponse)
+            context->WaitForResponse = false;
 
         return;
     }
@@ -259,8 +338,8 @@ void CommandsClass::parse(String command)
     {
         char c = temp[index];
 
-        // Allowed characters are digits, alpha, space, dot, plus, minus, and question mark.
-        if (!(isAlphaNumeric(c) || isSpace(c) || (c == '.') || (c == '+') || (c == '-') || (c == '?')))
+        // Allowed characters are digits, alpha, space, dot, comma, plus, minus, underscore, and question mark.
+        if (!(isAlphaNumeric(c) || isSpace(c) || (c == '.') || (c == ',') || (c == '+') || (c == '-') || (c == '_') || (c == '?')))
         {
             command.remove(index);
         }
@@ -271,24 +350,25 @@ void CommandsClass::parse(String command)
     {
         nop();
 
-        if (WaitForResponse)
-            WaitForResponse = false;
+        if (context->WaitForResponse)
+            context->WaitForResponse = false;
 
         return;
     }
 
     // Check if we are waiting for a response
-    if (WaitForResponse)
+    if (context->WaitForResponse)
     {
-        // If response starts with 'Y' call last command callback.
-        if (command[0] == 'y')
+        // If response starts with 'Y' call last command callback (the callback still sees the flag set).
+        if ((command[0] == 'y') && (context->LastCommand >= 0))
         {
-            _lastCommand.func();
+            _baseCommands[context->LastCommand].func();
+            context->WaitForResponse = false;
             return;
         }
 
         // Ignore all other inputs.
-        WaitForResponse = false;
+        context->WaitForResponse = false;
         return;
     }
 
@@ -349,6 +429,11 @@ void CommandsClass::parse(String command)
                         // If a float command has been found, display error message.
                         error(String("Command '") + command + "' expects a single (float) argument");
                     }
+                    else if (_findStringCommandByName(arg0) != -1)
+                    {
+                        // If a string command has been found, display error message.
+                        error(String("Command '") + command + "' expects a single argument");
+                    }
                     else
                     {
                         // If the command cannot be found call error callback function.
@@ -383,6 +468,11 @@ void CommandsClass::parse(String command)
                     // If a float command shortcut has been found, process the command.
                     _processFloatCommand(index, arg1);
                 }
+                else if ((index = _findStringCommandByShortcut(arg0)) != -1)
+                {
+                    // If a string command shortcut has been found, process the command.
+                    _processStringCommand(index, arg1);
+                }
                 else
                 {
                     error(String("Unknown shortcut '") + command + "' - use help to show available commands");
@@ -407,6 +497,11 @@ void CommandsClass::parse(String command)
                     // If a float command has been found, call callback function.
                     _processFloatCommand(index, arg1);
                 }
+                else if ((index = _findStringCommandByName(arg0)) != -1)
+                {
+                    // If a string command has been found, call callback function.
+                    _processStringCommand(index, arg1);
+                }
                 else
                 {
                     // If the command cannot be found call error callback function.
@@ -487,6 +582,18 @@ String CommandsClass::getHelp()
         }
     }
 
+    // Generate the help string for the available string commands (with shortcut).
+    for (int i = 0; i < MAX_STRING_COMMANDS; i++)
+    {
+        StringCommand command = _stringCommands[i];
+
+        if (command.Shortcut.length() > 0)
+        {
+            String padded = _padTo(command.Name, MAX_ARG1_SHORTCUT_COMMAND_LENGTH);
+            help += String("    ") + command.Shortcut + " | " + padded + " <text>    - " + command.Description + "\r\n";
+        }
+    }
+
     help += "\r\n";
 
     // Generate the help string for the available number commands (no shortcut).
@@ -515,9 +622,61 @@ String CommandsClass::getHelp()
         }
     }
 
+    help += "\r\n";
+
+    // Generate the help string for the available string commands (no shortcut).
+    for (int i = 0; i < MAX_STRING_COMMANDS; i++)
+    {
+        StringCommand command = _stringCommands[i];
+
+        if (command.Shortcut.length() == 0)
+        {
+            String padded = _padTo(command.Name, MAX_ARG1_COMMAND_LENGTH);
+            help += String("    ") + padded + " <text>    - " + command.Description + "\r\n";
+        }
+    }
+
     return help;
 }
 
+/// <summary>
+/// Registers the base command counters with the metrics registry (labelled by command name).
+/// </summary>
+void CommandsClass::addMetrics()
+{
+    for (int i = 0; i < MAX_BASE_COMMANDS; i++)
+    {
+        Metrics.add("yard_commands_total", "Number of executed commands.", MetricType::Counter,
+                    &_baseCounters[i], "command", _baseCommands[i].Name.c_str());
+    }
+}
+
+/// <summary>
+/// Registers a profiling site for every command (the commands with an argument in separate groups).
+/// </summary>
+void CommandsClass::addProfiles()
+{
+    for (int i = 0; i < MAX_BASE_COMMANDS; i++)
+    {
+        _baseSites[i] = Profiler.add("command", _baseCommands[i].Name.c_str());
+    }
+
+    for (int i = 0; i < MAX_LONG_COMMANDS; i++)
+    {
+        _longSites[i] = Profiler.add("command <number>", _longCommands[i].Name.c_str());
+    }
+
+    for (int i = 0; i < MAX_FLOAT_COMMANDS; i++)
+    {
+        _floatSites[i] = Profiler.add("command <number>", _floatCommands[i].Name.c_str());
+    }
+
+    for (int i = 0; i < MAX_STRING_COMMANDS; i++)
+    {
+        _stringSites[i] = Profiler.add("command <text>", _stringCommands[i].Name.c_str());
+    }
+}
+
 /// <summary>
 /// Helper function to check for a valid integer number.
 /// </summary>
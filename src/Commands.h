@@ -6,12 +6,15 @@
 //   Licensed under the MIT license. See the LICENSE file in the project root for more information.
 // </license>
 // <created>9-4-2023 7:45 PM</created>
-// <modified>20-5-2023 7:32 AM</modified>
+// <modified>18-10-2026 11:40 PM</modified>
 // <author>Peter Trimmel</author>
 // --------------------------------------------------------------------------------------------------------------------
 
 #pragma once
 
+#include "Metrics.h"
+#include "Profiler.h"
+
 #pragma region Command Callbacks
 
 void nop();                     // The NOP command (do nothing).
@@ -58,11 +61,21 @@ void minspeed();
 void maxspeed();
 void maxsteps();
 void microsteps();
+void benchmark();
+void axis();
+void matrix();
+void sequence();
+void tasks();
+void profile();
 
 void moveAway();
 void moveAbsolute(long value);
 void moveRelative(long value);
-void moveToTrack(long value);
+void axis(long value);
+
+void moveToTrack(String value);
+void sequence(String value);
+void profile(String value);
 
 void moveAbsoluteDistance(float value);
 void moveRelativeDistance(float value);
@@ -78,10 +91,11 @@ void microsteps(long value);
 
 #pragma endregion
 
-// The supported callbacks (void, long, and float).
+// The supported callbacks (void, long, float, and string).
 typedef void (*VoidCommandCallback)();
 typedef void (*LongCommandCallback)(long value);
 typedef void (*FloatCommandCallback)(float value);
+typedef void (*StringCommandCallback)(String value);
 
 /// <summary>
 /// Command supporting shortcuts, a description, and a callback function with no arguments.
@@ -148,18 +162,43 @@ public:
     FloatCommandCallback func = nullptr;
 };
 
+/// <summary>
+/// Command supporting shortcuts, a description, and a callback function with a single string argument (i.e. a name).
+/// </summary>
+class StringCommand
+{
+public:
+    StringCommand() {}
+    StringCommand(String name, String shortcut, String description, StringCommandCallback func = nullptr)
+    {
+        Name = name;
+        Shortcut = shortcut;
+        Description = description;
+        this->func = func;
+    }
+
+    String Text;
+    String Name = "";
+    String Shortcut = "";
+    String Description = "";
+    StringCommandCallback func = nullptr;
+};
+
 /// <summary>
 /// This class maintains lists of available commands.
 ///
 ///     init()     - Initializes the command list.
 ///     parse()    - Parses the input line and runs the command.
 ///     getHelp()  - Gets a printable help string on the available commands.
+///     addMetrics() - Registers the base command counters (metrics).
+///     addProfiles() - Registers the profiling sites of all commands (see ProfilerClass).
 ///
 /// The following command types are supported:
 ///
 ///     BaseCommand  - A command with an optional shortcut and no arguments.
 ///     LongCommand  - A command with an optional shortcut and a single long argument.
 ///     FloatCommand - A command with an optional shortcut and a single float argument.
+///     StringCommand - A command with an optional shortcut and a single string argument.
 ///
 /// </summary>
 class CommandsClass
@@ -167,9 +206,10 @@ class CommandsClass
 private:
     String _padTo(String str, const size_t num, const char paddingChar = ' ');
 
-    static const int MAX_BASE_COMMANDS = 39;
+    static const int MAX_BASE_COMMANDS = 45;
     static const int MAX_LONG_COMMANDS = 5;
     static const int MAX_FLOAT_COMMANDS = 7;
+    static const int MAX_STRING_COMMANDS = 3;
 
     static const int MAX_BASE_COMMAND_LENGTH = 12;
     static const int MAX_BASE_SHORTCUT_COMMAND_LENGTH = 9;
@@ -224,8 +264,17 @@ private:
         { "maxspeed",     "",  "Gets the maximum speed (steps per second).",   maxspeed     },  // 37
         { "maxsteps",     "",  "Gets the ramp steps to maximum speed.",        maxsteps     },  // 38
         { "microsteps",   "",  "Gets the microsteps settings.",                microsteps   },  // 39
+        { "benchmark",    "",  "Benchmarks the pulse output (cycles/edge).",   benchmark    },  // 40
+        { "axis",         "",  "Shows the selected axis and all axes.",        axis         },  // 41
+        { "matrix",       "",  "Shows the track move time matrix.",            matrix       },  // 42
+        { "sequence",     "",  "Shows the fastest sequence of all tracks.",    sequence     },  // 43
+        { "tasks",        "",  "Shows the task run-time statistics.",          tasks        },  // 44
+        { "profile",      "",  "Shows the profiled times (loop, commands).",   profile      },  // 45
     };
 
+    Counter _baseCounters[MAX_BASE_COMMANDS];           // The number of calls for every base command.
+    int _baseSites[MAX_BASE_COMMANDS] = {};             // The profiling site of every base command.
+
     int _findBaseCommandByShortcut(String shortcut);
     int _findBaseCommandByName(String name);
     void _processBaseCommand(int index);
@@ -236,12 +285,14 @@ private:
     LongCommand _longCommands[MAX_LONG_COMMANDS] = {
         { "stepto",     "m", "Moves to absolute position (steps).",   moveAbsolute },           // 1
         { "step",       "s", "Moves the number of steps (relative).", moveRelative },           // 2
-        { "track",      "t", "Moves to track number.",                moveToTrack  },           // 3
+        { "axis",       "",  "Selects the axis (0: actuator).",       axis         },           // 3
 
-        { "maxsteps",   "",  "Sets the ramp steps to maximum speed.", maxsteps     },           // 5
-        { "microsteps", "",  "Sets the microsteps.",                  microsteps   },           // 6
+        { "maxsteps",   "",  "Sets the ramp steps to maximum speed.", maxsteps     },           // 4
+        { "microsteps", "",  "Sets the microsteps.",                  microsteps   },           // 5
     };
 
+    int _longSites[MAX_LONG_COMMANDS] = {};             // The profiling site of every long command.
+
     int _findLongCommandByShortcut(String shortcut);    // Returns the command index (or -1 if not found).
     int _findLongCommandByName(String name);            // Returns the command index (or -1 if not found).
     void _processLongCommand(int index, String arg);    // Process the command at index using the argument.
@@ -261,18 +312,32 @@ private:
         { "maxspeed",     "",  "Sets the maximum speed (steps per second).",  maxspeed     },   // 7
     };
 
+    int _floatSites[MAX_FLOAT_COMMANDS] = {};           // The profiling site of every float command.
+
     int _findFloatCommandByShortcut(String shortcut);   // Returns the command index (or -1 if not found).
     int _findFloatCommandByName(String name);           // Returns the command index (or -1 if not found).
     void _processFloatCommand(int index, String arg);   // Process the command at index using the argument.
 
-    BaseCommand _lastCommand;                           // Last base command (used if waiting for response).
+    /// <summary>
+    /// The list of supported string commands (one string argument).
+    /// </summary>
+    StringCommand _stringCommands[MAX_STRING_COMMANDS] = {
+        { "track",      "t", "Moves to track (name or number).",      moveToTrack  },           // 1
+        { "sequence",   "",  "Shows the fastest track sequence.",     sequence     },           // 2
+        { "profile",    "",  "Shows the profiled times of a group.",  profile      },           // 3
+    };
 
-public:
-    bool JsonOutput = false;                            // Flag indicating JSON output.
-    bool WaitForResponse = false;                       // Flag indicating that a command response is expected.
+    int _stringSites[MAX_STRING_COMMANDS] = {};         // The profiling site of every string command.
+
+    int _findStringCommandByShortcut(String shortcut);  // Returns the command index (or -1 if not found).
+    int _findStringCommandByName(String name);          // Returns the command index (or -1 if not found).
+    void _processStringCommand(int index, String arg);  // Process the command at index using the argument.
 
+public:
     void parse(String command);                         // Parses the input line and runs the command.
     String getHelp();                                   // Gets a printable help string on the available commands.
+    void addMetrics();                                  // Registers the base command counters.
+    void addProfiles();                                 // Registers the profiling sites of all commands.
 
     bool isInteger(String number);                      // Returns true if the string is a valid integer number.
     bool isFloat(String number);                        // Returns true if the string is a valid float number.
@@ -280,4 +345,5 @@ public:
     inline bool isValidBaseCommand(String command)  { return _findBaseCommandByName (command) != -1; }
     inline bool isValidLongCommand(String command)  { return _findLongCommandByName (command) != -1; }
     inline bool isValidFloatCommand(String command) { return _findFloatCommandByName(command) != -1; }
+    inline bool isValidStringCommand(String command) { return _findStringCommandByName(command) != -1; }
 };
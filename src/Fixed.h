@@ -0,0 +1,144 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="Fixed.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 10:15 PM</created>
+// <modified>18-10-2026 10:15 PM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   A Q-format fixed-point value type with the unit checked at compile time.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+
+#include <type_traits>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#endif
+
+/// <summary>
+/// The unit tags (only used as template parameters).
+/// </summary>
+struct MillimetreUnit {};                           // Distance [mm].
+struct SpeedUnit {};                                // Speed [steps per second].
+struct RpmUnit {};                                  // Speed [rotations per minute].
+struct PercentUnit {};                              // Percentage [%].
+
+/// <summary>
+/// This class holds a fixed-point value with FRAC fractional bits (Q format) in a signed integer.
+/// Only values of the same unit can be added, subtracted and compared, so mixing i.e. millimetres and
+/// steps per second is a compile time error. Values can be multiplied and divided by plain integers,
+/// all other conversions (i.e. steps to millimetres) are done explicitly using integer arithmetic,
+/// as the RP2040 (Cortex M0+) has no floating point unit.
+///
+/// The conversion to a different number of fractional bits (same unit) is done using convert().
+/// The float conversions are only meant for the user input and the JSON output.
+/// </summary>
+template <typename Unit, int FRAC, typename Raw = int32_t>
+class Fixed
+{
+public:
+    using UnitType = Unit;
+    using RawType  = Raw;
+
+    static constexpr const int FRACTION = FRAC;                 // The number of fractional bits.
+    static constexpr const Raw ONE      = Raw(1) << FRAC;       // The raw value of 1.0.
+
+private:
+    Raw _raw = 0;                                   // The raw (scaled) value.
+
+public:
+    constexpr Fixed() = default;
+
+    static constexpr Fixed fromRaw(Raw raw)         // Creates a value from the raw (scaled) value.
+    {
+        Fixed value;
+        value._raw = raw;
+        return value;
+    }
+
+    static constexpr Fixed fromInt(long value)      // Creates a value from an integer.
+    {
+        return fromRaw(Raw(value) * ONE);
+    }
+
+    static constexpr Fixed fromFloat(float value)   // Creates a value from a float (rounded).
+    {
+        return fromRaw(Raw(value * float(ONE) + ((value < 0) ? -0.5f : 0.5f)));
+    }
+
+    template <typename To>
+    constexpr To convert() const                    // Converts to a different number of fractional bits (rounded).
+    {
+        static_assert(std::is_same<typename To::UnitType, Unit>::value, "Only values of the same unit can be converted.");
+
+        if constexpr (To::FRACTION >= FRAC)
+            return To::fromRaw(typename To::RawType(_raw) * (typename To::RawType(1) << (To::FRACTION - FRAC)));
+        else
+            return To::fromRaw(typename To::RawType((_raw + (Raw(1) << (FRAC - To::FRACTION - 1))) >> (FRAC - To::FRACTION)));
+    }
+
+    constexpr Raw   raw() const { return _raw; }
+    constexpr long  toInt() const { return long((_raw + (ONE >> 1)) >> FRAC); }
+    constexpr float toFloat() const { return float(_raw) / float(ONE); }
+
+#ifdef ARDUINO
+    String toString(uint8_t decimals = 2) const     // Formats the value using integer arithmetic (rounded).
+    {
+        uint64_t value = (_raw < 0) ? uint64_t(-int64_t(_raw)) : uint64_t(_raw);
+        uint64_t scale = 1;
+
+        for (uint8_t i = 0; i < decimals; i++) scale *= 10;
+
+        // Round to the number of decimals (the fraction may carry into the integer part).
+        uint64_t scaled   = (value * scale + (uint64_t(ONE) >> 1)) >> FRAC;
+        uint32_t integer  = uint32_t(scaled / scale);
+        uint32_t fraction = uint32_t(scaled % scale);
+
+        String text = ((_raw < 0) && (scaled > 0)) ? String("-") : String();
+        text += integer;
+
+        if (decimals > 0)
+        {
+            String digits(fraction);
+            text += '.';
+            for (uint8_t i = digits.length(); i < decimals; i++) text += '0';
+            text += digits;
+        }
+
+        return text;
+    }
+#endif
+
+    constexpr Fixed operator+(Fixed value) const { return fromRaw(_raw + value._raw); }
+    constexpr Fixed operator-(Fixed value) const { return fromRaw(_raw - value._raw); }
+    constexpr Fixed operator-() const { return fromRaw(-_raw); }
+    constexpr Fixed operator*(long value) const { return fromRaw(_raw * value); }
+    constexpr Fixed operator/(long value) const { return fromRaw(_raw / value); }
+
+    Fixed& operator+=(Fixed value) { _raw += value._raw; return *this; }
+    Fixed& operator-=(Fixed value) { _raw -= value._raw; return *this; }
+
+    constexpr bool operator==(Fixed value) const { return _raw == value._raw; }
+    constexpr bool operator!=(Fixed value) const { return _raw != value._raw; }
+    constexpr bool operator< (Fixed value) const { return _raw <  value._raw; }
+    constexpr bool operator<=(Fixed value) const { return _raw <= value._raw; }
+    constexpr bool operator> (Fixed value) const { return _raw >  value._raw; }
+    constexpr bool operator>=(Fixed value) const { return _raw >= value._raw; }
+};
+
+/// <summary>
+/// The fixed-point types used by the actuator.
+/// </summary>
+using Millimetres = Fixed<MillimetreUnit, 16>;      // Q16.16 distance (+/- 32767 mm, 0.000015 mm resolution).
+using StepSpeed   = Fixed<SpeedUnit, 8>;            // Q24.8 speed (up to 8388607 steps per second).
+using SpeedDelta  = Fixed<SpeedUnit, 24, int64_t>;  // Q40.24 speed delta per step (small ramp increments).
+using Rpm         = Fixed<RpmUnit, 16>;             // Q16.16 speed in rotations per minute.
+using Percent     = Fixed<PercentUnit, 16>;         // Q16.16 percentage.
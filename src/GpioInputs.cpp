@@ -6,84 +6,162 @@
 //   Licensed under the MIT license. See the LICENSE file in the project root for more information.
 // </license>
 // <created>17-4-2023 7:35 AM</created>
-// <modified>20-5-2023 7:25 AM</modified>
+// <modified>19-10-2026 2:40 AM</modified>
 // <author>Peter Trimmel</author>
 // --------------------------------------------------------------------------------------------------------------------
 #define ARDUINOTRACE_ENABLE 0
 
 #include <ArduinoTrace.h>
+#include <hardware/gpio.h>
+
 #include "AppSettings.h"
 #include "Actuator.h"
+#include "StepEngine.h"
+#include "Metrics.h"
 #include "GpioInputs.h"
 
 extern AppSettings Settings;
 extern LinearActuator Actuator;
+extern StepEngine Engine;
+extern MetricsClass Metrics;
+extern GpioInputs Inputs;
 
 #pragma region Input Callbacks
 
 /// <summary>
-/// Callback triggered when the stepper alarm output goes HIGH.
+/// GPIO interrupt callback (falling edge) for all safety inputs.
 /// </summary>
-/// <param name="pin">The input pin number.</param>
-void alarmOnCallback(uint8_t pin)
+/// <param name="param">The safety input.</param>
+static void edgeCallback(void* param)
 {
-    TRACE(); DUMP(pin);
-    Actuator.alarmOn(pin);
+    Inputs.onEdge(*static_cast<SafetyInput*>(param));
 }
 
+#pragma endregion
+
 /// <summary>
-/// Callback triggered when the stepper alarm output goes LOW.
+/// Sets up the input pins and attaches the GPIO interrupts. The inputs are active low (pulled up).
+/// The debounced state starts inactive, so an input already active at startup generates an on event.
 /// </summary>
-/// <param name="pin">The input pin number.</param>
-void alarmOffCallback(uint8_t pin)
+void GpioInputs::init()
 {
-    TRACE(); DUMP(pin);
-    Actuator.alarmOff(pin);
+    TRACE();
+
+    StepperAlarm.Pin = Settings.Stepper.PinALM;
+    SwitchStop.Pin   = Settings.Actuator.SwitchStop;
+    SwitchLimit1.Pin = Settings.Actuator.SwitchLimit1;
+    SwitchLimit2.Pin = Settings.Actuator.SwitchLimit2;
+
+    SafetyInput* inputs[] = { &StepperAlarm, &SwitchStop, &SwitchLimit1, &SwitchLimit2 };
+
+    for (SafetyInput* input : inputs)
+    {
+        pinMode(input->Pin, INPUT_PULLUP);
+        attachInterruptParam(digitalPinToInterrupt(input->Pin), edgeCallback, FALLING, input);
+    }
 }
 
 /// <summary>
-/// Callback triggered when the (debounced) switch is closed.
+/// GPIO interrupt (falling edge). If the input has been inactive, the pulse generation is stopped
+/// immediately (all axes, see StepEngine::halt). The GPIO and the step timer interrupts have the same priority and do not preempt
+/// each other, so no further pulse is started once halt() returns.
 /// </summary>
-/// <param name="pin">The input pin number.</param>
-void switchOnCallback(uint8_t pin)
+/// <param name="input">The safety input.</param>
+void GpioInputs::onEdge(SafetyInput& input)
 {
-    TRACE(); DUMP(pin);
-    Actuator.switchOn(pin);
+    uint32_t start = time_us_32();
+
+    if (input.Active || !Engine.halt(input.Pin))
+        return;
+
+    uint32_t latency = time_us_32() - start;
+
+    _stopLatency = latency;
+    if (latency > _maxStopLatency) _maxStopLatency = latency;
+    _stops = _stops + 1;
+
+    Metrics.StopLatency.observe(latency);
 }
 
 /// <summary>
-/// Callback triggered when the (debounced) switch is opened.
+/// Debounce timer callback. Samples all safety inputs.
 /// </summary>
-/// <param name="pin">The input pin number.</param>
-void switchOffCallback(uint8_t pin)
+/// <returns>True if an event has been flagged (the inputs task is signaled).</returns>
+bool GpioInputs::onTimer()
 {
-    TRACE(); DUMP(pin);
-    Actuator.switchOff(pin);
+    bool flagged = _sample(StepperAlarm);
+    flagged |= _sample(SwitchStop);
+    flagged |= _sample(SwitchLimit1);
+    flagged |= _sample(SwitchLimit2);
+
+    return flagged;
 }
 
-#pragma endregion
+/// <summary>
+/// Debounces a single input. A state change is accepted (and flagged) when the raw state has been
+/// different from the debounced state for DEBOUNCE consecutive ticks.
+/// </summary>
+/// <param name="input">The safety input.</param>
+/// <returns>True if a state change has been accepted.</returns>
+bool GpioInputs::_sample(SafetyInput& input)
+{
+    bool active = !gpio_get(input.Pin);
 
-void GpioInputs::init()
+    if (active == input.Active)
+    {
+        input.Stable = 0;
+        return false;
+    }
+
+    if (++input.Stable >= DEBOUNCE)
+    {
+        input.Stable = 0;
+        input.Active = active;
+
+        if (active) input.PendingOn = true;
+        else input.PendingOff = true;
+
+        return true;
+    }
+
+    return false;
+}
+
+/// <summary>
+/// Handles the pending events of a single input. A pending on event is handled before an off event.
+/// </summary>
+/// <param name="input">The safety input.</param>
+/// <param name="alarm">True for the stepper alarm input.</param>
+void GpioInputs::_handle(SafetyInput& input, bool alarm)
 {
-    TRACE();
+    if (input.PendingOn)
+    {
+        input.PendingOn = false;
+        TRACE(); DUMP(input.Pin);
 
-    StepperAlarm.setup(Settings.Stepper.PinALM);
-    SwitchStop.setup(Settings.Actuator.SwitchStop);
-    SwitchLimit1.setup(Settings.Actuator.SwitchLimit1);
-    SwitchLimit2.setup(Settings.Actuator.SwitchLimit2);
+        if (alarm) Actuator.alarmOn(input.Pin);
+        else Engine.switchOn(input.Pin);
+    }
 
-    StepperAlarm.registerCallbacks(alarmOnCallback, alarmOffCallback, NULL, NULL);
-    SwitchStop.registerCallbacks(switchOnCallback, switchOffCallback, NULL, NULL);
-    SwitchLimit1.registerCallbacks(switchOnCallback, switchOffCallback, NULL, NULL);
-    SwitchLimit2.registerCallbacks(switchOnCallback, switchOffCallback, NULL, NULL);
+    if (input.PendingOff)
+    {
+        input.PendingOff = false;
+        TRACE(); DUMP(input.Pin);
+
+        if (alarm) Actuator.alarmOff(input.Pin);
+        else Engine.switchOff(input.Pin);
+    }
 }
 
+/// <summary>
+/// Completes the moves stopped by an input interrupt (all axes) and handles the debounced events (main loop).
+/// </summary>
 void GpioInputs::run()
 {
-    unsigned long now = millis();
+    Engine.run();
 
-    StepperAlarm.process(now);
-    SwitchStop.process(now);
-    SwitchLimit1.process(now);
-    SwitchLimit2.process(now);
+    _handle(StepperAlarm, true);
+    _handle(SwitchStop, false);
+    _handle(SwitchLimit1, false);
+    _handle(SwitchLimit2, false);
 }
@@ -6,23 +6,67 @@
 //   Licensed under the MIT license. See the LICENSE file in the project root for more information.
 // </license>
 // <created>17-4-2023 7:33 AM</created>
-// <modified>17-4-2023 8:12 AM</modified>
+// <modified>19-10-2026 2:40 AM</modified>
 // <author>Peter Trimmel</author>
 // --------------------------------------------------------------------------------------------------------------------
 
 #pragma once
 
-#include <InputDebounce.h>
+#include <Arduino.h>
 
-class GpioInputs
+/// <summary>
+/// A single (active low) safety input: the stepper alarm, the emergency stop, or a limit switch.
+/// The fields are shared between the GPIO interrupt, the debounce timer and the main loop.
+/// </summary>
+struct SafetyInput
 {
- public:
-     InputDebounce StepperAlarm;                 // Stepper alarm input .
-     InputDebounce SwitchStop;                   // Emergency stop switch input.
-     InputDebounce SwitchLimit1;                 // Limit switch 1 (calibration).
-     InputDebounce SwitchLimit2;                 // Limit switch 2 (end of actuator).
-     
-     void init();
-     void run();
+    uint8_t Pin = 0;                                // The GPIO pin number.
+    volatile bool Active = false;                   // The debounced state (true if the input is active).
+    volatile bool PendingOn = false;                // Flag indicating a debounced on event (handled in the main loop).
+    volatile bool PendingOff = false;               // Flag indicating a debounced off event (handled in the main loop).
+    uint8_t Stable = 0;                             // The number of timer ticks the raw state differs from Active.
 };
 
+/// <summary>
+/// This class handles the safety inputs (stepper alarm, emergency stop and limit switches). The inputs are
+/// no longer polled from the main loop, as the loop may be blocked (i.e. handling a HTTP request):
+///
+///     GPIO interrupt  - The falling (active) edge stops the pulse generation immediately (LinearActuator::halt).
+///                       Only an inactive input stops, so the bouncing release of a switch does not stop
+///                       the retract move. The time to stop the pulses is measured (stop latency).
+///     Debounce timer  - The inputs are sampled every TICK microseconds. A state change is accepted once the
+///                       raw state has been stable for DEBOUNCE ticks, and an on or off event is flagged.
+///     run()           - The flagged events are handled in the main loop (retract, enable, calibration),
+///                       as the actuator move functions must not be called in an interrupt.
+///
+/// </summary>
+class GpioInputs
+{
+public:
+    static constexpr const uint32_t TICK     = 1000; // The debounce timer interval (microseconds).
+    static constexpr const uint8_t  DEBOUNCE = 20;   // The number of stable ticks to accept a state change (20 ms).
+
+private:
+    volatile uint32_t _stopLatency    = 0;          // The last stop latency (microseconds).
+    volatile uint32_t _maxStopLatency = 0;          // The maximum stop latency (microseconds).
+    volatile uint32_t _stops          = 0;          // The number of moves stopped by an input interrupt.
+
+    bool _sample(SafetyInput& input);               // Debounces a single input (timer context).
+    void _handle(SafetyInput& input, bool alarm);   // Handles the pending events of an input (main loop).
+
+public:
+    SafetyInput StepperAlarm;                       // Stepper alarm input .
+    SafetyInput SwitchStop;                         // Emergency stop switch input.
+    SafetyInput SwitchLimit1;                       // Limit switch 1 (calibration).
+    SafetyInput SwitchLimit2;                       // Limit switch 2 (end of actuator).
+
+    void init();                                    // Attaches the GPIO interrupts (the debounce timer is started in setup).
+    void run();                                     // Handles the debounced events (main loop).
+
+    void onEdge(SafetyInput& input);                // GPIO interrupt callback (active edge).
+    bool onTimer();                                 // Debounce timer callback (true if an event has been flagged).
+
+    inline uint32_t getStopLatency() const { return _stopLatency; }
+    inline uint32_t getMaxStopLatency() const { return _maxStopLatency; }
+    inline uint32_t getStops() const { return _stops; }
+};
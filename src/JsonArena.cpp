@@ -0,0 +1,114 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="JsonArena.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 5:10 PM</created>
+// <modified>18-10-2026 5:10 PM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include "JsonArena.h"
+
+/// <summary>
+/// The global JSON arena instance (see YardControl.ino).
+/// </summary>
+extern JsonArenaClass JsonArena;
+
+/// <summary>
+/// Returns the index of the block starting at the pointer.
+/// </summary>
+/// <param name="ptr">The block pointer.</param>
+/// <returns>The block index (or -1 if not found).</returns>
+int JsonArenaClass::_find(void* ptr)
+{
+    for (int i = _count - 1; i >= 0; i--)
+    {
+        if (&_buffer[_blocks[i].Offset] == ptr) return i;
+    }
+
+    return -1;
+}
+
+/// <summary>
+/// Allocates a block on top of the arena. The size is aligned to 8 bytes.
+/// </summary>
+/// <param name="size">The requested size (bytes).</param>
+/// <returns>The block pointer (or nullptr if the arena is exhausted).</returns>
+void* JsonArenaClass::allocate(size_t size)
+{
+    size = (size + 7) & ~7;
+
+    if ((_count >= MAX_BLOCKS) || (size > SIZE - _used))
+    {
+        _failures++;
+        return nullptr;
+    }
+
+    _blocks[_count++] = { _used, size, false };
+
+    void* ptr = &_buffer[_used];
+    _used += size;
+    _peak  = max(_peak, _used);
+
+    return ptr;
+}
+
+/// <summary>
+/// Releases a block. The memory is reclaimed if the block (and all blocks above) have been released.
+/// </summary>
+/// <param name="ptr">The block pointer (nullptr is ignored).</param>
+void JsonArenaClass::deallocate(void* ptr)
+{
+    int index = _find(ptr);
+
+    if (index < 0) return;
+
+    _blocks[index].Released = true;
+
+    while ((_count > 0) && _blocks[_count - 1].Released)
+    {
+        _used = _blocks[--_count].Offset;
+    }
+}
+
+/// <summary>
+/// Resizes a block. Only the last allocated block can be resized (i.e. BasicJsonDocument::shrinkToFit()).
+/// </summary>
+/// <param name="ptr">The block pointer.</param>
+/// <param name="size">The new size (bytes).</param>
+/// <returns>The block pointer (or nullptr if the block cannot be resized).</returns>
+void* JsonArenaClass::reallocate(void* ptr, size_t size)
+{
+    int index = _find(ptr);
+    size = (size + 7) & ~7;
+
+    if ((index < 0) || (index != _count - 1) || (size > SIZE - _blocks[index].Offset))
+    {
+        _failures++;
+        return nullptr;
+    }
+
+    _blocks[index].Size = size;
+    _used = _blocks[index].Offset + size;
+    _peak = max(_peak, _used);
+
+    return ptr;
+}
+
+void* JsonArenaAllocator::allocate(size_t size)
+{
+    return JsonArena.allocate(size);
+}
+
+void JsonArenaAllocator::deallocate(void* ptr)
+{
+    JsonArena.deallocate(ptr);
+}
+
+void* JsonArenaAllocator::reallocate(void* ptr, size_t size)
+{
+    return JsonArena.reallocate(ptr, size);
+}
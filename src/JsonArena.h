@@ -0,0 +1,83 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="JsonArena.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 5:10 PM</created>
+// <modified>18-10-2026 5:10 PM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   A shared scratch memory arena for JSON documents, borrowed for the duration of a request.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+#define ARDIUNOJSON_TAB "    "
+
+#include <ArduinoJson.h>
+
+/// <summary>
+/// This class provides a single fixed memory area used by all (short lived) JSON documents. Instead of a
+/// permanently resident StaticJsonDocument in every object, a JsonArenaDocument is created as a local
+/// variable, borrowing its memory pool from the arena, and returns the memory when it goes out of scope.
+/// As the documents are local variables, the memory is allocated and released in LIFO order (stack).
+/// Blocks released out of order are reclaimed as soon as the blocks above have been released.
+///
+/// If the arena is exhausted the allocation fails, and the document has no capacity (the output is empty).
+/// The high-water mark (peak) is reported in the system info and the metrics, to verify the arena size.
+///
+/// Note that the arena is not thread safe. It must be used from the main loop only (not in an ISR).
+/// </summary>
+class JsonArenaClass
+{
+public:
+    static const size_t SIZE       = 8192;          // The arena size (bytes, the settings document with a full track table).
+    static const int    MAX_BLOCKS = 8;             // The maximum number of blocks allocated at the same time.
+
+private:
+    struct Block
+    {
+        size_t Offset;                              // The block offset in the arena.
+        size_t Size;                                // The block size (aligned).
+        bool   Released;                            // Flag indicating that the block has been released.
+    };
+
+    alignas(8) uint8_t _buffer[SIZE];               // The arena memory.
+    Block    _blocks[MAX_BLOCKS];                   // The allocated blocks (stack).
+    int      _count    = 0;                         // The number of allocated blocks.
+    size_t   _used     = 0;                         // The number of bytes in use.
+    size_t   _peak     = 0;                         // The maximum number of bytes in use (high-water mark).
+    uint32_t _failures = 0;                         // The number of failed allocations.
+
+    int _find(void* ptr);                           // Returns the block index (or -1 if not found).
+
+public:
+    void* allocate(size_t size);                    // Allocates a block (or returns nullptr).
+    void  deallocate(void* ptr);                    // Releases a block.
+    void* reallocate(void* ptr, size_t size);       // Resizes the last allocated block.
+
+    inline size_t   getUsed() const { return _used; }
+    inline size_t   getPeak() const { return _peak; }
+    inline uint32_t getFailures() const { return _failures; }
+};
+
+/// <summary>
+/// The ArduinoJson allocator using the global arena (see BasicJsonDocument).
+/// </summary>
+struct JsonArenaAllocator
+{
+    void* allocate(size_t size);
+    void  deallocate(void* ptr);
+    void* reallocate(void* ptr, size_t size);
+};
+
+/// <summary>
+/// A JSON document using the shared arena. The capacity is allocated in the constructor and released
+/// in the destructor, so the document should be a local variable only.
+/// </summary>
+typedef BasicJsonDocument<JsonArenaAllocator> JsonArenaDocument;
@@ -0,0 +1,102 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="LineBuffer.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 10:05 AM</created>
+// <modified>18-10-2026 10:05 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   A fixed-size line buffer collecting printable characters until the end of a line.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+/// <summary>
+/// This class collects input characters into a fixed-size buffer (no heap allocation).
+/// Only printable characters are stored, a carriage return is ignored, and a line feed completes the line.
+/// If a line exceeds the buffer size the remaining characters are discarded until the end of the line,
+/// and the line is reported as overflow (the content is not dispatched).
+///
+///     add()       - Adds a character and returns the resulting state.
+///     get()       - Gets the (zero terminated) line.
+///     length()    - Gets the current line length.
+///     clear()     - Clears the line (and the overflow state).
+///
+/// </summary>
+class LineBuffer
+{
+public:
+    static const size_t SIZE = 128;                 // The maximum line length (characters).
+
+    enum State
+    {
+        PENDING,                                    // The character has been added (or ignored).
+        ERASED,                                     // The last character has been removed (backspace).
+        COMPLETE,                                   // A line has been completed.
+        TOO_LONG                                    // A line has been completed but exceeded the buffer size.
+    };
+
+private:
+    char   _buffer[SIZE + 1];                       // The line buffer (zero terminated).
+    size_t _length   = 0;                           // The current line length.
+    bool   _overflow = false;                       // Flag indicating that the current line is too long.
+
+public:
+    LineBuffer() { clear(); }
+
+    inline State add(char c)                        // Adds a character.
+    {
+        if (c == '\n')
+        {
+            if (_overflow)
+            {
+                clear();
+                return TOO_LONG;
+            }
+
+            return COMPLETE;
+        }
+
+        if ((c == 8) || (c == 127))
+        {
+            if (_length > 0)
+            {
+                _buffer[--_length] = '\0';
+                return ERASED;
+            }
+
+            return PENDING;
+        }
+
+        if ((c >= 32) && (c < 127))
+        {
+            if (_length < SIZE)
+            {
+                _buffer[_length++] = c;
+                _buffer[_length] = '\0';
+            }
+            else
+            {
+                _overflow = true;
+            }
+        }
+
+        return PENDING;
+    }
+
+    inline const char* get() const { return _buffer; }
+    inline size_t length() const { return _length; }
+
+    inline void clear()                             // Clears the line.
+    {
+        _length = 0;
+        _buffer[0] = '\0';
+        _overflow = false;
+    }
+};
@@ -0,0 +1,285 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="Metrics.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 9:12 AM</created>
+// <modified>18-10-2026 9:12 AM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+#include <WiFi.h>
+
+#include "Metrics.h"
+#include "JsonArena.h"
+#include "Wireless.h"
+
+/// <summary>
+/// The global JSON arena instance (see YardControl.ino).
+/// </summary>
+extern JsonArenaClass JsonArena;
+
+/// <summary>
+/// The global network instance (see YardControl.ino).
+/// </summary>
+extern Wireless Network;
+
+/// <summary>
+/// The bucket upper bounds (microseconds) for the step ISR execution time.
+/// </summary>
+static const uint32_t ISR_BUCKETS[] = { 1, 2, 3, 4, 5, 6, 8, 10 };
+
+/// <summary>
+/// The bucket upper bounds (microseconds) for the main loop iteration time.
+/// </summary>
+static const uint32_t LOOP_BUCKETS[] = { 50, 100, 250, 500, 1000, 2500, 5000, 10000, 50000, 100000 };
+
+/// <summary>
+/// The bucket upper bounds (microseconds) for the HTTP request latency.
+/// </summary>
+static const uint32_t HTTP_BUCKETS[] = { 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000 };
+
+/// <summary>
+/// Returns the value (microseconds) formatted in seconds.
+/// </summary>
+/// <param name="value">The value in microseconds.</param>
+/// <returns>The formatted value.</returns>
+static String seconds(uint64_t value)
+{
+    return String(double(value) / 1000000.0, 6);
+}
+
+/// <summary>
+/// Registers the firmware-wide metrics.
+/// </summary>
+void MetricsClass::init()
+{
+    StepIsrTime.init(ISR_BUCKETS, sizeof(ISR_BUCKETS) / sizeof(ISR_BUCKETS[0]));
+    LoopTime.init(LOOP_BUCKETS, sizeof(LOOP_BUCKETS) / sizeof(LOOP_BUCKETS[0]));
+    StopLatency.init(ISR_BUCKETS, sizeof(ISR_BUCKETS) / sizeof(ISR_BUCKETS[0]));
+
+    add("yard_moves_started_total",       "Number of moves started.",                         MetricType::Counter,   &MovesStarted);
+    add("yard_moves_completed_total",     "Number of moves completed.",                       MetricType::Counter,   &MovesCompleted);
+    add("yard_moves_aborted_total",       "Number of moves aborted.",                         MetricType::Counter,   &MovesAborted);
+    add("yard_steps_total",               "Number of stepper pulses generated.",              MetricType::Counter,   &Steps);
+    add("yard_step_isr_seconds",          "Step timer ISR execution time.",                   MetricType::Histogram, &StepIsrTime);
+    add("yard_step_isr_overruns_total",   "Number of step ISR calls exceeding the interval.", MetricType::Counter,   &StepIsrOverruns);
+    add("yard_stop_latency_seconds",      "Safety input interrupt to pulses stopped.",        MetricType::Histogram, &StopLatency);
+    add("yard_telnet_sessions_total",     "Number of telnet sessions.",                       MetricType::Counter,   &TelnetSessions);
+    add("yard_loop_seconds",              "Main loop iteration time.",                        MetricType::Histogram, &LoopTime);
+    add("yard_heap_free_bytes",           "Free heap.",                                       MetricType::Gauge,     &FreeHeap);
+    add("yard_heap_free_min_bytes",       "Minimum free heap observed.",                      MetricType::Gauge,     &MinFreeHeap);
+    add("yard_wifi_rssi_dbm",             "WiFi signal strength.",                            MetricType::Gauge,     &RSSI);
+    add("yard_wifi_link_losses_total",    "Number of WiFi link losses.",                      MetricType::Counter,   &WiFiLinkLosses);
+    add("yard_wifi_reconnects_total",     "Number of successful WiFi reconnects.",            MetricType::Counter,   &WiFiReconnects);
+    add("yard_wifi_downtime_seconds",     "Total WiFi downtime.",                             MetricType::Gauge,     &WiFiDowntime);
+    add("yard_board_temperature_celsius", "Board temperature.",                               MetricType::Gauge,     &BoardTemp);
+    add("yard_uptime_seconds",            "Time since boot.",                                 MetricType::Gauge,     &Uptime);
+    add("yard_boot_seconds",              "Time from power-on until setup completed.",        MetricType::Gauge,     &BootTime);
+    add("yard_json_arena_peak_bytes",     "Maximum JSON arena usage.",                        MetricType::Gauge,     &JsonArenaPeak);
+
+    MinFreeHeap.set(rp2040.getFreeHeap());
+}
+
+/// <summary>
+/// Registers a metric. Metrics sharing the same name are exported as a single family.
+/// </summary>
+/// <param name="name">The metric name.</param>
+/// <param name="help">The help text.</param>
+/// <param name="type">The metric type.</param>
+/// <param name="data">The Counter, Gauge or Histogram.</param>
+/// <param name="label">The label name (optional).</param>
+/// <param name="value">The label value (optional).</param>
+/// <returns>True if successful (false if the registry is full).</returns>
+bool MetricsClass::add(const char* name, const char* help, MetricType type, const void* data, const char* label, const char* value)
+{
+    if (_count >= MAX_METRICS)
+    {
+        return false;
+    }
+
+    _metrics[_count++] = { name, help, type, data, label, value };
+
+    return true;
+}
+
+/// <summary>
+/// Registers the request counter and the latency histogram for the HTTP route.
+/// </summary>
+/// <param name="uri">The route URI.</param>
+/// <returns>The route index (or -1 if no more routes are available).</returns>
+int MetricsClass::addRoute(const char* uri)
+{
+    if (_routes >= MAX_ROUTES)
+    {
+        return -1;
+    }
+
+    int route = _routes++;
+    _routeLatency[route].init(HTTP_BUCKETS, sizeof(HTTP_BUCKETS) / sizeof(HTTP_BUCKETS[0]));
+
+    add("yard_http_requests_total",  "Number of HTTP requests.", MetricType::Counter,   &_routeRequests[route], "route", uri);
+    add("yard_http_request_seconds", "HTTP request latency.",    MetricType::Histogram, &_routeLatency[route],  "route", uri);
+
+    return route;
+}
+
+/// <summary>
+/// Records a request for the HTTP route.
+/// </summary>
+/// <param name="route">The route index.</param>
+/// <param name="micros">The request latency (microseconds).</param>
+void MetricsClass::observeRoute(int route, uint32_t micros)
+{
+    if ((route >= 0) && (route < _routes))
+    {
+        _routeRequests[route].inc();
+        _routeLatency[route].observe(micros);
+    }
+}
+
+/// <summary>
+/// Samples the free heap to maintain the minimum free heap. Called from the main loop.
+/// </summary>
+void MetricsClass::run()
+{
+    unsigned long now = millis();
+
+    if (now - _lastSample >= SAMPLE_INTERVAL)
+    {
+        _lastSample = now;
+
+        float heap = rp2040.getFreeHeap();
+        FreeHeap.set(heap);
+
+        if (heap < MinFreeHeap.get()) MinFreeHeap.set(heap);
+    }
+}
+
+/// <summary>
+/// Updates the gauges before the metrics are exported.
+/// </summary>
+void MetricsClass::collect()
+{
+    _lastSample = 0;
+    run();
+
+    RSSI.set(Network.getRSSI());
+    WiFiDowntime.set(Network.getDowntime() / 1000.0f);
+    BoardTemp.set(analogReadTemp());
+    Uptime.set(millis() / 1000.0f);
+    JsonArenaPeak.set(JsonArena.getPeak());
+}
+
+/// <summary>
+/// Returns the label set of the metric (including an optional extra label).
+/// </summary>
+/// <param name="metric">The metric.</param>
+/// <param name="extra">The extra label (i.e. le="0.5").</param>
+/// <returns>The label set (or an empty string if there are no labels).</returns>
+String MetricsClass::_labels(const Metric& metric, const String& extra)
+{
+    String labels;
+
+    if (metric.Label != nullptr)
+    {
+        labels = String(metric.Label) + "=\"" + metric.Value + "\"";
+    }
+
+    if (extra.length() > 0)
+    {
+        if (labels.length() > 0) labels += ",";
+        labels += extra;
+    }
+
+    return (labels.length() > 0) ? String("{") + labels + "}" : labels;
+}
+
+/// <summary>
+/// Returns a single sample line.
+/// </summary>
+String MetricsClass::_format(const Metric& metric, const char* suffix, const String& labels, const String& value)
+{
+    return String(metric.Name) + suffix + labels + " " + value + "\n";
+}
+
+/// <summary>
+/// Returns the sample lines of the metric.
+/// </summary>
+/// <param name="metric">The metric.</param>
+/// <returns>The sample lines.</returns>
+String MetricsClass::_toString(const Metric& metric)
+{
+    switch (metric.Type)
+    {
+    case MetricType::Counter:
+        return _format(metric, "", _labels(metric), String(((const Counter*)metric.Data)->get()));
+
+    case MetricType::Gauge:
+        return _format(metric, "", _labels(metric), String(((const Gauge*)metric.Data)->get(), 2));
+
+    case MetricType::Histogram:
+    {
+        const Histogram* histogram = (const Histogram*)metric.Data;
+        uint32_t cumulative = 0;
+        String result;
+
+        for (uint8_t i = 0; i < histogram->getSize(); i++)
+        {
+            cumulative += histogram->getBucket(i);
+            String le = String("le=\"") + seconds(histogram->getBound(i)) + "\"";
+            result += _format(metric, "_bucket", _labels(metric, le), String(cumulative));
+        }
+
+        cumulative += histogram->getBucket(histogram->getSize());
+        result += _format(metric, "_bucket", _labels(metric, "le=\"+Inf\""), String(cumulative));
+        result += _format(metric, "_sum",   _labels(metric), seconds(histogram->getSum()));
+        result += _format(metric, "_count", _labels(metric), String(histogram->getCount()));
+
+        return result;
+    }
+
+    default:
+        return String();
+    }
+}
+
+/// <summary>
+/// Writes the Prometheus text representation. The writer is called for every family header and every
+/// metric, so the complete export never has to be held in memory.
+/// </summary>
+/// <param name="writer">The function writing a chunk.</param>
+void MetricsClass::write(Writer writer)
+{
+    for (int i = 0; i < _count; i++)
+    {
+        const Metric& metric = _metrics[i];
+        bool first = true;
+
+        // Skip the metric if the family has already been written.
+        for (int j = 0; j < i; j++)
+        {
+            if (strcmp(_metrics[j].Name, metric.Name) == 0)
+            {
+                first = false;
+                break;
+            }
+        }
+
+        if (!first) continue;
+
+        String type = (metric.Type == MetricType::Counter) ? "counter" : (metric.Type == MetricType::Gauge) ? "gauge" : "histogram";
+
+        writer(String("# HELP ") + metric.Name + " " + metric.Help + "\n" +
+                      "# TYPE " + metric.Name + " " + type + "\n");
+
+        for (int j = i; j < _count; j++)
+        {
+            if (strcmp(_metrics[j].Name, metric.Name) == 0)
+            {
+                writer(_toString(_metrics[j]));
+            }
+        }
+    }
+}
@@ -0,0 +1,207 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="Metrics.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 9:12 AM</created>
+// <modified>18-10-2026 9:12 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   A small fixed-size metrics registry providing counters, gauges and histograms.
+//   The registered metrics are exported in the Prometheus text format (version 0.0.4).
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/sync.h>
+
+#include <atomic>
+#include <functional>
+
+/// <summary>
+/// A monotonically increasing counter. A counter is incremented from a single context only (either an ISR
+/// or the main loop). As the Cortex-M0+ has no atomic read-modify-write instructions the increment is a
+/// relaxed load and store, which is lock-free and cheap enough for the step ISR.
+/// </summary>
+class Counter
+{
+private:
+    std::atomic<uint32_t> _value { 0 };             // The counter value.
+
+public:
+    inline void inc(uint32_t n = 1)                 // Increments the counter.
+    {
+        _value.store(_value.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    inline uint32_t get() const                     // Gets the counter value.
+    {
+        return _value.load(std::memory_order_relaxed);
+    }
+};
+
+/// <summary>
+/// A gauge holding the last value set. Gauges are set from the main loop only.
+/// </summary>
+class Gauge
+{
+private:
+    volatile float _value = 0.0f;                   // The gauge value.
+
+public:
+    inline void set(float value) { _value = value; }
+    inline float get() const { return _value; }
+};
+
+/// <summary>
+/// A histogram with fixed bucket upper bounds (microseconds). Like a counter a histogram is updated from
+/// a single context only. The observed values are exported in seconds. The 64 bit sum is not written
+/// atomically on the Cortex-M0+ (two stores), so it is read with the interrupts disabled.
+/// </summary>
+class Histogram
+{
+public:
+    static const int MAX_BUCKETS = 10;              // The maximum number of buckets (without +Inf).
+
+private:
+    const uint32_t* _bounds = nullptr;              // The bucket upper bounds (microseconds).
+    uint8_t _size = 0;                              // The number of buckets used.
+    Counter _buckets[MAX_BUCKETS + 1];              // The (non-cumulative) bucket counts, the last bucket is +Inf.
+    Counter _count;                                 // The number of observations.
+    volatile uint64_t _sum = 0;                     // The sum of all observed values (microseconds).
+    volatile uint32_t _max = 0;                     // The maximum observed value (microseconds).
+
+public:
+    Histogram() {}
+    Histogram(const uint32_t* bounds, uint8_t size) { init(bounds, size); }
+
+    void init(const uint32_t* bounds, uint8_t size) // Sets the bucket upper bounds.
+    {
+        _bounds = bounds;
+        _size = min(size, (uint8_t)MAX_BUCKETS);
+    }
+
+    inline void observe(uint32_t value)             // Adds an observation (microseconds).
+    {
+        uint8_t i = 0;
+
+        while ((i < _size) && (value > _bounds[i]))
+            ++i;
+
+        _buckets[i].inc();
+        _count.inc();
+        _sum = _sum + value;
+
+        if (value > _max) _max = value;
+    }
+
+    inline uint8_t  getSize() const { return _size; }
+    inline uint32_t getBound(uint8_t i) const { return _bounds[i]; }
+    inline uint32_t getBucket(uint8_t i) const { return _buckets[i].get(); }
+    inline uint32_t getCount() const { return _count.get(); }
+    inline uint32_t getMax() const { return _max; }
+
+    inline uint64_t getSum() const                  // Gets the sum (not torn by an update in an ISR).
+    {
+        uint32_t state = save_and_disable_interrupts();
+        uint64_t sum = _sum;
+        restore_interrupts(state);
+
+        return sum;
+    }
+};
+
+/// <summary>
+/// The metric types supported by the registry.
+/// </summary>
+enum class MetricType : uint8_t
+{
+    Counter,
+    Gauge,
+    Histogram
+};
+
+/// <summary>
+/// A registry entry. Entries sharing the same name form a metric family and are distinguished by a label.
+/// </summary>
+struct Metric
+{
+    const char* Name;                               // The metric (family) name.
+    const char* Help;                               // The help text.
+    MetricType  Type;                               // The metric type.
+    const void* Data;                               // Points to the Counter, Gauge or Histogram.
+    const char* Label;                              // The label name (nullptr if not labelled).
+    const char* Value;                              // The label value.
+};
+
+/// <summary>
+/// This class holds the firmware-wide metrics and a fixed-size registry used for the export.
+///
+///     init()          - Registers the firmware-wide metrics.
+///     add()           - Registers a metric (returns false if the registry is full).
+///     addRoute()      - Registers the request counter and latency histogram for an HTTP route.
+///     observeRoute()  - Records a request for an HTTP route.
+///     run()           - Samples the heap (called from the main loop).
+///     collect()       - Updates the gauges before an export.
+///     write()         - Writes the Prometheus text representation (in chunks).
+///
+/// </summary>
+class MetricsClass
+{
+public:
+    static const int MAX_METRICS = 192;             // The maximum number of registry entries.
+    static const int MAX_ROUTES  = 48;              // The maximum number of HTTP routes.
+    static const int SAMPLE_INTERVAL = 100;         // The heap sampling interval (ms).
+
+    typedef std::function<void(const String&)> Writer;
+
+private:
+    Metric   _metrics[MAX_METRICS];                 // The registered metrics.
+    int      _count = 0;                            // The number of registered metrics.
+
+    Counter   _routeRequests[MAX_ROUTES];           // The request count per HTTP route.
+    Histogram _routeLatency[MAX_ROUTES];            // The request latency per HTTP route.
+    int       _routes = 0;                          // The number of registered HTTP routes.
+
+    unsigned long _lastSample = 0;                  // Time of the last heap sample (millis).
+
+    String _format(const Metric& metric, const char* suffix, const String& labels, const String& value);
+    String _labels(const Metric& metric, const String& extra = String());
+    String _toString(const Metric& metric);
+
+public:
+    Counter   MovesStarted;                         // The number of moves started.
+    Counter   MovesCompleted;                       // The number of moves completed (target reached).
+    Counter   MovesAborted;                         // The number of moves aborted (stop, disable).
+    Counter   Steps;                                // The total number of steps.
+    Histogram StepIsrTime;                          // The step timer ISR execution time.
+    Counter   StepIsrOverruns;                      // The number of step ISR calls exceeding the timer interval.
+    Histogram StopLatency;                          // The time from a safety input interrupt until the pulses stopped.
+    Counter   TelnetSessions;                       // The number of telnet sessions.
+    Histogram LoopTime;                             // The main loop iteration time.
+    Gauge     FreeHeap;                             // The free heap (bytes).
+    Gauge     MinFreeHeap;                          // The minimum free heap observed (bytes).
+    Gauge     RSSI;                                 // The WiFi signal strength (dBm).
+    Counter   WiFiLinkLosses;                       // The number of WiFi link losses.
+    Counter   WiFiReconnects;                       // The number of successful WiFi reconnects.
+    Gauge     WiFiDowntime;                         // The total WiFi downtime (seconds).
+    Gauge     BoardTemp;                            // The board temperature (°C).
+    Gauge     Uptime;                               // The time since boot (seconds).
+    Gauge     BootTime;                             // The time from power-on until setup completed (seconds).
+    Gauge     JsonArenaPeak;                        // The maximum JSON arena usage (bytes).
+
+    void init();
+    bool add(const char* name, const char* help, MetricType type, const void* data,
+             const char* label = nullptr, const char* value = nullptr);
+
+    int  addRoute(const char* uri);
+    void observeRoute(int route, uint32_t micros);
+
+    void run();
+    void collect();
+    void write(Writer writer);
+};
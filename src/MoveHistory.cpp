@@ -0,0 +1,249 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="MoveHistory.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 12:20 AM</created>
+// <modified>19-10-2026 12:20 AM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+#include <LittleFS.h>
+
+#include "MoveHistory.h"
+#include "Fixed.h"
+
+static_assert(sizeof(MoveHistory::Record) == 36, "The move record size is part of the file format.");
+
+/// <summary>
+/// Reads the sequence number of the last (complete) record in the log file.
+/// </summary>
+/// <param name="path">The log file path.</param>
+/// <returns>The sequence number (0 if the file does not exist or is empty).</returns>
+uint32_t MoveHistory::_getLastSequence(const char* path)
+{
+    Record record;
+
+    File file = LittleFS.open(path, "r");
+
+    if (!file)
+    {
+        return 0;
+    }
+
+    size_t count = file.size() / sizeof(Record);
+
+    bool ok = (count > 0) &&
+              file.seek((count - 1) * sizeof(Record)) &&
+              (file.read(reinterpret_cast<uint8_t*>(&record), sizeof(record)) == sizeof(record));
+    file.close();
+
+    return ok ? record.Sequence : 0;
+}
+
+/// <summary>
+/// Formats a record as a CSV line or a JSON object (preceded by a comma if not the first record).
+/// </summary>
+/// <param name="record">The record.</param>
+/// <param name="csv">True for CSV, false for JSON.</param>
+/// <param name="first">True for the first record (JSON).</param>
+/// <returns>The formatted record.</returns>
+String MoveHistory::_toString(const Record& record, bool csv, bool first)
+{
+    String speed = StepSpeed::fromRaw(record.PeakSpeed).toString();
+
+    if (csv)
+    {
+        return String(record.Sequence) + "," + record.Time + "," + record.Axis + "," +
+                      record.Start + "," + record.End + "," + record.Target + "," + record.Steps + "," +
+                      record.Elapsed + "," + speed + "," + getOutcomeName(record.Outcome) + "\r\n";
+    }
+
+    return String(first ? "\n" : ",\n") +
+                  "  {\"Sequence\":" + record.Sequence + ",\"Time\":" + record.Time + ",\"Axis\":" + record.Axis +
+                  ",\"Start\":" + record.Start + ",\"End\":" + record.End + ",\"Target\":" + record.Target +
+                  ",\"Steps\":" + record.Steps + ",\"Elapsed\":" + record.Elapsed + ",\"PeakSpeed\":" + speed +
+                  ",\"Outcome\":\"" + getOutcomeName(record.Outcome) + "\"}";
+}
+
+/// <summary>
+/// Streams the records of the log file with a sequence number greater than since. The file is read
+/// in chunks (CHUNK records), every chunk is written as a single string.
+/// </summary>
+/// <param name="path">The log file path.</param>
+/// <param name="since">The sequence number of the last record received.</param>
+/// <param name="csv">True for CSV, false for JSON.</param>
+/// <param name="first">True if no record has been written yet (updated).</param>
+/// <param name="writer">The writer (called for every chunk).</param>
+void MoveHistory::_writeFile(const char* path, uint32_t since, bool csv, bool& first, Writer writer)
+{
+    Record records[CHUNK];
+
+    File file = LittleFS.open(path, "r");
+
+    if (!file)
+    {
+        return;
+    }
+
+    while (true)
+    {
+        size_t count = file.read(reinterpret_cast<uint8_t*>(records), sizeof(records)) / sizeof(Record);
+
+        if (count == 0) break;
+
+        String text;
+
+        for (size_t i = 0; i < count; i++)
+        {
+            if (int32_t(records[i].Sequence - since) <= 0) continue;
+
+            text += _toString(records[i], csv, first);
+            first = false;
+        }
+
+        if (text.length() > 0) writer(text);
+    }
+
+    file.close();
+}
+
+/// <summary>
+/// Reads the last sequence number from the log files, so the sequence is continued after a reboot.
+/// </summary>
+/// <returns>True if a record has been found.</returns>
+bool MoveHistory::begin()
+{
+    _count = 0;
+    _sequence = _getLastSequence(HISTORY_FILE);
+
+    if (_sequence == 0)
+    {
+        _sequence = _getLastSequence(HISTORY_OLD_FILE);
+    }
+
+    return _sequence > 0;
+}
+
+/// <summary>
+/// Buffers a record and assigns the sequence number. If the buffer is full, the oldest record is dropped
+/// (the buffer is written in run() when no axis is running). This is called from the main loop.
+/// </summary>
+/// <param name="record">The record (the sequence number is updated).</param>
+void MoveHistory::add(Record& record)
+{
+    record.Sequence = ++_sequence;
+
+    if (_count == CAPACITY)
+    {
+        memmove(&_pending[0], &_pending[1], (CAPACITY - 1) * sizeof(Record));
+        _count--;
+        _dropped++;
+    }
+
+    if (_count == 0) _since = millis();
+
+    _pending[_count++] = record;
+}
+
+/// <summary>
+/// Writes the buffered records if a batch is complete or the oldest record is older than FLUSH_DELAY.
+/// This is called from the main loop.
+/// </summary>
+/// <param name="idle">True if no axis is running (a flash write stalls the interrupts).</param>
+void MoveHistory::run(bool idle)
+{
+    if (idle && (_count > 0) && ((_count >= BATCH) || (millis() - _since >= FLUSH_DELAY)))
+    {
+        flush();
+    }
+}
+
+/// <summary>
+/// Appends all buffered records to the log file. If the log file would exceed MAX_RECORDS,
+/// it is renamed (replacing the old log file) and a new log file is started.
+/// </summary>
+/// <returns>True if successful.</returns>
+bool MoveHistory::flush()
+{
+    if (_count == 0)
+    {
+        return true;
+    }
+
+    File file = LittleFS.open(HISTORY_FILE, "a");
+
+    if (file && (file.size() + _count * sizeof(Record) > MAX_RECORDS * sizeof(Record)))
+    {
+        file.close();
+        LittleFS.remove(HISTORY_OLD_FILE);
+        LittleFS.rename(HISTORY_FILE, HISTORY_OLD_FILE);
+        file = LittleFS.open(HISTORY_FILE, "a");
+    }
+
+    if (!file)
+    {
+        return false;
+    }
+
+    size_t size = file.write(reinterpret_cast<const uint8_t*>(_pending), _count * sizeof(Record));
+    file.close();
+
+    if (size != _count * sizeof(Record))
+    {
+        return false;
+    }
+
+    _count = 0;
+    _writes++;
+
+    return true;
+}
+
+/// <summary>
+/// Streams the records with a sequence number greater than since (old log file, log file, and the
+/// buffered records). The CSV output starts with a header line, the JSON output is an array of objects.
+/// </summary>
+/// <param name="since">The sequence number of the last record received (0: all records).</param>
+/// <param name="csv">True for CSV, false for JSON.</param>
+/// <param name="writer">The writer (called for every chunk).</param>
+void MoveHistory::write(uint32_t since, bool csv, Writer writer)
+{
+    bool first = true;
+
+    writer(csv ? "Sequence,Time,Axis,Start,End,Target,Steps,Elapsed,PeakSpeed,Outcome\r\n" : "[");
+
+    _writeFile(HISTORY_OLD_FILE, since, csv, first, writer);
+    _writeFile(HISTORY_FILE, since, csv, first, writer);
+
+    String text;
+
+    for (size_t i = 0; i < _count; i++)
+    {
+        if (int32_t(_pending[i].Sequence - since) <= 0) continue;
+
+        text += _toString(_pending[i], csv, first);
+        first = false;
+    }
+
+    if (text.length() > 0) writer(text);
+    if (!csv) writer("\n]\n");
+}
+
+/// <summary>
+/// Gets the outcome name.
+/// </summary>
+/// <param name="outcome">The outcome.</param>
+/// <returns>The outcome name.</returns>
+const char* MoveHistory::getOutcomeName(uint8_t outcome)
+{
+    switch (outcome)
+    {
+    case OUTCOME_COMPLETED: return "Completed";
+    case OUTCOME_STOPPED:   return "Stopped";
+    case OUTCOME_LIMIT:     return "Limit";
+    case OUTCOME_ALARM:     return "Alarm";
+    default:                return "Unknown";
+    }
+}
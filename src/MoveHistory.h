@@ -0,0 +1,99 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="MoveHistory.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 12:20 AM</created>
+// <modified>19-10-2026 12:20 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   A rotating binary log of move records in flash (move history).
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+#define HISTORY_FILE     "history.bin"
+#define HISTORY_OLD_FILE "history.old"
+
+/// <summary>
+/// This class records every move in a binary log of fixed size records ('history.bin'). When the log is full
+/// it is renamed ('history.old', replacing the previous one) and a new log is started, so the history is
+/// bounded to two files (2 * MAX_RECORDS records).
+///
+/// The records are buffered in RAM and written in batches (at least BATCH records, or after FLUSH_DELAY).
+/// As a flash write stalls the interrupts (step timing), a batch is only written while no axis is running.
+/// If the buffer is full while moving, the oldest buffered record is dropped.
+///
+/// Every record holds a sequence number (incremented for every move, continued after a reboot), so a client
+/// can request the records since the last one received. The records are streamed (in chunks) as CSV or JSON
+/// without reading the files into RAM.
+/// </summary>
+class MoveHistory
+{
+public:
+    static const size_t        MAX_RECORDS = 512;   // The number of records in a log file.
+    static const size_t        CAPACITY    = 16;    // The number of records buffered in RAM.
+    static const size_t        BATCH       = 8;     // The number of records written in a batch.
+    static const size_t        CHUNK       = 16;    // The number of records read (and sent) in a chunk.
+    static const unsigned long FLUSH_DELAY = 10000; // The time (ms) until a partial batch is written.
+
+    enum Outcome : uint8_t
+    {
+        OUTCOME_COMPLETED,                          // The target has been reached.
+        OUTCOME_STOPPED,                            // Stopped (stop command, stop switch, or disabled).
+        OUTCOME_LIMIT,                              // Halted by a limit switch.
+        OUTCOME_ALARM                               // Aborted by the stepper driver alarm.
+    };
+
+    /// <summary>
+    /// A single move record (as written to flash).
+    /// </summary>
+    struct Record
+    {
+        uint32_t Sequence  = 0;                     // The sequence number (assigned when added).
+        uint32_t Time      = 0;                     // The time at the start of the move (UTC seconds).
+        int32_t  Start     = 0;                     // The start position (steps).
+        int32_t  End       = 0;                     // The end position (steps).
+        int32_t  Target    = 0;                     // The target position (steps).
+        int32_t  Steps     = 0;                     // The number of steps requested.
+        uint32_t Elapsed   = 0;                     // The elapsed time (microseconds).
+        int32_t  PeakSpeed = 0;                     // The peak speed (raw StepSpeed value, steps per second).
+        uint8_t  Outcome   = OUTCOME_COMPLETED;     // The outcome of the move.
+        uint8_t  Axis      = 0;                     // The axis index.
+        uint16_t Reserved  = 0;                     // Padding (zero).
+    };
+
+    typedef std::function<void(const String&)> Writer;
+
+private:
+    Record        _pending[CAPACITY];               // The buffered records (not yet written).
+    size_t        _count    = 0;                    // The number of buffered records.
+    unsigned long _since    = 0;                    // The time the oldest buffered record has been added (millis).
+    uint32_t      _sequence = 0;                    // The last sequence number assigned.
+    uint32_t      _writes   = 0;                    // The number of batches written since boot.
+    uint32_t      _dropped  = 0;                    // The number of records dropped (buffer full).
+
+    static uint32_t _getLastSequence(const char* path);    // Reads the sequence number of the last record.
+    static String   _toString(const Record& record, bool csv, bool first); // Formats a record (CSV or JSON).
+    static void     _writeFile(const char* path, uint32_t since, bool csv, bool& first, Writer writer); // Streams a log file.
+
+public:
+    bool begin();                                   // Reads the last sequence number from the log files.
+    void add(Record& record);                       // Buffers a record (assigning the sequence number).
+    void run(bool idle);                            // Writes a batch if due (main loop, idle: no axis running).
+    bool flush();                                   // Writes all buffered records (rotating the log).
+    void write(uint32_t since, bool csv, Writer writer); // Streams the records after the sequence number.
+
+    static const char* getOutcomeName(uint8_t outcome); // Gets the outcome name.
+
+    inline uint32_t getSequence() const { return _sequence; }
+    inline size_t   getPending() const { return _count; }
+    inline uint32_t getWrites() const { return _writes; }
+    inline uint32_t getDropped() const { return _dropped; }
+};
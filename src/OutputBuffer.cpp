@@ -0,0 +1,296 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="OutputBuffer.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 1:40 PM</created>
+// <modified>19-10-2026 5:10 AM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include "OutputBuffer.h"
+
+/// <summary>
+/// The marker appended when output has been truncated.
+/// </summary>
+static const char TRUNCATED[] = "\r\n[output truncated]\r\n";
+
+/// <summary>
+/// Copies the data into the ring buffer. The caller ensures that the data fits.
+/// </summary>
+/// <param name="data">The data.</param>
+/// <param name="size">The number of bytes.</param>
+void OutputBuffer::_put(const uint8_t* data, size_t size)
+{
+    while (size > 0)
+    {
+        size_t chunk = min(size, SIZE - _head);
+        memcpy(&_buffer[_head], data, chunk);
+
+        _head   = (_head + chunk) % SIZE;
+        _count += chunk;
+        data   += chunk;
+        size   -= chunk;
+    }
+}
+
+/// <summary>
+/// Discards the oldest bytes.
+/// </summary>
+/// <param name="size">The number of bytes.</param>
+void OutputBuffer::_discard(size_t size)
+{
+    size = min(size, _count);
+
+    _tail     = (_tail + size) % SIZE;
+    _count   -= size;
+    _dropped += size;
+}
+
+/// <summary>
+/// Adds the data to the buffer. If the buffer is full the data is dropped according to the policy.
+/// </summary>
+/// <param name="data">The data.</param>
+/// <param name="size">The number of bytes.</param>
+void OutputBuffer::_add(const uint8_t* data, size_t size)
+{
+    // Drop everything until the truncated output has been drained.
+    if (_truncated)
+    {
+        _dropped += size;
+        return;
+    }
+
+    size_t room = SIZE - _count;
+
+    if (size <= room)
+    {
+        _put(data, size);
+    }
+    else if (_policy == DROP_OLDEST)
+    {
+        // Only the last SIZE bytes can be kept.
+        if (size > SIZE)
+        {
+            _dropped += size - SIZE;
+            data     += size - SIZE;
+            size      = SIZE;
+        }
+
+        _discard(size - (SIZE - _count));
+        _put(data, size);
+    }
+    else
+    {
+        // Keep what fits (leaving room for the marker) and mark the truncation.
+        size_t marker = sizeof(TRUNCATED) - 1;
+        size_t keep   = (room > marker) ? room - marker : 0;
+
+        _put(data, keep);
+        _put((const uint8_t*)TRUNCATED, min(marker, SIZE - _count));
+
+        _dropped  += size - keep;
+        _truncated = true;
+    }
+}
+
+/// <summary>
+/// Holds the data written while paging (at most SIZE bytes). If more is written the data is dropped
+/// according to the policy.
+/// </summary>
+/// <param name="data">The data.</param>
+/// <param name="size">The number of bytes.</param>
+void OutputBuffer::_hold(const uint8_t* data, size_t size)
+{
+    size_t room = (_held.length() < SIZE) ? SIZE - _held.length() : 0;
+
+    if (size > room)
+    {
+        if (_policy == DROP_OLDEST)
+        {
+            size_t remove = min(size - room, (size_t)_held.length());
+
+            _held.remove(0, remove);
+            _dropped += remove;
+            room += remove;
+        }
+
+        if (size > room)
+        {
+            _dropped += size - room;
+
+            if (_policy == DROP_OLDEST) data += size - room;
+
+            size = room;
+        }
+    }
+
+    _held.concat((const char*)data, size);
+}
+
+/// <summary>
+/// Fills the buffer from the paged output: the current chunk is copied as far as it fits, and the source
+/// is asked for the next chunk. When the source is done, the output held while paging follows.
+/// </summary>
+void OutputBuffer::_fill()
+{
+    while (_count < SIZE)
+    {
+        if (_offset < _chunk.length())
+        {
+            size_t size = min((size_t)_chunk.length() - _offset, SIZE - _count);
+
+            _put((const uint8_t*)_chunk.c_str() + _offset, size);
+            _offset += size;
+            continue;
+        }
+
+        _chunk  = "";
+        _offset = 0;
+
+        if (_source && _source(_chunk))
+        {
+            continue;
+        }
+
+        _source = nullptr;
+
+        if (_held.length() == 0)
+        {
+            break;
+        }
+
+        _chunk = _held;
+        _held  = "";
+    }
+}
+
+/// <summary>
+/// Adds a single byte to the buffer.
+/// </summary>
+/// <param name="c">The byte.</param>
+/// <returns>The number of bytes accepted (always 1).</returns>
+size_t OutputBuffer::write(uint8_t c)
+{
+    return write(&c, 1);
+}
+
+/// <summary>
+/// Adds the data to the buffer (or holds it while paging). If the buffer is full the data is dropped
+/// according to the policy. The full size is always returned so that the formatters do not stop printing.
+/// </summary>
+/// <param name="data">The data.</param>
+/// <param name="size">The number of bytes.</param>
+/// <returns>The number of bytes accepted (always size).</returns>
+size_t OutputBuffer::write(const uint8_t* data, size_t size)
+{
+    if (isPaging())
+    {
+        _hold(data, size);
+    }
+    else
+    {
+        _add(data, size);
+    }
+
+    return size;
+}
+
+/// <summary>
+/// Pages the output of the source: the source is asked for the next chunk whenever the buffer has room
+/// (see drainTo()). If the buffer is already paging (i.e. several commands in a single input), the source
+/// output is written at once (held, using the policy).
+/// </summary>
+/// <param name="source">The output source.</param>
+void OutputBuffer::page(Source source)
+{
+    if (isPaging())
+    {
+        String chunk;
+
+        while (source(chunk))
+        {
+            print(chunk);
+            chunk = "";
+        }
+
+        return;
+    }
+
+    _source = source;
+    _fill();
+}
+
+/// <summary>
+/// Pages the text. A text fitting into the buffer is added at once.
+/// </summary>
+/// <param name="text">The text.</param>
+void OutputBuffer::page(const String& text)
+{
+    if (isPaging() || (text.length() <= SIZE - _count))
+    {
+        print(text);
+        return;
+    }
+
+    _chunk  = text;
+    _offset = 0;
+    _fill();
+}
+
+/// <summary>
+/// Writes the buffered output to the sink, refilling the buffer from the paged output. Only as many bytes
+/// as the sink accepts without blocking are written, in chunks of at most MTU bytes.
+/// </summary>
+/// <param name="out">The output sink (i.e. a WiFiClient or SerialBT).</param>
+/// <returns>The number of bytes written.</returns>
+size_t OutputBuffer::drainTo(Print& out)
+{
+    size_t total = 0;
+
+    while (true)
+    {
+        if (isPaging()) _fill();
+
+        if (_count == 0)
+            break;
+
+        int room = out.availableForWrite();
+
+        if (room <= 0)
+            break;
+
+        size_t chunk = min(min(_count, SIZE - _tail), min((size_t)room, MTU));
+        size_t count = out.write(&_buffer[_tail], chunk);
+
+        if (count == 0)
+            break;
+
+        _tail  = (_tail + count) % SIZE;
+        _count -= count;
+        total  += count;
+    }
+
+    if (_count == 0)
+    {
+        _head = _tail = 0;
+        _truncated = false;
+    }
+
+    return total;
+}
+
+/// <summary>
+/// Discards all buffered output and the paged output.
+/// </summary>
+void OutputBuffer::clear()
+{
+    _head = _tail = _count = 0;
+    _truncated = false;
+    _source = nullptr;
+    _chunk  = "";
+    _offset = 0;
+    _held   = "";
+}
@@ -0,0 +1,91 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="OutputBuffer.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 1:40 PM</created>
+// <modified>19-10-2026 5:10 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   A fixed-size output ring buffer, filled by the formatters and drained once per loop (non-blocking).
+//   Large outputs are paged: a source is asked for the next chunk whenever the buffer has room.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+/// <summary>
+/// This class buffers the output for a single sink (telnet session or SerialBT). As it is derived from Print,
+/// all print functions can be used to fill the buffer. The buffer is drained once per loop iteration writing
+/// only as much as the sink accepts without blocking (availableForWrite), in chunks of at most MTU bytes.
+///
+/// If the sink is too slow and the buffer is full, the output is dropped according to the policy (the buffer
+/// never waits for the sink):
+///
+///     TRUNCATE    - The new output is dropped and a truncation marker is appended. Further output is
+///                   dropped until the buffer has been drained completely.
+///     DROP_OLDEST - The oldest output is discarded to make room for the new output.
+///
+/// A response larger than the buffer (i.e. 'help', 'settings' or the profile) is paged: the producer is set
+/// as the source (see page()), which is asked for the next chunk whenever the buffer has room while draining.
+/// The output is therefore generated over several loops at the speed of the sink. Output written while
+/// paging (i.e. the prompt) is held (at most SIZE bytes, using the policy) and follows the paged output.
+/// </summary>
+class OutputBuffer : public Print
+{
+public:
+    static constexpr const size_t SIZE = 2048;      // The buffer size (bytes).
+    static constexpr const size_t MTU  = 1460;      // The maximum number of bytes written at once.
+
+    /// <summary>
+    /// A paged output source: sets the next chunk and returns true, or returns false if all output is done.
+    /// </summary>
+    typedef std::function<bool(String& chunk)> Source;
+
+    enum Policy
+    {
+        TRUNCATE,                                   // Drop the new output (and mark the truncation).
+        DROP_OLDEST                                 // Drop the oldest output.
+    };
+
+private:
+    uint8_t  _buffer[SIZE];                         // The ring buffer.
+    size_t   _head      = 0;                        // The write index.
+    size_t   _tail      = 0;                        // The read index.
+    size_t   _count     = 0;                        // The number of buffered bytes.
+    Policy   _policy    = TRUNCATE;                 // The policy used if the buffer is full.
+    bool     _truncated = false;                    // Flag indicating that output has been truncated.
+    uint32_t _dropped   = 0;                        // The total number of dropped bytes.
+    Source   _source;                               // The paged output source (empty if not paging).
+    String   _chunk;                                // The current chunk of the paged output.
+    size_t   _offset    = 0;                        // The number of bytes of the chunk already buffered.
+    String   _held;                                 // The output written while paging (follows the paged output).
+
+    void _put(const uint8_t* data, size_t size);    // Copies the data into the buffer (must fit).
+    void _discard(size_t size);                     // Discards the oldest bytes.
+    void _add(const uint8_t* data, size_t size);    // Adds the data to the buffer (using the policy if full).
+    void _hold(const uint8_t* data, size_t size);   // Holds the data until the paged output is done.
+    void _fill();                                   // Fills the buffer from the paged output.
+
+public:
+    OutputBuffer(Policy policy = TRUNCATE) : _policy(policy) {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t* data, size_t size) override;
+    using Print::write;
+
+    void   page(Source source);                     // Pages the output of the source (while draining).
+    void   page(const String& text);                // Pages the text (a response larger than the buffer).
+    size_t drainTo(Print& out);                     // Writes the buffered (and paged) output (non-blocking).
+    void   clear();                                 // Discards all buffered output (and the paged output).
+
+    inline void     setPolicy(Policy policy) { _policy = policy; }
+    inline bool     isPaging() const { return (bool)_source || (_offset < _chunk.length()); }
+    inline size_t   length() const { return _count; }
+    inline uint32_t getDropped() const { return _dropped; }
+};
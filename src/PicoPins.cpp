@@ -31,20 +31,17 @@ GpioPin::GpioPin(uint8_t pin, PinMode mode, String name)
 }
 
 /// <summary>
-/// Creates a JSON object with the current field values. The status is updated.
+/// Fills the JSON object with the current field values. The status is updated.
 /// </summary>
-/// <returns>The new JsonObject (pointing to the static JSON document).</returns>
-JsonObject GpioPin::toJson()
+/// <param name="json">The JSON object to be filled.</param>
+void GpioPin::toJson(JsonObject json)
 {
     PinStatus status = digitalRead(Pin);
 
-    _doc.clear();
-    _doc["Pin"] = Pin;
-    _doc["Name"] = Name;
-    _doc["Mode"] = Mode;
-    _doc["Status"] = status;
-
-    return _doc.as<JsonObject>();
+    json["Pin"] = Pin;
+    json["Name"] = Name;
+    json["Mode"] = Mode;
+    json["Status"] = status;
 }
 
 /// <summary>
@@ -172,16 +169,16 @@ String GpioPins::toJsonString()
 {
     String json;
 
-    _doc.clear();
-    JsonArray array = _doc.to<JsonArray>();
+    JsonArenaDocument doc(JSON_SIZE);
+    JsonArray array = doc.to<JsonArray>();
 
     for (auto const& [key, val] : _pins)
     {
         GpioPin pin = val;
-        array.add(pin.toJson());
+        pin.toJson(array.createNestedObject());
     }
 
-    serializeJsonPretty(_doc, json);
+    serializeJsonPretty(doc, json);
 
     return json;
 }
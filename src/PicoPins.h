@@ -15,6 +15,8 @@
 #include <Arduino.h>
 #include <ArduinoJson.h>
 
+#include "JsonArena.h"
+
 #include <functional>
 #include <map>
 
@@ -111,9 +113,6 @@ const std::pair<uint8_t, uint8_t> GPIO_ROWS[PICO_PIN_ROWS] = {
 /// </summary>
 class GpioPin
 {
-private:
-    StaticJsonDocument<96> _doc;                            // The Json document representing the pin data.
-
 public:
     GpioPin() {}
     GpioPin(uint8_t pin, PinMode mode, String name = "");   // Initializes the public fields.
@@ -122,7 +121,7 @@ public:
     String Name;                                            // GPIO Pin name (default: GP0 - GP22).
     PinMode Mode;                                           // The pin mode (as defined in Common.h).
 
-    JsonObject toJson();                                    // Get a JSON representation.
+    void toJson(JsonObject json);                           // Fill the JSON representation.
 };
 
 /// <summary>
@@ -131,7 +130,7 @@ public:
 class GpioPins
 {
 private:
-    StaticJsonDocument<3072> _doc;                                              // The Json document representing all pin data.
+    static const size_t JSON_SIZE = 3072;                                       // The JSON document capacity (all pins, borrowed from the arena).
     std::map<uint8_t, GpioPin> _pins;                                           // List of all (registered) GPIO pins.
 
     bool   _contains(uint8_t key);                                              // Helper functionto check if the key (pin) has already been used.
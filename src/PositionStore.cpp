@@ -0,0 +1,194 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="PositionStore.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 11:55 PM</created>
+// <modified>18-10-2026 11:55 PM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+#include <LittleFS.h>
+
+#include "PositionStore.h"
+#include "BinaryStream.h"
+
+/// <summary>
+/// Calculates the CRC-32 of the record (all fields preceding the CRC).
+/// </summary>
+/// <param name="record">The record.</param>
+/// <returns>The CRC-32 value.</returns>
+uint32_t PositionStore::_getCrc(const Record& record)
+{
+    return crc32(reinterpret_cast<const uint8_t*>(&record), offsetof(Record, Crc));
+}
+
+/// <summary>
+/// Creates the position file with all slots empty (zero), so the slots can be written in place.
+/// </summary>
+/// <returns>True if successful.</returns>
+bool PositionStore::_create()
+{
+    uint8_t empty[sizeof(Record)] = {};
+
+    File file = LittleFS.open(POSITION_FILE, "w");
+
+    if (!file)
+    {
+        return false;
+    }
+
+    size_t size = 0;
+
+    for (size_t i = 0; i < SLOTS; i++)
+    {
+        size += file.write(empty, sizeof(empty));
+    }
+
+    file.close();
+
+    return size == SLOTS * sizeof(Record);
+}
+
+/// <summary>
+/// Reads all records (single read) and finds the valid record with the highest sequence number.
+/// The file is created if it does not exist or has a different size.
+/// </summary>
+/// <returns>True if a valid record has been found.</returns>
+bool PositionStore::begin()
+{
+    Record records[SLOTS];
+
+    _valid = false;
+    _slot  = SLOTS - 1;
+
+    File file = LittleFS.open(POSITION_FILE, "r");
+
+    if (!file || (file.size() != sizeof(records)))
+    {
+        if (file) file.close();
+
+        _create();
+        return false;
+    }
+
+    size_t size = file.read(reinterpret_cast<uint8_t*>(records), sizeof(records));
+    file.close();
+
+    if (size != sizeof(records))
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < SLOTS; i++)
+    {
+        const Record& record = records[i];
+
+        if ((record.Magic != MAGIC) || (record.Crc != _getCrc(record)))
+            continue;
+
+        if (!_valid || (int32_t(record.Sequence - _last.Sequence) > 0))
+        {
+            _last  = record;
+            _slot  = i;
+            _valid = true;
+        }
+    }
+
+    return _valid;
+}
+
+/// <summary>
+/// Gets the last valid record (read at boot or written since).
+/// </summary>
+/// <param name="record">The record.</param>
+/// <returns>True if a valid record exists.</returns>
+bool PositionStore::getLast(Record& record)
+{
+    if (_valid) record = _last;
+    return _valid;
+}
+
+/// <summary>
+/// Checks if the last record holds the state. The position is only compared for a clean record
+/// (the position is not exact while moving).
+/// </summary>
+/// <param name="position">The position (steps).</param>
+/// <param name="calibrated">True if the position is calibrated.</param>
+/// <param name="clean">True if the stepper has been stopped.</param>
+/// <param name="alarm">True if the stepper alarm is on.</param>
+/// <returns>True if the last record holds the state (no record needs to be written).</returns>
+bool PositionStore::isCurrent(long position, bool calibrated, bool clean, bool alarm)
+{
+    return _valid &&
+           (_last.Clean == clean) &&
+           (_last.Calibrated == calibrated) &&
+           (_last.Alarm == alarm) &&
+           (!clean || (_last.Position == position));
+}
+
+/// <summary>
+/// Writes a record if the state differs from the last record (see isCurrent()).
+/// </summary>
+/// <param name="position">The position (steps).</param>
+/// <param name="calibrated">True if the position is calibrated.</param>
+/// <param name="clean">True if the stepper has been stopped.</param>
+/// <param name="alarm">True if the stepper alarm is on.</param>
+/// <returns>True if a record has been written.</returns>
+bool PositionStore::update(long position, bool calibrated, bool clean, bool alarm)
+{
+    if (isCurrent(position, calibrated, clean, alarm))
+    {
+        return false;
+    }
+
+    return write(position, calibrated, clean, alarm);
+}
+
+/// <summary>
+/// Writes a record to the next slot in the ring.
+/// </summary>
+/// <param name="position">The position (steps).</param>
+/// <param name="calibrated">True if the position is calibrated.</param>
+/// <param name="clean">True if the stepper has been stopped.</param>
+/// <param name="alarm">True if the stepper alarm is on.</param>
+/// <returns>True if successful.</returns>
+bool PositionStore::write(long position, bool calibrated, bool clean, bool alarm)
+{
+    Record record;
+    record.Sequence   = _valid ? _last.Sequence + 1 : 1;
+    record.Position   = position;
+    record.Calibrated = calibrated;
+    record.Clean      = clean;
+    record.Alarm      = alarm;
+    record.Crc        = _getCrc(record);
+
+    size_t slot = (_slot + 1) % SLOTS;
+
+    File file = LittleFS.open(POSITION_FILE, "r+");
+
+    if (!file && _create())
+    {
+        file = LittleFS.open(POSITION_FILE, "r+");
+    }
+
+    if (!file)
+    {
+        return false;
+    }
+
+    bool ok = file.seek(slot * sizeof(Record)) &&
+              (file.write(reinterpret_cast<const uint8_t*>(&record), sizeof(record)) == sizeof(record));
+    file.close();
+
+    if (ok)
+    {
+        _last  = record;
+        _slot  = slot;
+        _valid = true;
+        _writes++;
+    }
+
+    return ok;
+}
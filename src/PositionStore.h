@@ -0,0 +1,71 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="PositionStore.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 11:55 PM</created>
+// <modified>18-10-2026 11:55 PM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   A ring of position records in flash, used to restore the actuator position after a reboot.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+#define POSITION_FILE "position.bin"
+
+/// <summary>
+/// This class persists the actuator position in a ring of fixed size records ('position.bin'). Every record
+/// holds a sequence number and a CRC-32, the valid record with the highest sequence number is the current one.
+/// The records are written to the next slot in turn, so the writes are spread over the file, and a write
+/// interrupted by a power loss leaves the previous record intact.
+///
+/// A record is written before a move starts (not clean, the position becomes unknown) and after the move
+/// has ended (clean, exact position). The position is only restored at boot from a clean record without
+/// a stepper alarm. Note that no record is written while the stepper is running, as a flash write stalls
+/// the interrupts (step timing).
+/// </summary>
+class PositionStore
+{
+public:
+    static const uint32_t MAGIC = 0x31505959;       // The record magic ("YYP1").
+    static const size_t   SLOTS = 32;               // The number of records in the ring.
+
+    /// <summary>
+    /// A single position record (as written to flash, the CRC-32 covers all preceding fields).
+    /// </summary>
+    struct Record
+    {
+        uint32_t Magic      = MAGIC;                // The record magic.
+        uint32_t Sequence   = 0;                    // The sequence number (incremented for every record).
+        int32_t  Position   = 0;                    // The position (steps).
+        uint8_t  Calibrated = 0;                    // Flag indicating a calibrated position (homing completed).
+        uint8_t  Clean      = 0;                    // Flag indicating that the stepper was stopped (position exact).
+        uint8_t  Alarm      = 0;                    // Flag indicating that the stepper alarm was on.
+        uint8_t  Reserved   = 0;                    // Padding (zero).
+        uint32_t Crc        = 0;                    // The CRC-32 of the record.
+    };
+
+private:
+    Record   _last;                                 // The last valid record (read or written).
+    bool     _valid = false;                        // Flag indicating that a valid record exists.
+    size_t   _slot  = 0;                            // The slot of the last valid record.
+    uint32_t _writes = 0;                           // The number of records written since boot.
+
+    static uint32_t _getCrc(const Record& record);  // Calculates the CRC-32 of the record.
+    bool _create();                                 // Creates the file with all slots empty.
+
+public:
+    bool begin();                                   // Reads the ring and finds the last valid record.
+    bool getLast(Record& record);                   // Gets the last valid record (false if none).
+    bool isCurrent(long position, bool calibrated, bool clean, bool alarm); // Checks if the last record holds the state.
+    bool update(long position, bool calibrated, bool clean, bool alarm); // Writes a record if the state has changed.
+    bool write(long position, bool calibrated, bool clean, bool alarm);  // Writes a record to the next slot.
+
+    inline uint32_t getWrites() const { return _writes; }
+};
@@ -0,0 +1,202 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="Profiler.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 3:25 AM</created>
+// <modified>19-10-2026 6:00 AM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+#include "Profiler.h"
+
+/// <summary>
+/// Returns the text right aligned to the width.
+/// </summary>
+static String padLeft(const String& text, size_t width)
+{
+    String result;
+
+    while (result.length() + text.length() < width) result += " ";
+
+    return result + text;
+}
+
+/// <summary>
+/// Initializes the static sites.
+/// </summary>
+ProfilerClass::ProfilerClass()
+{
+#if PROFILE_ON
+    _sites[PROFILE_LOOP].Group          = "loop";
+    _sites[PROFILE_LOOP].Name           = "pass";
+    _sites[PROFILE_SETTINGS_LOAD].Group = "settings";
+    _sites[PROFILE_SETTINGS_LOAD].Name  = "load";
+    _sites[PROFILE_SETTINGS_SAVE].Group = "settings";
+    _sites[PROFILE_SETTINGS_SAVE].Name  = "save";
+#endif
+}
+
+/// <summary>
+/// Adds a profiling site. This is called in setup (the names must be constant strings).
+/// </summary>
+/// <param name="group">The site group (i.e. "task", "command", "http").</param>
+/// <param name="name">The site name.</param>
+/// <returns>The site index (or -1 if the table is full or the profiler is compiled out).</returns>
+int ProfilerClass::add(const char* group, const char* name)
+{
+#if PROFILE_ON
+    if (_count >= MAX_SITES)
+    {
+        return -1;
+    }
+
+    _sites[_count].Group = group;
+    _sites[_count].Name  = name;
+
+    return _count++;
+#else
+    (void)group;
+    (void)name;
+
+    return -1;
+#endif
+}
+
+/// <summary>
+/// Reads the next chunk of the aggregates of all sites used: the header, a site per chunk, and the trailer
+/// (JSON only). The JSON output holds the times in usec (the total in ms) and the bucket upper bounds, the
+/// text output a line per site. The output can be limited to a single group (i.e. "task"). The cursor keeps
+/// the position, so the output can be paged (the complete table easily exceeds the telnet output buffer).
+/// Sites added or used between the chunks are included if not yet passed.
+/// </summary>
+/// <param name="cursor">The cursor (a new cursor starts with the header).</param>
+/// <param name="chunk">The chunk read.</param>
+/// <returns>True if a chunk has been read, false if the output is done.</returns>
+bool ProfilerClass::read(Cursor& cursor, String& chunk)
+{
+    String bounds;
+
+    if (cursor.Index < 0)
+    {
+        for (int i = 0; i < BUCKETS - 1; i++)
+        {
+            bounds += String(i ? ", " : "") + getBound(i);
+        }
+    }
+
+#if PROFILE_ON
+    if (cursor.Index < 0)
+    {
+        cursor.Index = 0;
+
+        if (cursor.Json)
+        {
+            chunk = String("{\n    \"Enabled\": true,\n    \"Bounds\": [ ") + bounds + " ],\n    \"Sites\": [";
+        }
+        else
+        {
+            String line = "    Site";
+
+            while (line.length() < 40) line += " ";
+
+            line += "   Count  Total ms     Avg     Max";
+
+            for (int i = 0; i < BUCKETS - 1; i++)
+            {
+                uint32_t bound = getBound(i);
+                line += padLeft(String("<") + ((bound < 1024) ? String(bound) : String(bound / 1024) + "k"), 7);
+            }
+
+            chunk = String("Profile (times in usec, inclusive):\r\n") + line + padLeft(">=64k", 7) + "\r\n";
+        }
+
+        return true;
+    }
+
+    while (cursor.Index < _count)
+    {
+        const Site& site = _sites[cursor.Index++];
+
+        if (site.Count == 0) continue;
+        if ((cursor.Group.length() > 0) && (strcmp(cursor.Group.c_str(), site.Group) != 0)) continue;
+
+        uint32_t average = uint32_t(site.Total / site.Count);
+        String   total   = String(double(site.Total) / 1000.0, 3);
+
+        if (cursor.Json)
+        {
+            String buckets;
+
+            for (int j = 0; j < BUCKETS; j++)
+            {
+                buckets += String(j ? ", " : "") + site.Buckets[j];
+            }
+
+            chunk = String(cursor.First ? "\n" : ",\n") +
+                    "        { \"Group\": \"" + site.Group + "\", \"Name\": \"" + site.Name + "\", \"Count\": " + site.Count +
+                    ", \"Total\": " + total + ", \"Average\": " + average + ", \"Max\": " + site.Max +
+                    ", \"Buckets\": [ " + buckets + " ] }";
+        }
+        else
+        {
+            chunk = String("    ") + site.Group + ":" + site.Name;
+
+            while (chunk.length() < 40) chunk += " ";
+
+            chunk += padLeft(String(site.Count), 8) + padLeft(total, 10) + padLeft(String(average), 8) + padLeft(String(site.Max), 8);
+
+            for (int j = 0; j < BUCKETS; j++)
+            {
+                chunk += padLeft(String(site.Buckets[j]), 7);
+            }
+
+            chunk += "\r\n";
+        }
+
+        cursor.First = false;
+
+        return true;
+    }
+
+    // The trailer (JSON only).
+    if (cursor.Json && (cursor.Index == _count))
+    {
+        cursor.Index++;
+        chunk = "\n    ]\n}\n";
+
+        return true;
+    }
+
+    return false;
+#else
+    if (cursor.Index >= 0) return false;
+
+    cursor.Index = 0;
+    chunk = cursor.Json ? String("{\n    \"Enabled\": false,\n    \"Bounds\": [ ") + bounds + " ],\n    \"Sites\": []\n}\n"
+                        : String("Profiler compiled out (PROFILE_ON is 0).\r\n");
+
+    return true;
+#endif
+}
+
+/// <summary>
+/// Streams the aggregates of all sites used, a site per chunk (see read()).
+/// </summary>
+/// <param name="json">True for JSON, false for text.</param>
+/// <param name="writer">The writer (called for every chunk).</param>
+/// <param name="group">The site group (nullptr or empty: all groups).</param>
+void ProfilerClass::write(bool json, Writer writer, const char* group)
+{
+    Cursor cursor;
+    String chunk;
+
+    cursor.Json  = json;
+    cursor.Group = (group != nullptr) ? group : "";
+
+    while (read(cursor, chunk))
+    {
+        writer(chunk);
+    }
+}
@@ -0,0 +1,154 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="Profiler.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 3:25 AM</created>
+// <modified>19-10-2026 6:00 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   Scoped timers feeding fixed-size timing aggregates (count, total, max, histogram) per profiling site.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+// Set PROFILE_ON to 0 to compile out the profiler (the scoped timers and the site table).
+#ifndef PROFILE_ON
+#define PROFILE_ON 1
+#endif
+
+/// <summary>
+/// The static profiling sites. The sites added at runtime (tasks, commands, HTTP routes) follow.
+/// </summary>
+enum ProfileSite : int
+{
+    PROFILE_LOOP,                                   // The main loop (a scheduler pass).
+    PROFILE_SETTINGS_LOAD,                          // Loading the settings (binary snapshot or JSON file).
+    PROFILE_SETTINGS_SAVE,                          // Saving the changed settings (JSON file and binary snapshot).
+    PROFILE_STATIC_SITES                            // The number of static sites.
+};
+
+/// <summary>
+/// This class holds the timing aggregates of all profiling sites. A site is identified by its index (a static
+/// site, or the index returned by add()). The times are recorded by a ProfileTimer (PROFILE_SCOPE), or directly
+/// where the time has already been measured (scheduler tasks, HTTP routes). The times are inclusive (a command
+/// is part of the telnet task, which is part of the loop).
+///
+/// The histogram buckets have the upper bounds 16, 64, 256 ... 65536 usec (powers of four), the last bucket
+/// holds the longer times. The aggregates are updated from the main loop only (not in an ISR).
+///
+/// With PROFILE_ON set to 0 the site table is removed, add() returns -1, record() and PROFILE_SCOPE are empty.
+/// </summary>
+class ProfilerClass
+{
+public:
+    static const int MAX_SITES = 128;               // The maximum number of sites (including the static sites).
+    static const int BUCKETS   = 8;                 // The number of histogram buckets.
+
+    /// <summary>
+    /// The timing aggregates of a single site.
+    /// </summary>
+    struct Site
+    {
+        const char* Group = "";                     // The site group (i.e. "task", "command", "http").
+        const char* Name  = "";                     // The site name.
+        uint32_t    Count = 0;                      // The number of recorded times.
+        uint64_t    Total = 0;                      // The sum of all recorded times (usec).
+        uint32_t    Max   = 0;                      // The maximum recorded time (usec).
+        uint32_t    Buckets[BUCKETS] = {};          // The (non-cumulative) bucket counts.
+    };
+
+    /// <summary>
+    /// The read position of the output (see read()), so the output can be paged over several loops.
+    /// </summary>
+    struct Cursor
+    {
+        bool   Json  = false;                       // True for JSON, false for text.
+        String Group;                               // The site group (empty: all groups).
+        int    Index = -1;                          // The next site (-1: the header).
+        bool   First = true;                        // Flag indicating that no site has been read yet.
+    };
+
+    typedef std::function<void(const String&)> Writer;
+
+private:
+#if PROFILE_ON
+    Site _sites[MAX_SITES];                         // The profiling sites.
+    int  _count = PROFILE_STATIC_SITES;             // The number of sites.
+#endif
+
+public:
+    ProfilerClass();
+
+    int  add(const char* group, const char* name);  // Adds a site (returns the site index or -1).
+    bool read(Cursor& cursor, String& chunk);       // Reads the next chunk (header, a site used, trailer).
+    void write(bool json, Writer writer, const char* group = nullptr); // Streams the sites used (a site per chunk).
+
+    /// <summary>
+    /// Gets the upper bound of a histogram bucket (usec, the last bucket has no upper bound).
+    /// </summary>
+    static inline uint32_t getBound(int bucket) { return 16UL << (2 * bucket); }
+
+    /// <summary>
+    /// Records a time (usec) for the site. Invalid sites (i.e. -1 if the table is full) are ignored.
+    /// </summary>
+    inline void record(int site, uint32_t elapsed)
+    {
+#if PROFILE_ON
+        if ((site < 0) || (site >= _count)) return;
+
+        Site& entry = _sites[site];
+        int bucket = 0;
+
+        while ((bucket < BUCKETS - 1) && (elapsed >= getBound(bucket)))
+            ++bucket;
+
+        entry.Count++;
+        entry.Total += elapsed;
+        entry.Buckets[bucket]++;
+
+        if (elapsed > entry.Max) entry.Max = elapsed;
+#else
+        (void)site;
+        (void)elapsed;
+#endif
+    }
+};
+
+// The global profiler (see YardControl.ino), used by the inline scoped timer.
+extern ProfilerClass Profiler;
+
+#if PROFILE_ON
+
+/// <summary>
+/// A scoped timer recording the time from construction to destruction (end of scope) for the site.
+/// </summary>
+class ProfileTimer
+{
+private:
+    int      _site;                                 // The profiling site.
+    uint32_t _start;                                // The start time (micros).
+
+public:
+    inline explicit ProfileTimer(int site) : _site(site), _start(micros()) {}
+    inline ~ProfileTimer() { Profiler.record(_site, micros() - _start); }
+
+    ProfileTimer(const ProfileTimer&) = delete;
+    ProfileTimer& operator=(const ProfileTimer&) = delete;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(site) ProfileTimer PROFILE_CONCAT(_profileTimer, __LINE__)(site)
+
+#else
+
+#define PROFILE_SCOPE(site) do {} while (0)
+
+#endif
@@ -13,8 +13,10 @@
 
 #include "AppSettings.h"
 #include "ServerInfo.h"
+#include "TelnetServer.h"
 
 extern AppSettings Settings;
+extern TelnetServer Telnet;
 
 /// <summary>
 ///  Using a WiFi instance to get the actual data.
@@ -48,6 +50,9 @@ ServerInfo::ServerInfo()
     Port   = Settings.Server.Http;
     Telnet = Settings.Server.Telnet;
     Prompt = Settings.Server.Prompt;
+
+    Sessions    = ::Telnet.getSessionCount();
+    MaxSessions = ::Telnet.getMaxSessions();
 }
 
 /// <summary>
@@ -57,14 +62,16 @@ String ServerInfo::toJsonString()
 {
     String json;
 
-    _doc.clear();
-    _doc["Address"] = Address;
-    _doc["Name"]    = Name;
-    _doc["Mode"]    = Mode;
-    _doc["Port"]    = Port;
-    _doc["Telnet"]  = Telnet;
-    _doc["Prompt"]  = Prompt;
-    serializeJsonPretty(_doc, json);
+    JsonArenaDocument doc(JSON_SIZE);
+    doc["Address"]     = Address;
+    doc["Name"]        = Name;
+    doc["Mode"]        = Mode;
+    doc["Port"]        = Port;
+    doc["Telnet"]      = Telnet;
+    doc["Sessions"]    = Sessions;
+    doc["MaxSessions"] = MaxSessions;
+    doc["Prompt"]      = Prompt;
+    serializeJsonPretty(doc, json);
 
     return json;
 }
@@ -80,6 +87,7 @@ String ServerInfo::toString()
 	              "    Mode:    " + Mode    + "\r\n" +
 	              "    Port:    " + Port    + "\r\n" +
                   "    Telnet:  " + Telnet  + "\r\n" +
+                  "    Sessions: " + Sessions + " (max. " + MaxSessions + ")\r\n" +
 	              "    Prompt:  " + Prompt  + "\r\n";
 }
 
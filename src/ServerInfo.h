@@ -18,13 +18,15 @@
 
 #include <ArduinoJson.h>
 
+#include "JsonArena.h"
+
 /// <summary>
 /// This class holds the actual TCP server settings data.
 /// </summary>
 class ServerInfo
 {
 private:
-    StaticJsonDocument<192> _doc; // The Json document representing the data.
+    static const size_t JSON_SIZE = 256; // The JSON document capacity (borrowed from the arena).
 
 public:
     ServerInfo();
@@ -34,6 +36,8 @@ public:
 	String Mode;			// The WiFi mode (AP, STA).
 	int    Port;		    // The Web server IP port.
     int    Telnet;          // The telnet server IP port.
+    int    Sessions;        // The number of connected telnet sessions.
+    int    MaxSessions;     // The maximum number of telnet sessions.
     String Prompt;			// The Server prompt.
 
     String toJsonString();  // Get a serialized JSON representation.
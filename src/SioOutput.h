@@ -0,0 +1,72 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="SioOutput.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 11:05 PM</created>
+// <modified>18-10-2026 11:05 PM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   Direct GPIO output using the SIO set and clear registers (no digitalWrite).
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <hardware/structs/sio.h>
+
+#include <utility>
+
+/// <summary>
+/// This struct writes the output pins given by the (compile time) pin mask using the SIO set and clear
+/// registers. Every call is inlined to a single store of an immediate mask, there is no pin validation
+/// or mode lookup as in digitalWrite(). The pins have to be configured as outputs (see PicoPins).
+/// </summary>
+template <uint32_t MASK>
+struct SioPins
+{
+    static inline void set() { sio_hw->gpio_set = MASK; }
+    static inline void clr() { sio_hw->gpio_clr = MASK; }
+};
+
+/// <summary>
+/// This class is the run time equivalent of SioPins, the mask is set from the pin numbers in the settings.
+/// It is used for the outputs which are not written in the step interrupt (direction, enable and LEDs).
+/// </summary>
+class SioOutput
+{
+private:
+    uint32_t _mask = 0;                             // The pin mask (0 if no valid pin has been set).
+
+public:
+    inline void init(uint8_t pin) { _mask = (pin < NUM_BANK0_GPIOS) ? (1u << pin) : 0; }
+    inline void set() const { sio_hw->gpio_set = _mask; }
+    inline void clr() const { sio_hw->gpio_clr = _mask; }
+    inline void put(bool value) const { if (value) set(); else clr(); }
+    inline uint32_t getMask() const { return _mask; }
+};
+
+/// <summary>
+/// Selects the instantiation of a template parameterized on the pin mask for a pin number (at run time).
+/// The table with one instantiation for every GPIO pin is created at compile time. The selector is a struct
+/// with a static template function get<MASK>() returning the instantiation (i.e. a function pointer).
+/// An invalid pin number selects the instantiation for the mask 0 (no output).
+/// </summary>
+template <typename Selector, size_t... PINS>
+inline auto selectForPin(uint8_t pin, std::index_sequence<PINS...>)
+{
+    using Result = decltype(Selector::template get<0>());
+    static const Result TABLE[] = { Selector::template get<(1u << PINS)>()... };
+
+    return (pin < sizeof...(PINS)) ? TABLE[pin] : Selector::template get<0>();
+}
+
+template <typename Selector>
+inline auto selectForPin(uint8_t pin)
+{
+    return selectForPin<Selector>(pin, std::make_index_sequence<NUM_BANK0_GPIOS>());
+}
@@ -0,0 +1,360 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="StepEngine.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 11:40 PM</created>
+// <modified>18-10-2026 11:40 PM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+#include <ArduinoJson.h>
+
+#include "StepEngine.h"
+#include "JsonArena.h"
+
+// Externals (globals).
+extern AppSettings Settings;
+extern LinearActuator Actuator;
+
+/// <summary>
+/// Gets the axis. Axis 0 is the global actuator, an invalid or disabled axis index returns axis 0.
+/// </summary>
+/// <param name="index">The axis index.</param>
+/// <returns>The axis.</returns>
+LinearActuator& StepEngine::getAxis(uint8_t index)
+{
+    return ((index > 0) && isEnabled(index)) ? _axes[index - 1] : Actuator;
+}
+
+/// <summary>
+/// Checks the axis index.
+/// </summary>
+/// <param name="index">The axis index.</param>
+/// <returns>True if the axis index is valid and the axis is enabled.</returns>
+bool StepEngine::isEnabled(uint8_t index)
+{
+    return (index < MAX_AXES) && _enabled[index];
+}
+
+/// <summary>
+/// Checks the running flag of all enabled axes.
+/// </summary>
+/// <returns>True if any axis is running.</returns>
+bool StepEngine::isRunning()
+{
+    for (uint8_t i = 0; i < MAX_AXES; i++)
+    {
+        if (isEnabled(i) && getAxis(i).getRunningFlag()) return true;
+    }
+
+    return false;
+}
+
+/// <summary>
+/// Gets the coordinated move flag.
+/// </summary>
+/// <returns>The flag value.</returns>
+bool StepEngine::isLinear()
+{
+    return _linear;
+}
+
+/// <summary>
+/// Initializes axis 0 and all enabled additional axes using the application settings. The pins of the
+/// additional axes are configured in setup(), so enabling an axis takes effect after a reboot.
+/// </summary>
+void StepEngine::init()
+{
+    Actuator.init(0);
+
+    for (uint8_t i = 1; i < MAX_AXES; i++)
+    {
+        _enabled[i] = Settings.Axes.Axis[i - 1].Enabled;
+        if (_enabled[i]) _axes[i - 1].init(i);
+    }
+}
+
+/// <summary>
+/// Applies the settings of the enabled additional axes (speed, ramp, microsteps, and rotation).
+/// Note that the settings are ignored if the axis is still moving.
+/// </summary>
+void StepEngine::apply()
+{
+    for (uint8_t i = 1; i < MAX_AXES; i++)
+    {
+        if (_enabled[i]) _axes[i - 1].apply();
+    }
+}
+
+/// <summary>
+/// Updates the settings of all enabled axes with the current values.
+/// </summary>
+void StepEngine::update()
+{
+    for (uint8_t i = 0; i < MAX_AXES; i++)
+    {
+        if (isEnabled(i)) getAxis(i).update();
+    }
+}
+
+/// <summary>
+/// Completes the moves halted by an input interrupt (see halt()), and runs the additional axes
+/// (move records). The global actuator is run from the main loop. This is called from the main loop.
+/// </summary>
+void StepEngine::run()
+{
+    for (uint8_t i = 0; i < MAX_AXES; i++)
+    {
+        if (isEnabled(i) && getAxis(i).getHaltedFlag())
+        {
+            getAxis(i).stop();
+        }
+    }
+
+    for (uint8_t i = 1; i < MAX_AXES; i++)
+    {
+        if (_enabled[i]) _axes[i - 1].run();
+    }
+}
+
+/// <summary>
+/// Starts a coordinated move. All axes start at the same time and reach the target at the same time.
+/// The axis with the most steps runs the speed profile, the other axes follow (see _distribute()).
+/// Axes not moving (target = position) are not started.
+/// </summary>
+/// <param name="targets">The absolute target positions of all axes [steps].</param>
+/// <returns>A command specific message.</returns>
+String StepEngine::moveLinear(const long targets[MAX_AXES])
+{
+    if (isRunning() || _linear)
+    {
+        return String("Still moving - ignoring move request");
+    }
+
+    _master = 0;
+    _masterSteps = 0;
+
+    for (uint8_t i = 0; i < MAX_AXES; i++)
+    {
+        _delta[i] = isEnabled(i) ? abs(targets[i] - getAxis(i).getPosition()) : 0;
+
+        if (!isEnabled(i) && (targets[i] != 0))
+        {
+            return String("Axis ") + i + " not enabled - ignoring move request";
+        }
+
+        if (_delta[i] > _masterSteps)
+        {
+            _master = i;
+            _masterSteps = _delta[i];
+        }
+    }
+
+    if (_masterSteps == 0)
+    {
+        return String("Already at target - ignoring move request");
+    }
+
+    if ((_delta[0] > 0) && (Actuator.getDriver() != LinearActuator::DRIVER_TIMER))
+    {
+        return String("Coordinated moves require the timer driver on axis 0 - ignoring move request");
+    }
+
+    // The followers are flagged running before the master starts, so the not clean position record of
+    // axis 0 is written first (all axes idle).
+    if ((_delta[0] > 0) && !Actuator.markMoving())
+    {
+        return String("Axis 0 position record not written - ignoring move request");
+    }
+
+    String result;
+
+    // Start the followers first (no pulses until requested).
+    for (uint8_t i = 0; i < MAX_AXES; i++)
+    {
+        if ((i == _master) || (_delta[i] == 0)) continue;
+
+        _error[i] = _masterSteps / 2;
+        result += String("Axis ") + i + ": " + getAxis(i).moveFollow(targets[i]) + "\r\n";
+    }
+
+    _done = 0;
+
+    result += String("Axis ") + _master + ": " + getAxis(_master).moveAbsolute(targets[_master]);
+
+    if (!getAxis(_master).getRunningFlag())
+    {
+        for (uint8_t i = 0; i < MAX_AXES; i++)
+        {
+            if (isEnabled(i) && (i != _master)) getAxis(i).stop();
+        }
+
+        return result;
+    }
+
+    // The master steps output before the flag is set are distributed in the next interrupt.
+    _linear = true;
+
+    return result;
+}
+
+/// <summary>
+/// Distributes the master steps output since the last call to the followers (Bresenham). If the master has
+/// ended (target reached, stopped, or halted) the followers complete the steps already requested.
+/// This is called from the step timer interrupt after all axes have been updated.
+/// </summary>
+void StepEngine::_distribute()
+{
+    LinearActuator& master = getAxis(_master);
+    long steps = master.getStepCount();
+
+    while (_done < steps)
+    {
+        ++_done;
+
+        for (uint8_t i = 0; i < MAX_AXES; i++)
+        {
+            if ((i == _master) || (_delta[i] == 0)) continue;
+
+            _error[i] += _delta[i];
+
+            if (_error[i] >= _masterSteps)
+            {
+                _error[i] -= _masterSteps;
+                getAxis(i).follow();
+            }
+        }
+    }
+
+    if (!master.getRunningFlag())
+    {
+        for (uint8_t i = 0; i < MAX_AXES; i++)
+        {
+            if ((i != _master) && (_delta[i] > 0)) getAxis(i).release();
+        }
+
+        _linear = false;
+    }
+}
+
+/// <summary>
+/// Stops the pulse generation of all axes immediately (GPIO interrupt of the safety inputs).
+/// The moves are completed by run() in the main loop.
+/// </summary>
+/// <param name="pin">The input pin number.</param>
+/// <returns>True if any running move has been halted.</returns>
+bool StepEngine::halt(uint8_t pin)
+{
+    bool halted = Actuator.halt(pin);
+
+    for (uint8_t i = 1; i < MAX_AXES; i++)
+    {
+        if (_enabled[i]) halted |= _axes[i - 1].halt(pin);
+    }
+
+    return halted;
+}
+
+/// <summary>
+/// Callback routine for the switches (pressedCallback). Axis 0 handles limits and homing (see LinearActuator),
+/// the additional axes are stopped, and disabled if the stop switch has been turned on.
+/// </summary>
+/// <param name="pin">The input pin number.</param>
+void StepEngine::switchOn(uint8_t pin)
+{
+    Actuator.switchOn(pin);
+
+    for (uint8_t i = 1; i < MAX_AXES; i++)
+    {
+        if (!_enabled[i]) continue;
+
+        _axes[i - 1].stop();
+        if (pin == Settings.Actuator.SwitchStop) _axes[i - 1].disable();
+    }
+}
+
+/// <summary>
+/// Callback routine for the switches (releasedCallback). The additional axes are enabled again when the
+/// stop switch has been released.
+/// </summary>
+/// <param name="pin">The input pin number.</param>
+void StepEngine::switchOff(uint8_t pin)
+{
+    Actuator.switchOff(pin);
+
+    if (pin != Settings.Actuator.SwitchStop) return;
+
+    for (uint8_t i = 1; i < MAX_AXES; i++)
+    {
+        if (_enabled[i]) _axes[i - 1].enable();
+    }
+}
+
+/// <summary>
+/// Step timer callback - updates all enabled axes and distributes the steps of a coordinated move.
+/// </summary>
+void StepEngine::onTimer()
+{
+    Actuator.onTimer();
+
+    for (uint8_t i = 1; i < MAX_AXES; i++)
+    {
+        if (_enabled[i]) _axes[i - 1].onTimer();
+    }
+
+    if (_linear) _distribute();
+}
+
+/// <summary>
+/// Returns a (pretty) string representation of the axes (position and running flag).
+/// </summary>
+/// <returns>The serialized JSON document.</returns>
+String StepEngine::toJsonString()
+{
+    String json;
+
+    JsonArenaDocument doc(JSON_SIZE);
+    doc["Linear"] = isLinear();
+    JsonArray axes = doc.createNestedArray("Axes");
+
+    for (uint8_t i = 0; i < MAX_AXES; i++)
+    {
+        JsonObject axis = axes.createNestedObject();
+        axis["Axis"]     = i;
+        axis["Enabled"]  = isEnabled(i);
+        axis["Running"]  = isEnabled(i) && getAxis(i).getRunningFlag();
+        axis["Position"] = isEnabled(i) ? getAxis(i).getPosition() : 0;
+    }
+
+    serializeJsonPretty(doc, json);
+
+    return json;
+}
+
+/// <summary>
+/// Returns a printable string representation of the axes.
+/// </summary>
+/// <returns>The printable string.</returns>
+String StepEngine::toString()
+{
+    String text = String("Axes:") + "\r\n" +
+                  "    Linear:      " + isLinear() + "\r\n";
+
+    for (uint8_t i = 0; i < MAX_AXES; i++)
+    {
+        text += String("    Axis ") + i + ":      ";
+
+        if (isEnabled(i))
+        {
+            text += String("Position ") + getAxis(i).getPosition() + (getAxis(i).getRunningFlag() ? " (running)" : "") + "\r\n";
+        }
+        else
+        {
+            text += "Disabled\r\n";
+        }
+    }
+
+    return text;
+}
@@ -0,0 +1,82 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="StepEngine.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 11:40 PM</created>
+// <modified>18-10-2026 11:40 PM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   The step engine driving all axes from the step timer interrupt (including coordinated moves).
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "AppSettings.h"
+#include "Actuator.h"
+
+/// <summary>
+/// This class drives all axes from the single step timer interrupt. Axis 0 is the global Actuator (which may
+/// use the PIO step train), the additional axes are configured in the Axes settings and created here.
+///
+/// A coordinated (linear) move starts all axes at the same time and ends them at the same time. The axis
+/// with the most steps (master) runs the speed profile, for every master step the other axes (followers)
+/// are requested a step using the Bresenham algorithm (integer error accumulators, no division in the ISR):
+///
+///     error[i] += delta[i]
+///     if (error[i] >= delta[master]) { error[i] -= delta[master]; step axis i }
+///
+/// The error accumulators start at half the master steps, so the follower steps are centered. As the
+/// master output has been caught up after every interrupt, a follower needs at most one step per master
+/// step (two intervals per pulse). The master has to use the timer interrupt (the step train updates
+/// the step count per buffer only).
+///
+/// The safety inputs (stop and limit switches) are shared, an input edge halts all axes.
+/// </summary>
+class StepEngine
+{
+public:
+    static constexpr const uint8_t MAX_AXES = AppSettings::AxesSettings::MAX_AXES + 1; // The number of axes (including axis 0).
+
+private:
+    static const size_t JSON_SIZE = 256;            // The JSON document capacity (axes data, borrowed from the arena).
+
+    LinearActuator _axes[MAX_AXES - 1];             // The additional axes (axis index 1..).
+    bool           _enabled[MAX_AXES] = { true };   // The enabled axes (axis 0 is always enabled).
+
+    volatile bool  _linear = false;                 // Flag indicating a running coordinated move (used in ISR).
+    uint8_t        _master = 0;                     // The axis running the speed profile.
+    long           _masterSteps = 0;                // The number of master steps.
+    long           _done = 0;                       // The number of master steps distributed to the followers.
+    long           _delta[MAX_AXES] = {};           // The number of steps for every axis.
+    long           _error[MAX_AXES] = {};           // The error accumulators (Bresenham).
+
+    void _distribute();                             // Distributes the master steps to the followers (ISR).
+
+public:
+    LinearActuator& getAxis(uint8_t index);         // Gets the axis (axis 0 for an invalid index).
+    bool isEnabled(uint8_t index);                  // True if the axis index is valid and the axis is enabled.
+    bool isRunning();                               // True if any axis is running.
+    bool isLinear();                                // True if a coordinated move is running.
+
+    void init();                                    // Initializes all enabled axes.
+    void apply();                                   // Applies the settings of the additional axes (not while running).
+    void update();                                  // Updates the settings of all axes with the current values.
+    void run();                                     // Completes the halted moves and runs the additional axes (main loop).
+
+    String moveLinear(const long targets[MAX_AXES]);// Starts a coordinated move to the absolute positions [steps].
+
+    bool halt(uint8_t pin);                         // Halts all axes (GPIO interrupt of the safety inputs).
+    void switchOn(uint8_t pin);                     // Switch callback routine (on event).
+    void switchOff(uint8_t pin);                    // Switch callback routine (off event).
+
+    void onTimer();                                 // Step timer callback routine (all axes).
+
+    String toJsonString();                          // Get a serialized JSON representation.
+    String toString();                              // Get a string representation.
+};
@@ -0,0 +1,120 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="StepPlanner.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 9:30 PM</created>
+// <modified>18-10-2026 9:30 PM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include "StepPlanner.h"
+
+/// <summary>
+/// Starts planning a move. The parameters are calculated by LinearActuator::moveAbsolute().
+/// </summary>
+/// <param name="steps">The total number of steps.</param>
+/// <param name="rampsteps">The number of steps for ramping.</param>
+/// <param name="minspeed">The minimum speed (steps per second).</param>
+/// <param name="deltaspeed">The speed delta for every step.</param>
+void StepPlanner::begin(long steps, long rampsteps, StepSpeed minspeed, SpeedDelta deltaspeed)
+{
+    _steps      = (steps > 0) ? steps : 0;
+    _rampsteps  = (rampsteps > 0) ? rampsteps : 0;
+    _minspeed   = minspeed;
+    _deltaspeed = deltaspeed;
+    _n          = 0;
+}
+
+/// <summary>
+/// Fills the buffer with the next step words (one word per step).
+/// </summary>
+/// <param name="words">The buffer.</param>
+/// <param name="size">The buffer size (words).</param>
+/// <returns>The number of words (steps) written, zero if all steps have been planned.</returns>
+size_t StepPlanner::fill(uint32_t* words, size_t size)
+{
+    size_t count = 0;
+
+    while ((count < size) && (_n < _steps))
+    {
+        words[count++] = encode(getPeriod(_n++));
+    }
+
+    return count;
+}
+
+/// <summary>
+/// Gets the speed at step n. The speed is increased for the first ramp steps, decreased for the last
+/// ramp steps, and constant in between (as in LinearActuator::onTimer()).
+/// </summary>
+/// <param name="n">The step number.</param>
+/// <returns>The speed (steps per second).</returns>
+StepSpeed StepPlanner::getSpeed(long n) const
+{
+    long ramp = n;
+
+    if (_steps - n < ramp) ramp = _steps - n;
+    if (_rampsteps < ramp) ramp = _rampsteps;
+
+    StepSpeed speed = _minspeed + (_deltaspeed * ramp).convert<StepSpeed>();
+
+    if (speed < MIN_SPEED) return MIN_SPEED;
+    if (speed > MAX_SPEED) return MAX_SPEED;
+
+    return speed;
+}
+
+/// <summary>
+/// Gets the step period at step n.
+/// </summary>
+/// <param name="n">The step number.</param>
+/// <returns>The step period (PIO ticks).</returns>
+uint32_t StepPlanner::getPeriod(long n) const
+{
+    return toPeriod(getSpeed(n));
+}
+
+/// <summary>
+/// Gets the step period at the speed (within MIN_SPEED and MAX_SPEED). The tick frequency is scaled as
+/// the speed (Q24.8), so a single (hardware) 32 bit division is used.
+/// </summary>
+/// <param name="speed">The speed (steps per second).</param>
+/// <returns>The step period (PIO ticks).</returns>
+uint32_t StepPlanner::toPeriod(StepSpeed speed)
+{
+    uint32_t value = uint32_t(speed.raw());
+    return ((TICK_FREQUENCY << 8) + value / 2) / value;
+}
+
+/// <summary>
+/// Encodes the step period as a step word. The pulse uses a duty cycle of 50% (as recommended for the
+/// stepper driver). The period is kept within the range supported by the 16 bit counts.
+/// </summary>
+/// <param name="period">The step period (PIO ticks).</param>
+/// <returns>The step word (high count in the lower, low count in the upper 16 bits).</returns>
+uint32_t StepPlanner::encode(uint32_t period)
+{
+    uint32_t high = period / 2;
+    uint32_t low  = period - high;
+
+    high = (high > HIGH_OVERHEAD) ? high - HIGH_OVERHEAD : 0;
+    low  = (low > LOW_OVERHEAD) ? low - LOW_OVERHEAD : 0;
+
+    if (high > MAX_COUNT) high = MAX_COUNT;
+    if (low > MAX_COUNT) low = MAX_COUNT;
+
+    return high | (low << 16);
+}
+
+/// <summary>
+/// Decodes the step period from a step word (the number of PIO ticks the PIO program needs for the word).
+/// </summary>
+/// <param name="word">The step word.</param>
+/// <returns>The step period (PIO ticks).</returns>
+uint32_t StepPlanner::decode(uint32_t word)
+{
+    return (word & 0xFFFF) + HIGH_OVERHEAD + (word >> 16) + LOW_OVERHEAD;
+}
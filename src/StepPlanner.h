@@ -0,0 +1,65 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="StepPlanner.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 9:30 PM</created>
+// <modified>18-10-2026 9:30 PM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   The step train planner generating the (high ticks, low ticks) words for the PIO step generator.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "Fixed.h"
+
+/// <summary>
+/// This class plans a move as a train of step words, one word per step. Every word holds the number of
+/// PIO ticks the PUL output is high (lower 16 bits) and low (upper 16 bits), less the fixed instruction
+/// overhead of the PIO program (see StepTrain). The speed profile is the same as in the timer interrupt
+/// (LinearActuator::onTimer): the speed is increased by the speed delta for every step of the ramp,
+/// kept constant, and decreased again before the target is reached.
+///
+/// The speeds are fixed-point values (see Fixed.h), so no soft-float arithmetic is used per step.
+/// The planner only depends on the C standard library, so the words can be generated and checked on the
+/// host (i.e. against an emulation of the PIO program timing).
+/// </summary>
+class StepPlanner
+{
+public:
+    static constexpr const uint32_t  TICK_FREQUENCY = 10000000;  // The PIO tick frequency (10 MHz, 0.1 usec).
+    static constexpr const uint32_t  HIGH_OVERHEAD  = 2;         // The PIO ticks of the high phase not counted in the word.
+    static constexpr const uint32_t  LOW_OVERHEAD   = 3;         // The PIO ticks of the low phase not counted in the word.
+    static constexpr const uint32_t  MAX_COUNT      = 0xFFFF;    // The maximum (16 bit) tick count in a word.
+    static constexpr const StepSpeed MIN_SPEED      = StepSpeed::fromRaw((TICK_FREQUENCY << 8) / (2 * MAX_COUNT) + 1); // The minimum speed (about 76 steps/s).
+    static constexpr const StepSpeed MAX_SPEED      = StepSpeed::fromInt(250000); // The maximum speed (steps per second, 40 ticks per step).
+
+private:
+    long       _steps      = 0;                     // The total number of steps.
+    long       _rampsteps  = 0;                     // The number of steps for ramping.
+    StepSpeed  _minspeed;                           // The minimum speed (steps per second).
+    SpeedDelta _deltaspeed;                         // The speed delta for every step.
+    long       _n          = 0;                     // The number of planned steps.
+
+public:
+    void     begin(long steps, long rampsteps, StepSpeed minspeed, SpeedDelta deltaspeed); // Starts planning a move.
+    size_t   fill(uint32_t* words, size_t size);    // Fills the buffer with the next step words.
+
+    StepSpeed getSpeed(long n) const;                // Gets the speed at step n (steps per second).
+    uint32_t getPeriod(long n) const;               // Gets the step period at step n (PIO ticks).
+
+    static uint32_t toPeriod(StepSpeed speed);      // Gets the step period (PIO ticks) at the speed.
+    static uint32_t encode(uint32_t period);        // Encodes the step period (PIO ticks) as a step word.
+    static uint32_t decode(uint32_t word);          // Decodes the step period (PIO ticks) from a step word.
+
+    inline long getPlanned() const { return _n; }
+    inline long getRemaining() const { return _steps - _n; }
+    inline bool isDone() const { return _n >= _steps; }
+};
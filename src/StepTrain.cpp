@@ -0,0 +1,259 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="StepTrain.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 9:30 PM</created>
+// <modified>18-10-2026 9:30 PM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include <hardware/clocks.h>
+#include <hardware/irq.h>
+#include <hardware/pio_instructions.h>
+#include <hardware/sync.h>
+
+#include "StepTrain.h"
+
+/// <summary>
+/// The instance handling the DMA interrupt (only a single step train is supported).
+/// </summary>
+StepTrain* StepTrain::_instance = nullptr;
+
+/// <summary>
+/// Loads the PIO program (on the first PIO with a free state machine and enough instruction memory),
+/// configures the state machine and claims a DMA channel. The PIO program (side-set PUL, optional):
+///
+///     0:  pull block                  ; wait for the next step word (PUL stays low)
+///     1:  out x, 16       side 1      ; high count, PUL high
+///     2:  jmp x--, 2                  ; high phase (x + 2 ticks including the out)
+///     3:  out y, 16       side 0      ; low count, PUL low
+///     4:  jmp y--, 4                  ; low phase (y + 3 ticks including the out and the pull)
+///
+/// The words are shifted out to the right, so the high count is the lower half of the word.
+/// </summary>
+/// <param name="pin">The PUL pin number.</param>
+/// <param name="callback">The completed steps callback.</param>
+/// <returns>True if successful.</returns>
+bool StepTrain::init(uint8_t pin, Callback callback)
+{
+    _pin = pin;
+    _callback = callback;
+
+    uint16_t instructions[] = {
+        (uint16_t)(pio_encode_pull(false, true)),
+        (uint16_t)(pio_encode_out(pio_x, 16) | pio_encode_sideset_opt(1, 1)),
+        (uint16_t)(pio_encode_jmp_x_dec(2)),
+        (uint16_t)(pio_encode_out(pio_y, 16) | pio_encode_sideset_opt(1, 0)),
+        (uint16_t)(pio_encode_jmp_y_dec(4))
+    };
+
+    pio_program_t program = {};
+    program.instructions = instructions;
+    program.length = sizeof(instructions) / sizeof(instructions[0]);
+    program.origin = -1;
+
+    PIO instances[] = { pio0, pio1 };
+
+    for (PIO pio : instances)
+    {
+        if (!pio_can_add_program(pio, &program))
+            continue;
+
+        int sm = pio_claim_unused_sm(pio, false);
+
+        if (sm < 0)
+            continue;
+
+        _pio = pio;
+        _sm = sm;
+        _offset = pio_add_program(pio, &program);
+        break;
+    }
+
+    if (_sm < 0)
+        return false;
+
+    _dma = dma_claim_unused_channel(false);
+
+    if (_dma < 0)
+    {
+        pio_sm_unclaim(_pio, _sm);
+        _sm = -1;
+        return false;
+    }
+
+    // The state machine drives PUL using side-set (output, initially low).
+    pio_sm_config config = pio_get_default_sm_config();
+    sm_config_set_wrap(&config, _offset, _offset + program.length - 1);
+    sm_config_set_sideset(&config, 2, true, false);
+    sm_config_set_sideset_pins(&config, pin);
+    sm_config_set_out_shift(&config, true, false, 32);
+    sm_config_set_fifo_join(&config, PIO_FIFO_JOIN_TX);
+    sm_config_set_clkdiv(&config, float(clock_get_hz(clk_sys)) / float(StepPlanner::TICK_FREQUENCY));
+
+    pio_sm_set_pins_with_mask(_pio, _sm, 0, 1u << pin);
+    pio_sm_set_consecutive_pindirs(_pio, _sm, pin, 1, true);
+    pio_sm_init(_pio, _sm, _offset, &config);
+    pio_sm_set_enabled(_pio, _sm, true);
+
+    // The DMA channel writes the step words to the TX FIFO (paced by the FIFO).
+    dma_channel_config channel = dma_channel_get_default_config(_dma);
+    channel_config_set_transfer_data_size(&channel, DMA_SIZE_32);
+    channel_config_set_read_increment(&channel, true);
+    channel_config_set_write_increment(&channel, false);
+    channel_config_set_dreq(&channel, pio_get_dreq(_pio, _sm, true));
+    dma_channel_configure(_dma, &channel, &_pio->txf[_sm], nullptr, 0, false);
+
+    // Planning a buffer takes a while, so the safety input (GPIO) interrupt must be able to preempt it.
+    _instance = this;
+    dma_channel_set_irq0_enabled(_dma, true);
+    irq_add_shared_handler(DMA_IRQ_0, _dmaHandler, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+    irq_set_priority(DMA_IRQ_0, PICO_LOWEST_IRQ_PRIORITY);
+    irq_set_enabled(DMA_IRQ_0, true);
+
+    return true;
+}
+
+/// <summary>
+/// Connects the PUL pin to the PIO (the step train backend is used).
+/// </summary>
+void StepTrain::attach()
+{
+    if (isReady()) pio_gpio_init(_pio, _pin);
+}
+
+/// <summary>
+/// Connects the PUL pin to the GPIO output (the step timer interrupt backend is used).
+/// </summary>
+void StepTrain::detach()
+{
+    pinMode(_pin, OUTPUT);
+    digitalWrite(_pin, LOW);
+}
+
+/// <summary>
+/// Starts the step train. The first two buffers are planned before the transfer is started.
+/// </summary>
+/// <param name="steps">The total number of steps.</param>
+/// <param name="rampsteps">The number of steps for ramping.</param>
+/// <param name="minspeed">The minimum speed (steps per second).</param>
+/// <param name="deltaspeed">The speed delta for every step.</param>
+void StepTrain::start(long steps, long rampsteps, StepSpeed minspeed, SpeedDelta deltaspeed)
+{
+    if (!isReady())
+        return;
+
+    _planner.begin(steps, rampsteps, minspeed, deltaspeed);
+
+    _output = 0;
+    _active = 0;
+    _counts[0] = _planner.fill(_buffers[0], BUFFER_SIZE);
+    _counts[1] = _planner.fill(_buffers[1], BUFFER_SIZE);
+    _busy = (_counts[0] > 0);
+
+    if (_busy)
+    {
+        dma_channel_transfer_from_buffer_now(_dma, _buffers[0], _counts[0]);
+    }
+}
+
+/// <summary>
+/// Stops the step train immediately (interrupt safe). The state machine is stopped first, so no further
+/// pulse is output even if a preempted DMA interrupt restarts the transfer. PUL is set low, the FIFO is
+/// cleared, and the state machine is restarted waiting for the next step word.
+/// </summary>
+/// <returns>The number of steps output (a word being executed counts as output, as PUL went high).</returns>
+uint32_t StepTrain::abort()
+{
+    if (!isReady())
+        return 0;
+
+    pio_sm_set_enabled(_pio, _sm, false);
+    _busy = false;
+
+    dma_channel_set_irq0_enabled(_dma, false);
+    dma_channel_abort(_dma);
+    dma_channel_acknowledge_irq0(_dma);
+    dma_channel_set_irq0_enabled(_dma, true);
+
+    uint32_t transferred = _output + (_counts[_active] - dma_channel_hw_addr(_dma)->transfer_count);
+    uint32_t pending = pio_sm_get_tx_fifo_level(_pio, _sm);
+
+    pio_sm_clear_fifos(_pio, _sm);
+    pio_sm_restart(_pio, _sm);
+    pio_sm_exec(_pio, _sm, pio_encode_jmp(_offset));
+    pio_sm_set_pins_with_mask(_pio, _sm, 0, 1u << _pin);
+    pio_sm_set_enabled(_pio, _sm, true);
+
+    return transferred - pending;
+}
+
+/// <summary>
+/// Returns true if all planned steps have been output: no transfer is active, the FIFO is empty,
+/// and the state machine waits for the next word (the low phase of the last step has ended).
+/// </summary>
+bool StepTrain::isDone()
+{
+    if (!isReady())
+        return true;
+
+    return !_busy && pio_sm_is_tx_fifo_empty(_pio, _sm) && (pio_sm_get_pc(_pio, _sm) == _offset);
+}
+
+/// <summary>
+/// Handles a completed buffer transfer (DMA interrupt). The next buffer (already planned) is started
+/// first, then the completed steps are reported and the completed buffer is planned again.
+/// The bookkeeping is done with interrupts disabled, as the safety input interrupt may preempt this
+/// (lower priority) interrupt and call abort(). Note that the completed steps are still (partly)
+/// in the PIO FIFO (at most 8 words).
+/// </summary>
+void StepTrain::_onComplete()
+{
+    uint32_t status = save_and_disable_interrupts();
+
+    if (!_busy)
+    {
+        restore_interrupts(status);
+        return;
+    }
+
+    uint8_t done = _active;
+    uint8_t next = done ^ 1;
+    uint32_t steps = _counts[done];
+
+    _output += steps;
+    _counts[done] = 0;
+
+    if (_counts[next] > 0)
+    {
+        _active = next;
+        dma_channel_transfer_from_buffer_now(_dma, _buffers[next], _counts[next]);
+    }
+    else
+    {
+        _busy = false;
+    }
+
+    if (_callback != nullptr) _callback(steps);
+
+    restore_interrupts(status);
+
+    // Planning the buffer takes a while (the buffer is not used until the next buffer has completed).
+    size_t count = _planner.fill(_buffers[done], BUFFER_SIZE);
+    _counts[done] = count;
+}
+
+/// <summary>
+/// The shared DMA interrupt handler (only the step train channel is handled).
+/// </summary>
+void StepTrain::_dmaHandler()
+{
+    if ((_instance != nullptr) && dma_channel_get_irq0_status(_instance->_dma))
+    {
+        dma_channel_acknowledge_irq0(_instance->_dma);
+        _instance->_onComplete();
+    }
+}
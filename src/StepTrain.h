@@ -0,0 +1,76 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="StepTrain.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 9:30 PM</created>
+// <modified>19-10-2026 5:45 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   The PIO and DMA step train generator (an alternative to the step timer interrupt).
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+#include <hardware/pio.h>
+#include <hardware/dma.h>
+
+#include "StepPlanner.h"
+
+/// <summary>
+/// This class generates the PUL output using a PIO state machine fed by a DMA channel. The CPU only
+/// plans the step words (see StepPlanner) into two alternating buffers:
+///
+///     PIO program     - Pulls a step word, sets PUL high for the high count and low for the low count.
+///                       The state machine stalls (PUL low) if no more words are available.
+///     DMA channel     - Transfers a buffer to the PIO TX FIFO (paced by the FIFO DREQ).
+///     DMA interrupt   - Starts the next (already planned) buffer, reports the completed steps (callback),
+///                       and plans the following buffer into the completed one.
+///
+/// The step position is therefore updated once per buffer (BUFFER_SIZE steps), abort() returns the exact
+/// number of steps output so far. The 100 kHz step timer interrupt keeps running in this mode, where it
+/// only detects the end of the move (see isDone() and LinearActuator::_onTimer()).
+/// </summary>
+class StepTrain
+{
+public:
+    static constexpr const size_t BUFFER_SIZE = 256;    // The number of step words per buffer.
+
+    typedef void (*Callback)(uint32_t steps);           // The completed steps callback (called in the DMA interrupt).
+
+private:
+    PIO      _pio     = nullptr;                        // The PIO instance.
+    int      _sm      = -1;                             // The state machine.
+    uint     _offset  = 0;                              // The program offset in the PIO instruction memory.
+    int      _dma     = -1;                             // The DMA channel.
+    uint8_t  _pin     = 0;                              // The PUL pin.
+    Callback _callback = nullptr;                       // The completed steps callback.
+
+    StepPlanner       _planner;                         // The step train planner.
+    uint32_t          _buffers[2][BUFFER_SIZE];         // The step word buffers.
+    volatile size_t   _counts[2] = { 0, 0 };            // The number of words in the buffers.
+    volatile uint8_t  _active  = 0;                     // The buffer currently transferred.
+    volatile bool     _busy    = false;                 // Flag indicating that a buffer is transferred.
+    volatile uint32_t _output  = 0;                     // The number of words transferred by completed buffers.
+
+    static StepTrain* _instance;                        // The instance handling the DMA interrupt.
+    static void _dmaHandler();                          // The (shared) DMA interrupt handler.
+
+    void _onComplete();                                 // Handles a completed buffer transfer.
+
+public:
+    bool     init(uint8_t pin, Callback callback);      // Loads the PIO program and claims the DMA channel.
+    void     attach();                                  // Connects the PUL pin to the PIO.
+    void     detach();                                  // Connects the PUL pin to the GPIO output (SIO).
+
+    void     start(long steps, long rampsteps, StepSpeed minspeed, SpeedDelta deltaspeed); // Starts the step train.
+    uint32_t abort();                                   // Stops the step train, returns the steps output.
+    bool     isDone();                                  // True if all planned steps have been output.
+
+    inline bool      isReady() const { return _dma >= 0; }
+    inline StepSpeed getSpeed(long n) const { return _planner.getSpeed(n); }
+};
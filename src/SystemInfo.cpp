@@ -13,8 +13,25 @@
 #include <Arduino.h>
 
 #include "SystemInfo.h"
+#include "Wireless.h"
+#include "GpioInputs.h"
 #include "Version.h"
 
+/// <summary>
+/// The global JSON arena instance (see YardControl.ino).
+/// </summary>
+extern JsonArenaClass JsonArena;
+
+/// <summary>
+/// The global network instance (see YardControl.ino).
+/// </summary>
+extern Wireless Network;
+
+/// <summary>
+/// The global safety inputs instance (see YardControl.ino).
+/// </summary>
+extern GpioInputs Inputs;
+
 /// <summary>
 ///  Using the global RP2040 instance to get the actual data.
 /// </summary>
@@ -33,6 +50,17 @@ SystemInfo::SystemInfo()
 	HeapSize   = rp2040.getTotalHeap() / 1000;
 	FreeHeap   = rp2040.getFreeHeap() / 1000;
 	UsedHeap   = rp2040.getUsedHeap() / 1000;
+
+    ArenaSize     = JsonArenaClass::SIZE;
+    ArenaPeak     = JsonArena.getPeak();
+    ArenaFailures = JsonArena.getFailures();
+
+    NetworkState = Network.getStateName();
+    TimeSet      = Network.isTimeSet();
+
+    StopLatency    = Inputs.getStopLatency();
+    StopLatencyMax = Inputs.getMaxStopLatency();
+    Stops          = Inputs.getStops();
 }
 
 /// <summary>
@@ -43,17 +71,25 @@ String SystemInfo::toJsonString()
 {
     String json;
 
-    _doc.clear();
-    _doc["SystemTime"] = SystemTime;
-    _doc["Software"]   = Software;
-    _doc["BoardInfo"]  = BoardInfo;
-    _doc["BoardID"]    = BoardID;
-    _doc["BoardTemp"]  = BoardTemp;
-    _doc["CpuFreqMHz"] = CpuFreqMHz;
-    _doc["HeapSize"]   = HeapSize;
-    _doc["FreeHeap"]   = FreeHeap;
-    _doc["UsedHeap"]   = UsedHeap;
-    serializeJsonPretty(_doc, json);
+    JsonArenaDocument doc(JSON_SIZE);
+    doc["SystemTime"]    = SystemTime;
+    doc["Software"]      = Software;
+    doc["BoardInfo"]     = BoardInfo;
+    doc["BoardID"]       = BoardID;
+    doc["BoardTemp"]     = BoardTemp;
+    doc["CpuFreqMHz"]    = CpuFreqMHz;
+    doc["HeapSize"]      = HeapSize;
+    doc["FreeHeap"]      = FreeHeap;
+    doc["UsedHeap"]      = UsedHeap;
+    doc["ArenaSize"]     = ArenaSize;
+    doc["ArenaPeak"]     = ArenaPeak;
+    doc["ArenaFailures"] = ArenaFailures;
+    doc["NetworkState"]  = NetworkState;
+    doc["TimeSet"]       = TimeSet;
+    doc["StopLatency"]   = StopLatency;
+    doc["StopLatencyMax"] = StopLatencyMax;
+    doc["Stops"]         = Stops;
+    serializeJsonPretty(doc, json);
 
     return json;
 }
@@ -73,5 +109,8 @@ String SystemInfo::toString()
 	              "    CpuFreqMHz: " + CpuFreqMHz + "\r\n" +
 	              "    HeapSize:   " + HeapSize   + "\r\n" +
 	              "    FreeHeap:   " + FreeHeap   + "\r\n" +
-	              "    UsedHeap:   " + UsedHeap   + "\r\n";
+	              "    UsedHeap:   " + UsedHeap   + "\r\n" +
+	              "    ArenaSize:  " + ArenaSize  + " (peak " + ArenaPeak + ", failures " + ArenaFailures + ")\r\n" +
+	              "    Network:    " + NetworkState + (TimeSet ? " (time set)" : " (time not set)") + "\r\n" +
+	              "    Stops:      " + Stops      + " (latency " + StopLatency + " us, max " + StopLatencyMax + " us)\r\n";
 }
\ No newline at end of file
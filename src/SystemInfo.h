@@ -18,6 +18,8 @@
 
 #include <ArduinoJson.h>
 
+#include "JsonArena.h"
+
 #include "Version.h"
 
 /// <summary>
@@ -26,7 +28,7 @@
 class SystemInfo
 {
 private:
-    StaticJsonDocument<384> _doc; // The Json document representing the data.
+    static const size_t JSON_SIZE = 512; // The JSON document capacity (borrowed from the arena).
 
 public:
 	SystemInfo();							// Initialize the system info fields
@@ -40,6 +42,14 @@ public:
     int HeapSize;							// The total heap size in kB.
 	int FreeHeap;							// The amount of free heap kB.
 	int UsedHeap;							// The amount of used heap kB.
+    int ArenaSize;                          // The JSON arena size (bytes).
+    int ArenaPeak;                          // The maximum JSON arena usage (bytes).
+    int ArenaFailures;                      // The number of failed JSON arena allocations.
+    String NetworkState;                    // The network state (WiFi and NTP are started in the background).
+    bool   TimeSet;                         // Flag indicating that the time has been set by NTP.
+    int StopLatency;                        // The last safety input stop latency (microseconds).
+    int StopLatencyMax;                     // The maximum safety input stop latency (microseconds).
+    int Stops;                              // The number of moves stopped by a safety input interrupt.
 
     String toJsonString();                  // Get a serialized JSON representation.
     String toString();						// Get a string representation.
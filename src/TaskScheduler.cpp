@@ -0,0 +1,245 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="TaskScheduler.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 2:40 AM</created>
+// <modified>19-10-2026 3:25 AM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+#include "TaskScheduler.h"
+
+extern MetricsClass Metrics;
+
+/// <summary>
+/// The bucket upper bounds (microseconds) for the task run time.
+/// </summary>
+static const uint32_t TASK_BUCKETS[] = { 10, 50, 100, 250, 500, 1000, 2500, 10000, 50000, 100000 };
+
+/// <summary>
+/// Returns the text right aligned to the width.
+/// </summary>
+static String padLeft(const String& text, size_t width)
+{
+    String result;
+
+    while (result.length() + text.length() < width) result += " ";
+
+    return result + text;
+}
+
+/// <summary>
+/// Returns the task type name.
+/// </summary>
+static const char* getTypeName(const TaskScheduler::Task& task)
+{
+    return (task.Period == TaskScheduler::BACKGROUND) ? "Background" : (task.Period == TaskScheduler::EVENT) ? "Event" : "Periodic";
+}
+
+/// <summary>
+/// Checks if the task is ready to run: signaled, a periodic task due, or a background task not yet run in this pass.
+/// </summary>
+/// <param name="task">The task.</param>
+/// <param name="now">The current time (micros).</param>
+/// <returns>True if ready.</returns>
+bool TaskScheduler::_isReady(Task& task, uint32_t now)
+{
+    if (task.Signaled) return true;
+
+    switch (task.Period)
+    {
+    case BACKGROUND: return !task.Done;
+    case EVENT:      return false;
+    default:         return int32_t(now - task.Next) >= 0;
+    }
+}
+
+/// <summary>
+/// Runs the task and updates the statistics. A due periodic task is rescheduled (the next due time advances
+/// by the period). If the task is still due, it has missed periods and is rescheduled from now.
+/// </summary>
+/// <param name="task">The task.</param>
+/// <param name="now">The time the task has been selected (micros).</param>
+void TaskScheduler::_execute(Task& task, uint32_t now)
+{
+    task.Signaled = false;
+    task.Done = true;
+
+    if ((task.Period != BACKGROUND) && (task.Period != EVENT) && (int32_t(now - task.Next) >= 0))
+    {
+        task.Late = now - task.Next;
+        task.MaxLate = max(task.MaxLate, task.Late);
+        task.Next += task.Period;
+
+        if (int32_t(now - task.Next) >= 0)
+        {
+            task.Missed += (now - task.Next) / task.Period + 1;
+            task.Next = now + task.Period;
+        }
+    }
+
+    uint32_t start = micros();
+
+    task.Function();
+
+    uint32_t elapsed = micros() - start;
+
+    task.RunTime.observe(elapsed);
+    Profiler.record(task.Site, elapsed);
+
+    if ((task.Budget > 0) && (elapsed > task.Budget)) task.Overruns.inc();
+}
+
+/// <summary>
+/// Adds a task and its profiling site. A periodic task is due immediately.
+/// </summary>
+/// <param name="name">The task name (a constant string).</param>
+/// <param name="function">The task function.</param>
+/// <param name="priority">The priority (0 is highest).</param>
+/// <param name="period">The period (usec), BACKGROUND or EVENT.</param>
+/// <param name="budget">The time budget of a single run (usec, 0: none).</param>
+/// <returns>The task id (or -1 if no more tasks are available).</returns>
+int TaskScheduler::add(const char* name, TaskFunction function, uint8_t priority, uint32_t period, uint32_t budget)
+{
+    if ((_count >= MAX_TASKS) || (function == nullptr))
+    {
+        return -1;
+    }
+
+    Task& task = _tasks[_count];
+    task.Name     = name;
+    task.Function = function;
+    task.Priority = priority;
+    task.Period   = period;
+    task.Budget   = budget;
+    task.Next     = micros();
+    task.Site     = Profiler.add("task", name);
+    task.RunTime.init(TASK_BUCKETS, sizeof(TASK_BUCKETS) / sizeof(TASK_BUCKETS[0]));
+
+    return _count++;
+}
+
+/// <summary>
+/// Registers the run time histogram and the overrun counter of all tasks (labelled with the task name).
+/// </summary>
+void TaskScheduler::addMetrics()
+{
+    for (int i = 0; i < _count; i++)
+    {
+        Metrics.add("yard_task_seconds", "Task run time.", MetricType::Histogram,
+                    &_tasks[i].RunTime, "task", _tasks[i].Name);
+    }
+
+    for (int i = 0; i < _count; i++)
+    {
+        Metrics.add("yard_task_overruns_total", "Number of task runs exceeding the budget.", MetricType::Counter,
+                    &_tasks[i].Overruns, "task", _tasks[i].Name);
+    }
+}
+
+/// <summary>
+/// Runs a single pass: the ready task with the highest priority is run until no task is ready.
+/// This is called from the main loop.
+/// </summary>
+void TaskScheduler::run()
+{
+    for (int i = 0; i < _count; i++)
+    {
+        _tasks[i].Done = false;
+    }
+
+    while (true)
+    {
+        uint32_t now = micros();
+        int next = -1;
+
+        for (int i = 0; i < _count; i++)
+        {
+            if (_isReady(_tasks[i], now) && ((next < 0) || (_tasks[i].Priority < _tasks[next].Priority)))
+            {
+                next = i;
+            }
+        }
+
+        if (next < 0) break;
+
+        _execute(_tasks[next], now);
+    }
+
+    _passes++;
+}
+
+/// <summary>
+/// Returns a serialized JSON representation of the tasks and their run-time statistics (times in usec).
+/// </summary>
+/// <returns>The serialized JSON string.</returns>
+String TaskScheduler::toJsonString()
+{
+    String json;
+
+    JsonArenaDocument doc(JSON_SIZE);
+    doc["Passes"] = _passes;
+    JsonArray tasks = doc.createNestedArray("Tasks");
+
+    for (int i = 0; i < _count; i++)
+    {
+        const Task& task = _tasks[i];
+        uint32_t runs = task.RunTime.getCount();
+
+        JsonObject item = tasks.createNestedObject();
+        item["Name"]     = task.Name;
+        item["Type"]     = getTypeName(task);
+        item["Priority"] = task.Priority;
+        item["Period"]   = ((task.Period == BACKGROUND) || (task.Period == EVENT)) ? 0 : task.Period;
+        item["Budget"]   = task.Budget;
+        item["Runs"]     = runs;
+        item["Average"]  = (runs > 0) ? uint32_t(task.RunTime.getSum() / runs) : 0;
+        item["Max"]      = task.RunTime.getMax();
+        item["Overruns"] = task.Overruns.get();
+        item["Missed"]   = task.Missed;
+        item["MaxLate"]  = task.MaxLate;
+    }
+
+    serializeJsonPretty(doc, json);
+
+    return json;
+}
+
+/// <summary>
+/// Returns a printable string representation of the tasks and their run-time statistics (times in usec).
+/// Tasks with overruns are flagged ('!').
+/// </summary>
+/// <returns>The printable string.</returns>
+String TaskScheduler::toString()
+{
+    String text = String("Tasks (") + _passes + " passes, times in usec):\r\n" +
+                  "    Name        Prio    Period  Budget      Runs   Avg     Max  Overruns  Missed  MaxLate\r\n";
+
+    for (int i = 0; i < _count; i++)
+    {
+        const Task& task = _tasks[i];
+        uint32_t runs = task.RunTime.getCount();
+        uint32_t overruns = task.Overruns.get();
+
+        String name = String(overruns > 0 ? "!" : " ") + task.Name;
+
+        while (name.length() < 12) name += " ";
+
+        String period = (task.Period == BACKGROUND) ? "bg" : (task.Period == EVENT) ? "event" : String(task.Period);
+
+        text += String("   ") + name +
+                padLeft(String(task.Priority), 5) +
+                padLeft(period, 10) +
+                padLeft(String(task.Budget), 8) +
+                padLeft(String(runs), 10) +
+                padLeft(String((runs > 0) ? uint32_t(task.RunTime.getSum() / runs) : 0), 6) +
+                padLeft(String(task.RunTime.getMax()), 8) +
+                padLeft(String(overruns), 10) +
+                padLeft(String(task.Missed), 8) +
+                padLeft(String(task.MaxLate), 9) + "\r\n";
+    }
+
+    return text;
+}
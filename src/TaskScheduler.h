@@ -0,0 +1,96 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="TaskScheduler.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 2:40 AM</created>
+// <modified>19-10-2026 3:25 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   A small cooperative scheduler running the main loop tasks by priority with per-task time budgets.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "Metrics.h"
+#include "Profiler.h"
+#include "JsonArena.h"
+
+/// <summary>
+/// This class runs the main loop tasks (cooperative, a task always runs to completion). A task is either
+///
+///     periodic        - Runs every Period microseconds (the next due time advances by the period).
+///     background      - Runs once per pass (Period = BACKGROUND), i.e. the network services.
+///     event           - Runs only when signaled (Period = EVENT), i.e. from an interrupt.
+///
+/// A periodic task may also be signaled to run before it is due. Every pass (see run()) repeatedly selects
+/// the ready task with the highest priority (0 is highest, ties in the order added), so the due periodic
+/// tasks run between two background tasks. The switch and motion supervision is therefore delayed by a
+/// single background task at most, regardless of the network load. The pass ends when no task is ready.
+///
+/// A run exceeding the task budget is flagged (overrun). A periodic task starting more than a period late
+/// is rescheduled from now (the missed periods are counted). The run time of every task is recorded in a
+/// histogram (exported as a metric).
+/// </summary>
+class TaskScheduler
+{
+public:
+    static const int      MAX_TASKS  = 12;          // The maximum number of tasks.
+    static const uint32_t BACKGROUND = 0;           // The period of a background task (once per pass).
+    static const uint32_t EVENT      = UINT32_MAX;  // The period of an event task (only when signaled).
+
+    typedef void (*TaskFunction)();
+
+    /// <summary>
+    /// A task and its run-time statistics.
+    /// </summary>
+    struct Task
+    {
+        const char*   Name     = "";                // The task name.
+        TaskFunction  Function = nullptr;           // The task function.
+        uint8_t       Priority = 0;                 // The priority (0 is highest).
+        uint32_t      Period   = BACKGROUND;        // The period (usec, BACKGROUND or EVENT).
+        uint32_t      Budget   = 0;                 // The time budget of a single run (usec, 0: none).
+        volatile bool Signaled = false;             // Flag indicating that the task has been signaled.
+        uint32_t      Next     = 0;                 // The next due time (micros, periodic tasks).
+        bool          Done     = false;             // Flag indicating that the task has run in this pass.
+        Histogram     RunTime;                      // The run time (usec, the count is the number of runs).
+        Counter       Overruns;                     // The number of runs exceeding the budget.
+        uint32_t      Missed   = 0;                 // The number of missed periods.
+        uint32_t      Late     = 0;                 // The last start delay after the due time (usec).
+        uint32_t      MaxLate  = 0;                 // The maximum start delay after the due time (usec).
+        int           Site     = -1;                // The profiling site.
+    };
+
+private:
+    static const size_t JSON_SIZE = JSON_OBJECT_SIZE(2) + JSON_ARRAY_SIZE(MAX_TASKS) + MAX_TASKS * JSON_OBJECT_SIZE(12);
+
+    Task     _tasks[MAX_TASKS];                     // The registered tasks.
+    int      _count    = 0;                         // The number of registered tasks.
+    uint32_t _passes   = 0;                         // The number of passes.
+
+    bool _isReady(Task& task, uint32_t now);        // Checks if the task is ready to run.
+    void _execute(Task& task, uint32_t now);        // Runs the task and updates the statistics.
+
+public:
+    int  add(const char* name, TaskFunction function, uint8_t priority, uint32_t period, uint32_t budget);
+    void addMetrics();                              // Registers the run time and overrun metrics of all tasks.
+    void run();                                     // Runs a single pass (main loop).
+
+    /// <summary>
+    /// Signals a task to run (in the current or the next pass). This may be called from an interrupt.
+    /// </summary>
+    inline void signal(int id) { if ((id >= 0) && (id < _count)) _tasks[id].Signaled = true; }
+
+    inline int         getCount() const { return _count; }
+    inline const Task& getTask(int id) const { return _tasks[id]; }
+    inline uint32_t    getPasses() const { return _passes; }
+
+    String toJsonString();                          // Get a serialized JSON representation.
+    String toString();                              // Get a string representation.
+};
@@ -24,20 +24,20 @@
 
 TelnetBase::TelnetBase()
 {
-    connected = false;
+    current = -1;
 }
 
 /////////////////////////////////////////////////////////////////
 
-bool TelnetBase::begin(uint16_t port /* = 23 */, bool checkConnection /* = true */)
+bool TelnetBase::begin(uint16_t port /* = 23 */, uint8_t sessions /* = 1 */, bool checkConnection /* = true */)
 {
-    ip = "";
     if (checkConnection)
     {
         // connected to WiFi or is RP2040 in AP mode?
         if (WiFi.status() != WL_CONNECTED && !_isIPSet(WiFi.softAPIP()))
             return false;
     }
+    max_sessions = constrain(sessions, 1, MAX_TELNET_SESSIONS);
     server_port = port;
     server = TCPServer(port);
     server.begin();
@@ -52,50 +52,121 @@ void TelnetBase::loop()
     // is there a new client wating?
     if (server.hasClient())
     {
-        // no exisintg connection?
-        if (!connected)
+        acceptClient();
+    }
+
+    // frequently check if the clients are still alive
+    bool check = doKeepAliveCheckNow();
+
+    // service every session once (round-robin, the first session changes with every loop)
+    for (int n = 0; n < max_sessions; n++)
+    {
+        int i = (next + n) % max_sessions;
+
+        if (sessions[i].state == IDLE)
+            continue;
+
+        if (check && !isConnected(i))
+        {
+            disconnectSession(i);
+            continue;
+        }
+
+        serviceSession(i);
+
+        // write the buffered output (only as much as the client accepts)
+        if (sessions[i].state != IDLE)
+        {
+            sessions[i].output.drainTo(sessions[i].client);
+        }
+    }
+
+    next = (next + 1) % max_sessions;
+}
+
+/////////////////////////////////////////////////////////////////
+
+void TelnetBase::acceptClient()
+{
+    TCPClient newClient = server.accept();
+    attemptIp = newClient.remoteIP().toString();
+
+    int idle = -1;
+    int stale = -1;
+
+    for (int i = 0; i < max_sessions; i++)
+    {
+        if (sessions[i].state == IDLE)
         {
-            connectClient(server.accept());
+            if (idle < 0)
+                idle = i;
         }
-        else
+        else if (!isConnected(i))
         {
-            if (!isConnected())
-            {
-                disconnectClient();
-                return;
-            }
-            TCPClient newClient = server.accept();
-            attemptIp = newClient.remoteIP().toString();
-            // yes, reconnected
-            if (attemptIp == ip)
-            {
-                disconnectClient(false);
-                connectClient(newClient, false);
-                if (on_reconnect != NULL)
-                    on_reconnect(attemptIp);
-                // no, throw error
-            }
-            else
-            {
-                if (on_connection_attempt != NULL)
-                    on_connection_attempt(attemptIp);
-            }
+            // prefer a stale session from the same client (reconnect)
+            if ((stale < 0) || (sessions[i].ip == attemptIp))
+                stale = i;
+        }
+    }
+
+    if (idle >= 0)
+    {
+        connectClient(idle, newClient);
+    }
+    else if (stale >= 0)
+    {
+        // yes, reconnected
+        bool reconnect = (sessions[stale].ip == attemptIp);
+        disconnectSession(stale, !reconnect);
+        connectClient(stale, newClient, !reconnect);
+        if (reconnect && on_reconnect != NULL)
+        {
+            current = stale;
+            on_reconnect(attemptIp);
+            current = -1;
         }
     }
     else
     {
-        // frequently check if client is still alive
-        if (doKeepAliveCheckNow() && connected && !isConnected())
+        // no, all sessions in use - reject the client
+        newClient.print("Too many telnet sessions - try again later.\r\n");
+        newClient.stop();
+        if (on_connection_attempt != NULL)
+            on_connection_attempt(attemptIp);
+    }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void TelnetBase::serviceSession(int session)
+{
+    Session &s = sessions[session];
+    current = session;
+
+    switch (s.state)
+    {
+    case DRAINING:
+        // discard the initial input until the drain interval has passed
+        discardInput(session);
+        if (millis() - s.state_since >= DRAIN_INTERVAL_MS)
         {
-            disconnectClient();
+            s.state = ACTIVE;
         }
-        // check for input
-        if (on_input != NULL && client && client.available())
+        break;
+
+    case ACTIVE:
+        // check for input (held until the paged output of the last command has been written)
+        if (on_input != NULL && s.client && !s.output.isPaging() && s.client.available())
         {
             handleInput();
         }
+        break;
+
+    default:
+        break;
     }
-    yield();
+
+    current = -1;
 }
 
 /////////////////////////////////////////////////////////////////
@@ -127,27 +198,64 @@ int TelnetBase::getKeepAliveInterval()
 
 /////////////////////////////////////////////////////////////////
 
-void TelnetBase::connectClient(WiFiClient c, bool triggerEvent)
+void TelnetBase::connectClient(int session, WiFiClient c, bool triggerEvent)
 {
-    client = c;
-    ip = client.remoteIP().toString();
-    client.setNoDelay(true);
+    Session &s = sessions[session];
+    s.client = c;
+    s.ip = s.client.remoteIP().toString();
+    s.client.setNoDelay(true);
+    s.state = DRAINING;
+    s.state_since = millis();
+    s.context.reset();
+    s.output.clear();
+
+    int previous = current;
+    current = session;
+    clearInput();
     if (triggerEvent && on_connect != NULL)
-        on_connect(ip);
-    emptyClientStream();
-    connected = true;
+        on_connect(s.ip);
+    current = previous;
 }
 
 /////////////////////////////////////////////////////////////////
 
-void TelnetBase::disconnectClient(bool triggerEvent)
+void TelnetBase::disconnectSession(int session, bool triggerEvent)
 {
-    emptyClientStream();
-    client.stop();
+    Session &s = sessions[session];
+    if (s.state == IDLE)
+        return;
+
+    discardInput(session);
+    s.output.drainTo(s.client);
+    s.output.clear();
+    s.client.stop();
+    s.state = IDLE;
+    s.state_since = millis();
+
+    int previous = current;
+    current = session;
     if (triggerEvent && on_disconnect != NULL)
-        on_disconnect(ip);
-    ip = "";
-    connected = false;
+        on_disconnect(s.ip);
+    current = previous;
+
+    s.ip = "";
+}
+
+/////////////////////////////////////////////////////////////////
+// disconnects the current session (or all sessions if called outside of a callback)
+
+void TelnetBase::disconnectClient(bool triggerEvent)
+{
+    if (current >= 0)
+    {
+        disconnectSession(current, triggerEvent);
+        return;
+    }
+
+    for (int i = 0; i < max_sessions; i++)
+    {
+        disconnectSession(i, triggerEvent);
+    }
 }
 
 /////////////////////////////////////////////////////////////////
@@ -164,17 +272,25 @@ bool TelnetBase::_isIPSet(IPAddress ip)
 }
 
 /////////////////////////////////////////////////////////////////
+// disconnects all sessions (the disconnect events keep the session state and counters
+// consistent) before the server is stopped
 
 void TelnetBase::stop()
 {
+    for (int i = 0; i < max_sessions; i++)
+    {
+        disconnectSession(i, true);
+    }
+
     server.stop();
 }
 
 /////////////////////////////////////////////////////////////////
 
-bool TelnetBase::isConnected()
+bool TelnetBase::isConnected(int session)
 {
     bool res;
+    TCPClient &client = sessions[session].client;
 #if defined(ARDUINO_ARCH_ESP8266)
     res = client.status() == ESTABLISHED;
 #elif defined(ARDUINO_ARCH_ESP32)
@@ -185,11 +301,49 @@ bool TelnetBase::isConnected()
     return res;
 }
 
+/////////////////////////////////////////////////////////////////
+// is the current session (or any session if called outside of a callback) connected?
+
+bool TelnetBase::isConnected()
+{
+    if (current >= 0)
+    {
+        return (sessions[current].state != IDLE) && isConnected(current);
+    }
+
+    for (int i = 0; i < max_sessions; i++)
+    {
+        if ((sessions[i].state != IDLE) && isConnected(i))
+            return true;
+    }
+
+    return false;
+}
+
+/////////////////////////////////////////////////////////////////
+// should the session receive output (current session or all connected sessions)?
+
+bool TelnetBase::isTarget(int session)
+{
+    if ((current >= 0) && (session != current))
+        return false;
+
+    Session &s = sessions[session];
+    return (s.state != IDLE) && s.client && isConnected(session);
+}
+
+/////////////////////////////////////////////////////////////////
+
+TCPClient &TelnetBase::getClient()
+{
+    return sessions[(current >= 0) ? current : 0].client;
+}
+
 /////////////////////////////////////////////////////////////////
 
 String TelnetBase::getIP() const
 {
-    return ip;
+    return (current >= 0) ? sessions[current].ip : String("");
 }
 
 /////////////////////////////////////////////////////////////////
@@ -201,13 +355,71 @@ String TelnetBase::getLastAttemptIP() const
 
 /////////////////////////////////////////////////////////////////
 
-void TelnetBase::emptyClientStream()
+int TelnetBase::getSession() const
 {
-    client.flush();
-    delay(50);
-    while (client.available())
+    return current;
+}
+
+/////////////////////////////////////////////////////////////////
+// selects the current session (-1: none), returns true if the session is connected
+
+bool TelnetBase::selectSession(int session)
+{
+    if ((session < 0) || (session >= max_sessions))
     {
-        client.read();
+        current = -1;
+        return false;
+    }
+
+    current = session;
+    return sessions[session].state != IDLE;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t TelnetBase::getMaxSessions() const
+{
+    return max_sessions;
+}
+
+/////////////////////////////////////////////////////////////////
+
+uint8_t TelnetBase::getSessionCount() const
+{
+    uint8_t count = 0;
+    for (int i = 0; i < max_sessions; i++)
+    {
+        if (sessions[i].state != IDLE)
+            ++count;
+    }
+    return count;
+}
+
+/////////////////////////////////////////////////////////////////
+
+TelnetBase::ConnectionState TelnetBase::getState(int session) const
+{
+    return sessions[session].state;
+}
+
+/////////////////////////////////////////////////////////////////
+
+UserContext &TelnetBase::getContext(int session)
+{
+    return sessions[session].context;
+}
+
+/////////////////////////////////////////////////////////////////
+// discards the currently available input (never waits for more input)
+
+void TelnetBase::discardInput(int session)
+{
+    TCPClient &client = sessions[session].client;
+    uint8_t buffer[64];
+    while (client.available() > 0)
+    {
+        if (client.read(buffer, sizeof(buffer)) <= 0)
+            break;
     }
 }
 
@@ -247,5 +459,3 @@ void TelnetBase::onInputReceived(CallbackFunction f)
 }
 
 /////////////////////////////////////////////////////////////////
-
-
@@ -29,6 +29,8 @@
 #define ASCII_LF 10
 #define ASCII_CR 13
 #define KEEP_ALIVE_INTERVAL_MS 1000
+#define DRAIN_INTERVAL_MS 50
+#define MAX_TELNET_SESSIONS 4
 
 /////////////////////////////////////////////////////////////////
 
@@ -47,6 +49,8 @@
 /////////////////////////////////////////////////////////////////
 
 #include "DebugMacros.h"
+#include "UserContext.h"
+#include "OutputBuffer.h"
 
 /////////////////////////////////////////////////////////////////
 
@@ -54,14 +58,29 @@ using TCPClient = WiFiClient;
 using TCPServer = WiFiServer;
 
 /////////////////////////////////////////////////////////////////
+// Up to MAX_TELNET_SESSIONS clients can be connected at the same time. The sessions are
+// serviced round-robin. While a callback is running the session is the "current" session,
+// output (and disconnectClient) applies to the current session only. Outside of a callback
+// output is sent to all connected sessions. The output is buffered per session and
+// written once per loop (non-blocking, see OutputBuffer). A response larger than the
+// buffer is paged (see page()), the input of the session is held until it is written.
+
 class TelnetBase
 {
     typedef void (*CallbackFunction)(String str);
 
 public:
+    // The connection state (no blocking delays - timeouts are checked using millis()).
+    enum ConnectionState
+    {
+        IDLE,       // No client connected.
+        DRAINING,   // Client connected, discarding the initial (telnet negotiation) input.
+        ACTIVE      // Client connected, input is processed.
+    };
+
     TelnetBase();
 
-    bool begin(uint16_t port = 23, bool checkConnection = true);
+    bool begin(uint16_t port = 23, uint8_t sessions = 1, bool checkConnection = true);
     void stop();
     void loop();
 
@@ -74,6 +93,13 @@ public:
     String getIP() const;
     String getLastAttemptIP() const;
 
+    int getSession() const;
+    bool selectSession(int session);
+    uint8_t getMaxSessions() const;
+    uint8_t getSessionCount() const;
+    ConnectionState getState(int session) const;
+    UserContext &getContext(int session);
+
     void onConnect(CallbackFunction f);
     void onConnectionAttempt(CallbackFunction f);
     void onReconnect(CallbackFunction f);
@@ -81,12 +107,22 @@ public:
     void onInputReceived(CallbackFunction f);
 
 protected:
+    struct Session
+    {
+        TCPClient client;
+        ConnectionState state = IDLE; // needed because I cannot do "client = NULL"
+        unsigned long state_since = 0;
+        String ip = "";
+        UserContext context;
+        OutputBuffer output;
+    };
+
     TCPServer server = TCPServer(23); // must be initalized here
-    TCPClient client;
-    bool connected = false; // needed because I cannot do "client = NULL"
-    String ip = "";
+    Session sessions[MAX_TELNET_SESSIONS];
+    uint8_t max_sessions = 1;
+    int current = -1; // the session being serviced (-1: none)
+    int next = 0;     // the first session serviced in the next loop (round-robin)
     String attemptIp;
-    String input = "";
 
     uint16_t server_port = 23;
     int keep_alive_interval = KEEP_ALIVE_INTERVAL_MS;
@@ -98,17 +134,22 @@ protected:
     CallbackFunction on_connection_attempt = NULL;
     CallbackFunction on_input = NULL;
 
-    void emptyClientStream();
+    TCPClient &getClient();
+    bool isTarget(int session);
+    bool isConnected(int session);
+    void discardInput(int session);
     bool _isIPSet(IPAddress ip);
     virtual void handleInput() = 0;
+    virtual void clearInput() {}
 
 private:
-    void connectClient(TCPClient c, bool triggerEvent = true);
+    void acceptClient();
+    void serviceSession(int session);
+    void connectClient(int session, TCPClient c, bool triggerEvent = true);
+    void disconnectSession(int session, bool triggerEvent = true);
     bool doKeepAliveCheckNow();
 };
 
 /////////////////////////////////////////////////////////////////
 #endif
 /////////////////////////////////////////////////////////////////
-
-
@@ -24,63 +24,116 @@
 
 void TelnetServer::handleInput()
 {
-    char c = client.read();
-    // collect string
-    if (_lineMode)
+    uint8_t buffer[READ_SIZE];
+    int session = current;
+    TCPClient &client = sessions[session].client;
+    LineBuffer &line = _lines[session];
+
+    // Drain all available input in bulk and dispatch every complete line in the same pass.
+    // Further input is held while a command output is paged.
+    while ((sessions[session].state == ACTIVE) && !sessions[session].output.isPaging() && client.available())
     {
-        if (c != '\n')
+        int count = client.read(buffer, sizeof(buffer));
+
+        if (count <= 0)
+            break;
+
+        for (int i = 0; (i < count) && (sessions[session].state == ACTIVE); i++)
         {
-            if (c >= 32 && c < 127)
+            char c = (char)buffer[i];
+
+            // send individual characters
+            if (!_lineMode)
             {
-                input += c;
+                on_input(String(c));
+                continue;
             }
-            // Respond to backspace.
-            if (c == 8)
+
+            switch (line.add(c))
             {
-                input.remove(input.length() - 1);
-                client.write(' ');
-                client.write(8);
+            case LineBuffer::ERASED:
+                // Respond to backspace.
+                sessions[session].output.write(' ');
+                sessions[session].output.write(ASCII_BACKSPACE);
+                break;
+
+            case LineBuffer::COMPLETE:
+                // EOL -> send input
+                on_input(String(line.get()));
+                line.clear();
+                break;
+
+            case LineBuffer::TOO_LONG:
+                // Reject the line (an empty input just shows the prompt again).
+                sessions[session].output.printf("Input line too long (max. %u characters) - ignored.\r\n", (unsigned)LineBuffer::SIZE);
+                on_input("");
+                break;
+
+            default:
+                break;
             }
-            // EOL -> send input
         }
-        else
-        {
-            on_input(input);
-            input = "";
-        }
-        // send individual characters
     }
-    else
+}
+
+/////////////////////////////////////////////////////////////////
+
+void TelnetServer::clearInput()
+{
+    if (current >= 0)
     {
-        if (input.length())
+        _lines[current].clear();
+    }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void TelnetServer::print(const char c)
+{
+    for (int i = 0; i < max_sessions; i++)
+    {
+        if (isTarget(i))
         {
-            on_input(input + String(c));
-            input = "";
+            sessions[i].output.print(c);
         }
-        else
+    }
+}
+
+/////////////////////////////////////////////////////////////////
+
+void TelnetServer::print(const String &str)
+{
+    for (int i = 0; i < max_sessions; i++)
+    {
+        if (isTarget(i))
         {
-            on_input(String(c));
+            sessions[i].output.print(str);
         }
     }
 }
 
 /////////////////////////////////////////////////////////////////
+// pages the text (a response larger than the output buffer, see OutputBuffer)
 
-void TelnetServer::print(const char c)
+void TelnetServer::page(const String &str)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.print(c);
+        if (isTarget(i))
+        {
+            sessions[i].output.page(str);
+        }
     }
 }
 
 /////////////////////////////////////////////////////////////////
+// pages the output of the source (the current session only, a source is read once)
 
-void TelnetServer::print(const String &str)
+void TelnetServer::page(OutputBuffer::Source source)
 {
-    if (client && isConnected())
+    if ((current >= 0) && isTarget(current))
     {
-        client.print(str);
+        sessions[current].output.page(source);
     }
 }
 
@@ -88,9 +141,12 @@ void TelnetServer::print(const String &str)
 
 void TelnetServer::println(const String &str)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.println(str);
+        if (isTarget(i))
+        {
+            sessions[i].output.println(str);
+        }
     }
 }
 
@@ -98,9 +154,12 @@ void TelnetServer::println(const String &str)
 
 void TelnetServer::println(const char c)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.println(c);
+        if (isTarget(i))
+        {
+            sessions[i].output.println(c);
+        }
     }
 }
 
@@ -108,9 +167,12 @@ void TelnetServer::println(const char c)
 
 void TelnetServer::println()
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.println();
+        if (isTarget(i))
+        {
+            sessions[i].output.println();
+        }
     }
 }
 
@@ -118,9 +180,12 @@ void TelnetServer::println()
 
 void TelnetServer::print(unsigned char b, int base)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.print(b, base);
+        if (isTarget(i))
+        {
+            sessions[i].output.print(b, base);
+        }
     }
 }
 
@@ -128,9 +193,12 @@ void TelnetServer::print(unsigned char b, int base)
 
 void TelnetServer::println(unsigned char b, int base)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.println(b, base);
+        if (isTarget(i))
+        {
+            sessions[i].output.println(b, base);
+        }
     }
 }
 
@@ -138,9 +206,12 @@ void TelnetServer::println(unsigned char b, int base)
 
 void TelnetServer::print(const Printable &x)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.print(x);
+        if (isTarget(i))
+        {
+            sessions[i].output.print(x);
+        }
     }
 }
 
@@ -148,9 +219,12 @@ void TelnetServer::print(const Printable &x)
 
 void TelnetServer::println(const Printable &x)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.println(x);
+        if (isTarget(i))
+        {
+            sessions[i].output.println(x);
+        }
     }
 }
 
@@ -158,9 +232,12 @@ void TelnetServer::println(const Printable &x)
 
 void TelnetServer::print(unsigned int n, int base)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.print(n, base);
+        if (isTarget(i))
+        {
+            sessions[i].output.print(n, base);
+        }
     }
 }
 
@@ -168,9 +245,12 @@ void TelnetServer::print(unsigned int n, int base)
 
 void TelnetServer::println(unsigned int n, int base)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.println(n, base);
+        if (isTarget(i))
+        {
+            sessions[i].output.println(n, base);
+        }
     }
 }
 
@@ -178,9 +258,12 @@ void TelnetServer::println(unsigned int n, int base)
 
 void TelnetServer::print(int n, int base)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.print(n, base);
+        if (isTarget(i))
+        {
+            sessions[i].output.print(n, base);
+        }
     }
 }
 
@@ -188,9 +271,12 @@ void TelnetServer::print(int n, int base)
 
 void TelnetServer::println(int n, int base)
 {
-    if (client && isConnected())
+    for (int i = 0; i < max_sessions; i++)
     {
-        client.println(n, base);
+        if (isTarget(i))
+        {
+            sessions[i].output.println(n, base);
+        }
     }
 }
 
@@ -199,7 +285,7 @@ void TelnetServer::println(int n, int base)
 size_t TelnetServer::printf(const char *format, ...)
 {
     int len = 0;
-    if (client && isConnected())
+    if (isConnected())
     {
         char loc_buf[64];
         char *temp = loc_buf;
@@ -225,7 +311,13 @@ size_t TelnetServer::printf(const char *format, ...)
             len = vsnprintf(temp, len + 1, format, arg);
         }
         va_end(arg);
-        len = client.write((uint8_t *)temp, len);
+        for (int i = 0; i < max_sessions; i++)
+        {
+            if (isTarget(i))
+            {
+                sessions[i].output.write((uint8_t *)temp, len);
+            }
+        }
         if (temp != loc_buf)
         {
             free(temp);
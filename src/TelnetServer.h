@@ -25,6 +25,7 @@
 /////////////////////////////////////////////////////////////////
 
 #include "TelnetBase.h"
+#include "LineBuffer.h"
 
 /////////////////////////////////////////////////////////////////
 
@@ -34,6 +35,8 @@ public:
     using TelnetBase::TelnetBase;
 
     void print(const String &str);
+    void page(const String &str);
+    void page(OutputBuffer::Source source);
     void println(const String &str);
     void print(const char c);
     void println(const char c);
@@ -51,10 +54,14 @@ public:
     bool isLineModeSet();
     void setLineMode(bool value = true);
 
+    static const size_t READ_SIZE = 64;             // The number of bytes read from the client at once.
+
 protected:
     bool _lineMode = true;
+    LineBuffer _lines[MAX_TELNET_SESSIONS];         // The (fixed size) input line buffer per session.
 
     void handleInput();
+    void clearInput();
 };
 
 /////////////////////////////////////////////////////////////////
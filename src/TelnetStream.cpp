@@ -24,7 +24,7 @@
 
 void TelnetStream::handleInput()
 {
-    char c = client.read();
+    char c = getClient().read();
     on_input(String(c));
 }
 
@@ -32,9 +32,9 @@ void TelnetStream::handleInput()
 
 int TelnetStream::available()
 {
-    if (client && isConnected())
+    if (getClient() && isConnected())
     {
-        return client.available();
+        return getClient().available();
     }
     else
     {
@@ -46,9 +46,9 @@ int TelnetStream::available()
 
 int TelnetStream::read()
 {
-    if (client && isConnected())
+    if (getClient() && isConnected())
     {
-        return client.read();
+        return getClient().read();
     }
     else
     {
@@ -60,9 +60,9 @@ int TelnetStream::read()
 
 int TelnetStream::peek()
 {
-    if (client && isConnected())
+    if (getClient() && isConnected())
     {
-        return client.peek();
+        return getClient().peek();
     }
     else
     {
@@ -74,9 +74,9 @@ int TelnetStream::peek()
 
 void TelnetStream::flush()
 {
-    if (client && isConnected())
+    if (getClient() && isConnected())
     {
-        client.flush();
+        getClient().flush();
     }
 }
 
@@ -84,9 +84,9 @@ void TelnetStream::flush()
 
 size_t TelnetStream::write(uint8_t data)
 {
-    if (client && isConnected())
+    if (getClient() && isConnected())
     {
-        return client.write(data);
+        return getClient().write(data);
     }
     else
     {
@@ -0,0 +1,762 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="TrackPlanner.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 1:10 AM</created>
+// <modified>19-10-2026 5:30 AM</modified>
+// <author>Peter Trimmel</author>
+// --------------------------------------------------------------------------------------------------------------------
+#include <ArduinoJson.h>
+#include <algorithm>
+#include <memory>
+#include <new>
+
+#include "TrackPlanner.h"
+#include "JsonArena.h"
+
+// Externals (globals).
+extern AppSettings Settings;
+extern LinearActuator Actuator;
+
+static_assert(TrackPlanner::BATCH <= 256, "The batch order is an 8 bit index.");
+static_assert(TrackPlanner::MAX_EXACT <= 16, "The exact planner state table grows with 2^n.");
+
+static constexpr const uint8_t DIR_CW  = 0;         // The direction index of a move to a higher position.
+static constexpr const uint8_t DIR_CCW = 1;         // The direction index of a move to a lower position.
+
+/// <summary>
+/// Gets the time of a move including the direction delay, and updates the direction. A move without
+/// steps (same position, or too small to be started) does not change the direction.
+/// </summary>
+/// <param name="time">The move time (usec).</param>
+/// <param name="from">The start position (steps).</param>
+/// <param name="to">The target position (steps).</param>
+/// <param name="dir">The direction index before the move (updated).</param>
+/// <returns>The move time including the direction delay (usec).</returns>
+static uint32_t getLegTime(uint32_t time, long from, long to, uint8_t& dir)
+{
+    uint8_t next = (time == 0) ? dir : (to > from) ? DIR_CW : DIR_CCW;
+    uint32_t delay = (next != dir) ? TrackPlanner::DIR_DELAY : 0;
+
+    dir = next;
+
+    return time + delay;
+}
+
+/// <summary>
+/// Formats a time (usec) in seconds (three decimals) padded to the width.
+/// </summary>
+/// <param name="time">The time (usec).</param>
+/// <param name="width">The minimum width.</param>
+/// <returns>The formatted time.</returns>
+static String formatSeconds(uint32_t time, size_t width)
+{
+    String text = String(time / 1000000.0f, 3);
+
+    while (text.length() < width) text = String(" ") + text;
+
+    return text;
+}
+
+/// <summary>
+/// Calculates the move times for a number of moves (steps) in a single pass over the ramp steps.
+/// The moves are sorted by the ramp steps, the sums of the step times are taken when passing the
+/// ramp steps of a move (see the formula in TrackPlanner.h). Moves with less than 4 ramp steps are
+/// not started by the actuator (the move time is zero).
+/// </summary>
+/// <param name="steps">The number of steps of every move.</param>
+/// <param name="times">The move times (usec).</param>
+/// <param name="count">The number of moves (at most BATCH).</param>
+void TrackPlanner::_getMoveTimes(const long steps[], uint32_t times[], size_t count)
+{
+    long    ramps[BATCH];
+    uint8_t order[BATCH];
+    size_t  n = 0;
+
+    SpeedDelta deltaspeed = (_maxspeed - _minspeed).convert<SpeedDelta>() / _maxsteps;
+
+    // Sort the moves by ramp steps (insertion sort, a few moves only).
+    for (size_t i = 0; i < count; i++)
+    {
+        ramps[i] = (2 * _maxsteps > steps[i]) ? steps[i] / 2 : _maxsteps;
+        times[i] = 0;
+
+        if (ramps[i] < 4) continue;
+
+        size_t j = n++;
+
+        while ((j > 0) && (ramps[order[j - 1]] > ramps[i]))
+        {
+            order[j] = order[j - 1];
+            j--;
+        }
+
+        order[j] = i;
+    }
+
+    uint64_t sum   = 0;                             // The sum of the first k step times (nsec).
+    uint64_t first = 0;                             // The time of the first step (nsec).
+    long     k     = 0;
+
+    for (size_t next = 0; next < n;)
+    {
+        long ramp = ramps[order[next]];
+
+        while (k < ramp)
+        {
+            uint32_t time = Actuator.getStepTime(_minspeed + (deltaspeed * k).convert<StepSpeed>());
+
+            if (k == 0) first = time;
+
+            sum += time;
+            k++;
+        }
+
+        uint64_t step = Actuator.getStepTime(_minspeed + (deltaspeed * ramp).convert<StepSpeed>());
+        uint64_t up   = sum + step;
+
+        for (; (next < n) && (ramps[order[next]] == ramp); next++)
+        {
+            long moves = steps[order[next]];
+            uint64_t down  = ((moves == 2 * ramp) ? sum : up) - first;
+            uint64_t total = up + down + ((moves > 2 * ramp + 1) ? uint64_t(moves - 2 * ramp - 1) * step : 0);
+
+            times[order[next]] = uint32_t((total + 500) / 1000);
+        }
+    }
+}
+
+/// <summary>
+/// Updates the move time matrix. If the ramp (speeds, ramp steps, or step pulse generator) has changed,
+/// all move times are calculated, otherwise only the move times from and to a changed track position.
+/// The moves are calculated in batches (BATCH moves per pass).
+/// </summary>
+void TrackPlanner::update()
+{
+    const AppSettings::YardSettings& yard = Settings.Yard;
+
+    bool ramp = !_valid ||
+                (_minspeed != Actuator.getMinSpeed()) ||
+                (_maxspeed != Actuator.getMaxSpeed()) ||
+                (_maxsteps != Actuator.getMaxSteps()) ||
+                (_driver   != Actuator.getDriver());
+
+    bool changed[TRACKS];
+    bool any = ramp || (_count != yard.Count);
+
+    for (size_t i = 0; i < yard.Count; i++)
+    {
+        changed[i] = ramp || (i >= _count) || (_tracks[i] != yard.Tracks[i].Position);
+        any |= changed[i];
+        _tracks[i] = yard.Tracks[i].Position;
+    }
+
+    _count = yard.Count;
+
+    if (!any) return;
+
+    _minspeed = Actuator.getMinSpeed();
+    _maxspeed = Actuator.getMaxSpeed();
+    _maxsteps = Actuator.getMaxSteps();
+    _driver   = Actuator.getDriver();
+
+    long     steps[BATCH];
+    uint32_t times[BATCH];
+    uint16_t index[BATCH];
+    size_t   count = 0;
+
+    // Calculates the collected moves and stores the move times in the matrix.
+    auto flush = [&]()
+    {
+        _getMoveTimes(steps, times, count);
+
+        for (size_t k = 0; k < count; k++)
+        {
+            _times[index[k]] = times[k];
+        }
+
+        _updates += count;
+        count = 0;
+    };
+
+    for (size_t i = 0; i < _count; i++)
+    {
+        for (size_t j = i + 1; j < _count; j++)
+        {
+            if (!changed[i] && !changed[j]) continue;
+
+            steps[count] = abs(_tracks[j] - _tracks[i]);
+            index[count] = _getIndex(i, j);
+
+            if (++count == BATCH) flush();
+        }
+    }
+
+    if (count > 0) flush();
+
+    _valid = true;
+}
+
+/// <summary>
+/// Gets the move time between two tracks (without the direction delay).
+/// </summary>
+/// <param name="from">The start track.</param>
+/// <param name="to">The target track.</param>
+/// <returns>The move time (usec), zero for an invalid track.</returns>
+uint32_t TrackPlanner::getMoveTime(uint8_t from, uint8_t to)
+{
+    update();
+
+    return ((from < _count) && (to < _count)) ? _getTime(from, to) : 0;
+}
+
+/// <summary>
+/// Orders the tracks for the minimal total time (Held-Karp). The cost of a state (visited tracks, last track,
+/// direction of the last move) is the minimal time to reach it. The visited tracks are stored without the
+/// last track (half the states), and the order is found backwards from the best final state (no predecessor
+/// table).
+/// </summary>
+/// <param name="list">The tracks to visit (sorted by position).</param>
+/// <param name="first">The move time from the start position to every track.</param>
+/// <param name="k">The number of tracks (at most MAX_EXACT).</param>
+/// <param name="start">The start position (steps).</param>
+/// <param name="direction">The direction index before the first move.</param>
+/// <param name="sequence">The planned sequence.</param>
+void TrackPlanner::_planExact(const uint8_t list[], const uint32_t first[], size_t k, long start, uint8_t direction, Sequence& sequence)
+{
+    long positions[MAX_EXACT];
+
+    for (size_t j = 0; j < k; j++)
+    {
+        positions[j] = _tracks[list[j]];
+    }
+
+    size_t size = (size_t(1) << (k - 1)) * k * 2;
+    std::unique_ptr<uint32_t[]> cost(new (std::nothrow) uint32_t[size]);
+
+    if (!cost)
+    {
+        sequence.Message = "Not enough memory";
+        return;
+    }
+
+    for (size_t i = 0; i < size; i++) cost[i] = UINT32_MAX;
+
+    // The state index (the last track is removed from the visited tracks).
+    auto index = [k](uint32_t mask, size_t last, uint8_t dir)
+    {
+        uint32_t rest = (mask & ((1u << last) - 1)) | ((mask >> (last + 1)) << last);
+        return (rest * k + last) * 2 + dir;
+    };
+
+    for (size_t j = 0; j < k; j++)
+    {
+        uint8_t  dir  = direction;
+        uint32_t time = getLegTime(first[j], start, positions[j], dir);
+        uint32_t& target = cost[index(1u << j, j, dir)];
+
+        if (time < target) target = time;
+    }
+
+    uint32_t full = (1u << k) - 1;
+
+    for (uint32_t mask = 1; mask <= full; mask++)
+    {
+        for (size_t last = 0; last < k; last++)
+        {
+            if (!(mask & (1u << last))) continue;
+
+            for (uint8_t dir = 0; dir < 2; dir++)
+            {
+                uint32_t current = cost[index(mask, last, dir)];
+
+                if (current == UINT32_MAX) continue;
+
+                for (size_t next = 0; next < k; next++)
+                {
+                    if (mask & (1u << next)) continue;
+
+                    uint8_t  nextdir = dir;
+                    uint32_t time    = getLegTime(_getTime(list[last], list[next]), positions[last], positions[next], nextdir);
+                    uint32_t& target = cost[index(mask | (1u << next), next, nextdir)];
+
+                    if (current + time < target) target = current + time;
+                }
+            }
+        }
+    }
+
+    // Find the best final state.
+    size_t  last  = 0;
+    uint8_t dir   = 0;
+    uint32_t best = UINT32_MAX;
+
+    for (size_t j = 0; j < k; j++)
+    {
+        for (uint8_t d = 0; d < 2; d++)
+        {
+            if (cost[index(full, j, d)] < best)
+            {
+                best = cost[index(full, j, d)];
+                last = j;
+                dir  = d;
+            }
+        }
+    }
+
+    // Follow the states backwards (a predecessor with the matching cost and direction).
+    uint32_t mask    = full;
+    uint32_t current = best;
+    size_t   count   = k;
+
+    while (count > 0)
+    {
+        sequence.Tracks[--count] = list[last];
+
+        uint32_t previous = mask & ~(1u << last);
+
+        if (previous == 0)
+        {
+            sequence.Times[count] = current;
+            break;
+        }
+
+        bool found = false;
+
+        for (size_t p = 0; (p < k) && !found; p++)
+        {
+            if (!(previous & (1u << p))) continue;
+
+            for (uint8_t d = 0; (d < 2) && !found; d++)
+            {
+                uint32_t value = cost[index(previous, p, d)];
+
+                if (value == UINT32_MAX) continue;
+
+                uint8_t  nextdir = d;
+                uint32_t time    = getLegTime(_getTime(list[p], list[last]), positions[p], positions[last], nextdir);
+
+                if ((nextdir == dir) && (value + time == current))
+                {
+                    sequence.Times[count] = time;
+                    mask    = previous;
+                    last    = p;
+                    dir     = d;
+                    current = value;
+                    found   = true;
+                }
+            }
+        }
+
+        if (!found)
+        {
+            sequence.Message = "No sequence found";
+            return;
+        }
+    }
+
+    sequence.Count = k;
+    sequence.Total = best;
+    sequence.Exact = true;
+    sequence.Valid = true;
+}
+
+/// <summary>
+/// Orders the tracks as the fastest sweep. A sweep visits the tracks in position order with at most one
+/// reversal: down then up, up then down, or from the lowest (highest) track up (down).
+/// </summary>
+/// <param name="list">The tracks to visit (sorted by position).</param>
+/// <param name="first">The move time from the start position to every track.</param>
+/// <param name="k">The number of tracks.</param>
+/// <param name="start">The start position (steps).</param>
+/// <param name="direction">The direction index before the first move.</param>
+/// <param name="sequence">The planned sequence.</param>
+void TrackPlanner::_planSweep(const uint8_t list[], const uint32_t first[], size_t k, long start, uint8_t direction, Sequence& sequence)
+{
+    uint8_t  order[TRACKS];
+    uint32_t times[TRACKS];
+    size_t   split = 0;                             // The number of tracks below the start position.
+
+    while ((split < k) && (_tracks[list[split]] < start)) split++;
+
+    sequence.Total = UINT32_MAX;
+
+    for (uint8_t sweep = 0; sweep < 4; sweep++)
+    {
+        size_t n = 0;
+
+        switch (sweep)
+        {
+        case 0:                                     // Down, then up.
+            for (size_t j = split; j > 0; j--) order[n++] = j - 1;
+            for (size_t j = split; j < k; j++) order[n++] = j;
+            break;
+        case 1:                                     // Up, then down.
+            for (size_t j = split; j < k; j++) order[n++] = j;
+            for (size_t j = split; j > 0; j--) order[n++] = j - 1;
+            break;
+        case 2:                                     // To the lowest track, then up.
+            for (size_t j = 0; j < k; j++) order[n++] = j;
+            break;
+        case 3:                                     // To the highest track, then down.
+            for (size_t j = k; j > 0; j--) order[n++] = j - 1;
+            break;
+        }
+
+        uint8_t  dir   = direction;
+        uint32_t total = 0;
+
+        for (size_t i = 0; i < k; i++)
+        {
+            long     from = (i == 0) ? start : _tracks[list[order[i - 1]]];
+            uint32_t time = (i == 0) ? first[order[0]] : _getTime(list[order[i - 1]], list[order[i]]);
+
+            times[i] = getLegTime(time, from, _tracks[list[order[i]]], dir);
+            total   += times[i];
+        }
+
+        if (total < sequence.Total)
+        {
+            for (size_t i = 0; i < k; i++)
+            {
+                sequence.Tracks[i] = list[order[i]];
+                sequence.Times[i]  = times[i];
+            }
+
+            sequence.Total = total;
+        }
+    }
+
+    sequence.Count = k;
+    sequence.Valid = true;
+}
+
+/// <summary>
+/// Orders the tracks for the minimal total time, starting at the current position and direction of the
+/// actuator. Up to MAX_EXACT tracks are planned exactly, larger sets are swept. Duplicates are ignored.
+/// </summary>
+/// <param name="tracks">The tracks to visit (index).</param>
+/// <param name="count">The number of tracks.</param>
+/// <returns>The planned sequence.</returns>
+TrackPlanner::Sequence TrackPlanner::plan(const uint8_t tracks[], size_t count)
+{
+    Sequence sequence;
+    uint8_t  list[TRACKS];
+    size_t   k = 0;
+
+    update();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (tracks[i] >= _count)
+        {
+            sequence.Message = String("Unknown track ") + tracks[i];
+            return sequence;
+        }
+
+        if (std::find(list, list + k, tracks[i]) == list + k) list[k++] = tracks[i];
+    }
+
+    if (k == 0)
+    {
+        sequence.Message = "No tracks to visit";
+        return sequence;
+    }
+
+    // The tracks are sorted by position (track index).
+    std::sort(list, list + k);
+
+    long    start     = Actuator.getPosition();
+    uint8_t direction = (Actuator.getDirection() == LinearActuator::Direction::CW) ? DIR_CW : DIR_CCW;
+
+    long     steps[TRACKS];
+    uint32_t first[TRACKS];
+
+    for (size_t j = 0; j < k; j++)
+    {
+        steps[j] = abs(_tracks[list[j]] - start);
+    }
+
+    _getMoveTimes(steps, first, k);
+
+    if (k <= MAX_EXACT)
+        _planExact(list, first, k, start, direction, sequence);
+    else
+        _planSweep(list, first, k, start, direction, sequence);
+
+    return sequence;
+}
+
+/// <summary>
+/// Orders all tracks for the minimal total time.
+/// </summary>
+/// <returns>The planned sequence.</returns>
+TrackPlanner::Sequence TrackPlanner::plan()
+{
+    uint8_t tracks[TRACKS];
+    size_t  count = Settings.Yard.Count;
+
+    for (size_t i = 0; i < count; i++)
+    {
+        tracks[i] = i;
+    }
+
+    return plan(tracks, count);
+}
+
+/// <summary>
+/// Parses a list of tracks. The tracks are names or numbers (see YardSettings::parseTrack) separated by
+/// commas, plus signs or spaces (i.e. "1,3,5" or "North+South").
+/// </summary>
+/// <param name="text">The list of tracks.</param>
+/// <param name="tracks">The tracks (index, at most TRACKS).</param>
+/// <param name="count">The number of tracks.</param>
+/// <returns>True if valid (at least one track, all tracks known).</returns>
+bool TrackPlanner::parseTracks(String text, uint8_t tracks[], size_t& count)
+{
+    count = 0;
+
+    text.replace('+', ',');
+    text.replace(' ', ',');
+    text += ',';
+
+    for (int begin = 0, end = text.indexOf(','); end >= 0; begin = end + 1, end = text.indexOf(',', begin))
+    {
+        if (end == begin) continue;
+
+        int index = Settings.Yard.parseTrack(text.substring(begin, end));
+
+        if ((index < 0) || (count == TRACKS)) return false;
+
+        tracks[count++] = index;
+    }
+
+    return count > 0;
+}
+
+/// <summary>
+/// Returns a (pretty) string representation of the planned sequence (the track names are not copied).
+/// </summary>
+/// <param name="sequence">The planned sequence.</param>
+/// <returns>The serialized JSON document.</returns>
+String TrackPlanner::toJsonString(const Sequence& sequence)
+{
+    String json;
+
+    JsonArenaDocument doc(JSON_SIZE);
+    doc["Valid"] = sequence.Valid;
+
+    if (sequence.Valid)
+    {
+        JsonArray tracks = doc.createNestedArray("Tracks");
+        JsonArray times  = doc.createNestedArray("Times");
+
+        for (size_t i = 0; i < sequence.Count; i++)
+        {
+            tracks.add(Settings.Yard.Tracks[sequence.Tracks[i]].Name.c_str());
+            times.add(sequence.Times[i]);
+        }
+
+        doc["Total"] = sequence.Total;
+        doc["Exact"] = sequence.Exact;
+    }
+    else
+    {
+        doc["Message"] = sequence.Message.c_str();
+    }
+
+    serializeJsonPretty(doc, json);
+
+    return json;
+}
+
+/// <summary>
+/// Returns a printable string representation of the planned sequence.
+/// </summary>
+/// <param name="sequence">The planned sequence.</param>
+/// <returns>The printable string.</returns>
+String TrackPlanner::toString(const Sequence& sequence)
+{
+    if (!sequence.Valid)
+    {
+        return sequence.Message + "\r\n";
+    }
+
+    String text = String("Sequence (") + (sequence.Exact ? "exact" : "sweep") + "):\r\n";
+
+    for (size_t i = 0; i < sequence.Count; i++)
+    {
+        String name = Settings.Yard.Tracks[sequence.Tracks[i]].Name + ":";
+
+        while (name.length() < AppSettings::YardSettings::MAX_NAME + 1) name += " ";
+
+        text += String("    ") + name + formatSeconds(sequence.Times[i], 8) + " sec\r\n";
+    }
+
+    String total = "Total:";
+
+    while (total.length() < AppSettings::YardSettings::MAX_NAME + 1) total += " ";
+
+    text += String("    ") + total + formatSeconds(sequence.Total, 8) + " sec\r\n";
+
+    return text;
+}
+
+/// <summary>
+/// Reads the next chunk of the move time matrix (a row per chunk, the matrix of 64 tracks does not fit into a
+/// JSON document). The row index is the cursor: starting at 0 (which updates the matrix) the matrix can be read
+/// over several loops, i.e. as a paged output source. The JSON output holds the move times in usec, the text
+/// output in seconds.
+/// </summary>
+/// <param name="json">True for JSON, false for text.</param>
+/// <param name="row">The cursor (0 for the first chunk, advanced for every chunk read).</param>
+/// <param name="chunk">The chunk read.</param>
+/// <returns>True if a chunk has been read, false if the matrix is done.</returns>
+bool TrackPlanner::read(bool json, size_t& row, String& chunk)
+{
+    const AppSettings::YardSettings& yard = Settings.Yard;
+
+    if (row == 0) update();
+
+    // The header, a chunk per track and (JSON only) the trailer.
+    if (row >= _count + (json ? 2 : 1)) return false;
+
+    size_t i = row - 1;
+
+    if (json)
+    {
+        if (row == 0)
+        {
+            String names;
+            String positions;
+
+            for (size_t j = 0; j < _count; j++)
+            {
+                names     += String(j ? ", \"" : "\"") + yard.Tracks[j].Name + "\"";
+                positions += String(j ? ", " : "") + _tracks[j];
+            }
+
+            chunk = String("{\n    \"DirectionDelay\": ") + DIR_DELAY + ",\n" +
+                    "    \"Names\": [ " + names + " ],\n" +
+                    "    \"Tracks\": [ " + positions + " ],\n" +
+                    "    \"Times\": [";
+        }
+        else if (i < _count)
+        {
+            chunk = i ? ",\n        [ " : "\n        [ ";
+
+            for (size_t j = 0; j < _count; j++)
+            {
+                chunk += String(j ? ", " : "") + _getTime(i, j);
+            }
+
+            chunk += " ]";
+        }
+        else
+        {
+            chunk = String("\n    ],\n    \"Updates\": ") + _updates + "\n}\n";
+        }
+    }
+    else
+    {
+        if (row == 0)
+        {
+            chunk = String("Move times (sec, direction delay ") + formatSeconds(DIR_DELAY, 0) + " sec):\r\n" +
+                    "    From/To         ";
+
+            for (size_t j = 0; j < _count; j++)
+            {
+                String name = yard.Tracks[j].Name;
+
+                while (name.length() < 9) name = String(" ") + name;
+
+                chunk += name;
+            }
+        }
+        else
+        {
+            chunk = yard.Tracks[i].Name;
+
+            while (chunk.length() < AppSettings::YardSettings::MAX_NAME + 1) chunk += " ";
+
+            chunk = String("    ") + chunk;
+
+            for (size_t j = 0; j < _count; j++)
+            {
+                chunk += String(" ") + formatSeconds(_getTime(i, j), 8);
+            }
+        }
+
+        chunk += "\r\n";
+    }
+
+    row++;
+
+    return true;
+}
+
+/// <summary>
+/// Streams the move time matrix, a row per chunk (see read()).
+/// </summary>
+/// <param name="json">True for JSON, false for text.</param>
+/// <param name="writer">The writer (called for every chunk).</param>
+void TrackPlanner::write(bool json, Writer writer)
+{
+    size_t row = 0;
+    String chunk;
+
+    while (read(json, row, chunk))
+    {
+        writer(chunk);
+    }
+}
+
+/// <summary>
+/// Writes a summary of the move time matrix: the number of tracks and the longest move. This is shown by the
+/// matrix command for more than MAX_SHOWN tracks (the matrix of 64 tracks is over 30 KB of text), the complete
+/// matrix is available at /yard/matrix.
+/// </summary>
+/// <param name="json">True for JSON, false for text.</param>
+/// <param name="writer">The writer.</param>
+void TrackPlanner::writeSummary(bool json, Writer writer)
+{
+    const AppSettings::YardSettings& yard = Settings.Yard;
+    size_t   from    = 0;
+    size_t   to      = 0;
+    uint32_t longest = 0;
+
+    update();
+
+    for (size_t i = 0; i < _count; i++)
+    {
+        for (size_t j = i + 1; j < _count; j++)
+        {
+            if (_getTime(i, j) > longest)
+            {
+                longest = _getTime(i, j);
+                from = i;
+                to = j;
+            }
+        }
+    }
+
+    String fromName = (_count > 0) ? yard.Tracks[from].Name : "";
+    String toName   = (_count > 0) ? yard.Tracks[to].Name : "";
+
+    if (json)
+    {
+        writer(String("{\n    \"Tracks\": ") + _count + ",\n" +
+               "    \"Longest\": { \"From\": \"" + fromName + "\", \"To\": \"" + toName + "\", \"Time\": " + longest + " },\n" +
+               "    \"Updates\": " + _updates + ",\n" +
+               "    \"Matrix\": \"/yard/matrix\"\n}\n");
+    }
+    else
+    {
+        writer(String("Move times (") + _count + " tracks, direction delay " + formatSeconds(DIR_DELAY, 0) + " sec):\r\n" +
+               "    Longest move:     " + fromName + " - " + toName + formatSeconds(longest, 9) + " sec\r\n" +
+               "    The matrix is too large to be shown, see /yard/matrix.\r\n");
+    }
+}
@@ -0,0 +1,111 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="TrackPlanner.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 1:10 AM</created>
+// <modified>19-10-2026 5:30 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   The track-to-track move time matrix and the fastest track sequence planner.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <Arduino.h>
+#include <functional>
+
+#include "AppSettings.h"
+#include "Actuator.h"
+
+/// <summary>
+/// This class holds the move times between all tracks of the yard (axis 0, Yard settings). A move time is
+/// exact: the step times of the speed profile (see LinearActuator::onTimer) are summed using the step
+/// times of the step pulse generator (see LinearActuator::getStepTime). As all moves share the same ramp,
+/// the move time only depends on the number of steps (S) and the ramp steps (R):
+///
+///     T(S) = P(R + 1) + P(S == 2R ? R : R + 1) - P(1) + (S - 2R - 1) * t(R)
+///
+/// where t(i) is the step time at ramp step i and P(k) the sum of the first k step times. The move times
+/// are calculated in batches (BATCH moves sorted by ramp steps, a single pass over the ramp steps). As the
+/// moves are symmetric, only the upper triangle of the matrix is stored. The matrix is updated before use:
+/// a changed ramp (speeds, ramp steps, driver) recalculates all moves, a changed track position only the
+/// moves from and to the track.
+///
+/// A direction change adds the direction delay (the stepper driver settle time, see DIR_DELAY). The
+/// sequence planner orders a set of tracks for the minimal total time starting at the current position.
+/// Up to MAX_EXACT tracks are planned exactly (Held-Karp dynamic programming, the state includes the
+/// direction of the last move), larger sets are swept (the fastest of the sweeps with a single reversal).
+/// </summary>
+class TrackPlanner
+{
+public:
+    static constexpr const size_t   TRACKS    = AppSettings::YardSettings::MAX_TRACKS;  // The maximum number of tracks.
+    static constexpr const size_t   MOVES     = TRACKS * (TRACKS - 1) / 2;              // The number of track pairs.
+    static constexpr const size_t   BATCH     = TRACKS;                                 // The number of moves calculated in a pass.
+    static constexpr const size_t   MAX_EXACT = 10;                                     // The maximum number of tracks planned exactly.
+    static constexpr const uint32_t DIR_DELAY = uint32_t(LinearActuator::DIR_DELAY) * 1000; // The direction delay (usec).
+    static constexpr const size_t   MAX_SHOWN = 16;                                     // The maximum number of tracks shown as a matrix (command).
+
+    /// <summary>
+    /// The planned track sequence (the move times include the direction delays).
+    /// </summary>
+    struct Sequence
+    {
+        uint8_t  Tracks[TRACKS] = {};               // The tracks (index) in visiting order.
+        uint32_t Times[TRACKS]  = {};               // The move time to every track (usec).
+        size_t   Count = 0;                         // The number of tracks.
+        uint32_t Total = 0;                         // The total time (usec).
+        String   Message;                           // The error message (if not valid).
+        bool     Exact = false;                     // Flag indicating an exact (not swept) sequence.
+        bool     Valid = false;                     // Flag indicating a valid sequence.
+    };
+
+    typedef std::function<void(const String&)> Writer;
+
+private:
+    static const size_t JSON_SIZE = JSON_OBJECT_SIZE(5) + 2 * JSON_ARRAY_SIZE(TRACKS); // The JSON document capacity (sequence).
+
+    long       _tracks[TRACKS] = {};                // The track positions of the matrix (steps).
+    size_t     _count    = 0;                       // The number of tracks of the matrix.
+    StepSpeed  _minspeed;                           // The minimum speed of the matrix.
+    StepSpeed  _maxspeed;                           // The maximum speed of the matrix.
+    long       _maxsteps = 0;                       // The ramp steps of the matrix.
+    uint8_t    _driver   = 0;                       // The step pulse generator of the matrix.
+    bool       _valid    = false;                   // Flag indicating that the matrix has been calculated.
+    uint32_t   _times[MOVES] = {};                  // The move times (usec, upper triangle).
+    uint32_t   _updates  = 0;                       // The number of move times calculated since boot.
+
+    /// <summary>
+    /// Gets the index of a track pair (from < to) in the upper triangle.
+    /// </summary>
+    static inline size_t _getIndex(size_t from, size_t to) { return from * (2 * TRACKS - from - 1) / 2 + (to - from - 1); }
+
+    inline uint32_t _getTime(size_t from, size_t to) const
+    {
+        return (from == to) ? 0 : (from < to) ? _times[_getIndex(from, to)] : _times[_getIndex(to, from)];
+    }
+
+    void _getMoveTimes(const long steps[], uint32_t times[], size_t count); // Calculates the move times (single pass).
+    void _planExact(const uint8_t list[], const uint32_t first[], size_t count, long start, uint8_t direction, Sequence& sequence);
+    void _planSweep(const uint8_t list[], const uint32_t first[], size_t count, long start, uint8_t direction, Sequence& sequence);
+
+public:
+    void     update();                              // Updates the changed move times.
+    uint32_t getMoveTime(uint8_t from, uint8_t to); // Gets the move time between two tracks (usec).
+    Sequence plan(const uint8_t tracks[], size_t count); // Orders the tracks (index) for the minimal total time.
+    Sequence plan();                                // Orders all tracks for the minimal total time.
+
+    static bool parseTracks(String text, uint8_t tracks[], size_t& count); // Parses a track list (i.e. "1,3,5" or "A+B").
+
+    inline uint32_t getUpdates() const { return _updates; }
+
+    String toJsonString(const Sequence& sequence);  // Get a serialized JSON representation of the sequence.
+    String toString(const Sequence& sequence);      // Get a string representation of the sequence.
+    bool   read(bool json, size_t& row, String& chunk); // Reads the next chunk of the matrix (row is the cursor).
+    void   write(bool json, Writer writer);         // Streams the matrix (JSON or text, a row per chunk).
+    void   writeSummary(bool json, Writer writer);  // Writes a summary of the matrix (JSON or text).
+};
@@ -0,0 +1,31 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="UserContext.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>18-10-2026 11:20 AM</created>
+// <modified>18-10-2026 11:20 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   The per user (telnet session, SerialBT, HTTP) command state.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+/// <summary>
+/// This struct holds the command state of a single user (input source).
+/// Every telnet session has its own context, as well as SerialBT and the HTTP server (default context).
+/// </summary>
+struct UserContext
+{
+    bool JsonOutput      = false;                   // Flag indicating JSON output.
+    bool WaitForResponse = false;                   // Flag indicating that a command response is expected.
+    bool Verbose         = false;                   // Flag indicating verbose output.
+    int  LastCommand     = -1;                      // Index of the last base command (used if waiting for response).
+    uint8_t Axis         = 0;                       // The selected axis (see StepEngine).
+
+    inline void reset() { *this = UserContext(); }  // Resets the context (new session).
+};
@@ -28,57 +28,164 @@ extern CommandsClass Commands;
 extern LinearActuator Actuator;
 
 /// <summary>
-/// Returns the verbose flag.
+/// Returns the context of the current input source (telnet session, SerialBT, or the default context).
+/// </summary>
+/// <returns>The user context.</returns>
+UserContext* UserInterface::getContext()
+{
+    int session = Telnet.getSession();
+
+    if (session >= 0)
+    {
+        return &Telnet.getContext(session);
+    }
+
+    return _bluetoothInput ? &_bluetooth : &_default;
+}
+
+/// <summary>
+/// Returns the verbose flag (of the current input source).
 /// </summary>
 /// <returns>The flag value.</returns>
 bool UserInterface::getVerbose()
 {
-    return _verbose;
+    return getContext()->Verbose;
 }
 
 /// <summary>
-/// Toggles the verbose flag.
+/// Toggles the verbose flag (of the current input source).
 /// </summary>
 void UserInterface::toggleVerbose()
 {
-    _verbose = !_verbose;
+    UserContext* context = getContext();
+    context->Verbose = !context->Verbose;
 
-    SerialBT.println(_verbose ? "Verbose on" : "Verbose off");
-    Telnet.println(_verbose ? "Verbose on" : "Verbose off");
+    show(context->Verbose ? "Verbose on\r\n" : "Verbose off\r\n");
 }
 
 /// <summary>
-/// Prints the string at telnet and SerialBT. Longer strings are splitted into smaller chunks for SerialBT output.
+/// Adds the string to the SerialBT output buffer (written in run(), paged if larger than the buffer).
 /// </summary>
 /// <param name="str">The string to be printed.</param>
-void UserInterface::show(const String& str)
+void UserInterface::_showBT(const String& str)
+{
+    if (!SerialBT) return;
+
+    _bluetoothOutput.page(str);
+}
+
+/// <summary>
+/// Consumes the available SerialBT input (never waits for more input) and dispatches every complete line.
+/// Incomplete lines are kept in the line buffer until the next call.
+/// </summary>
+void UserInterface::_readBT()
 {
-    auto length = str.length();
+    int available = SerialBT.available();
+
+    _bluetoothInput = true;
 
-    if (length > BTSTRING)
+    // Further input is held while a command output is paged.
+    while ((available-- > 0) && SerialBT && !_bluetoothOutput.isPaging())
     {
-        auto count = length / BTSTRING;
-        auto final = length % BTSTRING;
+        int c = SerialBT.read();
 
-        for (int i = 0; i < count; i++)
+        if (c < 0)
+            break;
+
+        switch (_bluetoothLine.add((char)c))
         {
-            auto part = str.substring(i * BTSTRING, i * BTSTRING + BTSTRING);
-            SerialBT.print(part);
-            Telnet.print(part);
+        case LineBuffer::COMPLETE:
+            if (_bluetoothLine.length() > 0)
+            {
+                Commands.parse(String(_bluetoothLine.get()));
+                _showBT(Settings.Server.Prompt);
+            }
+
+            _bluetoothLine.clear();
+            break;
+
+        case LineBuffer::TOO_LONG:
+            _showBT(String("Input line too long (max. ") + LineBuffer::SIZE + " characters) - ignored.\r\n");
+            _showBT(Settings.Server.Prompt);
+            break;
+
+        default:
+            break;
         }
+    }
+
+    _bluetoothInput = false;
+}
 
-        if (final > 0)
+/// <summary>
+/// Prints the string at the current input source. Without a source (HTTP, move info) the string is printed
+/// at SerialBT and all telnet sessions. Verbose output is only printed if the verbose flag of the user is set.
+/// A string larger than the output buffer is paged (see OutputBuffer).
+/// </summary>
+/// <param name="str">The string to be printed.</param>
+/// <param name="verbose">True if the string is verbose output.</param>
+void UserInterface::_write(const String& str, bool verbose)
+{
+    int session = Telnet.getSession();
+
+    if (session >= 0)
+    {
+        if (!verbose || Telnet.getContext(session).Verbose) Telnet.page(str);
+    }
+    else if (_bluetoothInput)
+    {
+        if (!verbose || _bluetooth.Verbose) _showBT(str);
+    }
+    else
+    {
+        if (!verbose || _bluetooth.Verbose) _showBT(str);
+
+        for (int i = 0; i < Telnet.getMaxSessions(); i++)
         {
-            auto part = str.substring(count * BTSTRING);
-            SerialBT.print(part);
+            if (Telnet.selectSession(i) && (!verbose || Telnet.getContext(i).Verbose))
+            {
+                Telnet.page(str);
+            }
         }
+
+        Telnet.selectSession(-1);
     }
-    else
+}
+
+/// <summary>
+/// Prints the string (ignores the verbose flag).
+/// </summary>
+/// <param name="str">The string to be printed.</param>
+void UserInterface::show(const String& str)
+{
+    _write(str, false);
+}
+
+/// <summary>
+/// Prints the output of the source (ignores the verbose flag). The source is paged at the current source
+/// (see OutputBuffer), without a source all chunks are printed at once.
+/// </summary>
+/// <param name="source">The output source.</param>
+void UserInterface::page(OutputBuffer::Source source)
+{
+    if (Telnet.getSession() >= 0)
     {
-        SerialBT.print(str);
+        Telnet.page(source);
     }
+    else if (_bluetoothInput)
+    {
+        if (SerialBT) _bluetoothOutput.page(source);
+    }
+    else
+    {
+        String chunk;
 
-    Telnet.print(str);
+        while (source(chunk))
+        {
+            show(chunk);
+            chunk = "";
+        }
+    }
 }
 
 /// <summary>
@@ -86,11 +193,7 @@ void UserInterface::show(const String& str)
 /// </summary>
 void UserInterface::println()
 {
-    if (_verbose)
-    {
-        SerialBT.println();
-        Telnet.println();
-    }
+    _write("\r\n", true);
 }
 
 /// <summary>
@@ -99,85 +202,38 @@ void UserInterface::println()
 /// <param name="str">The string to be printed.</param>
 void UserInterface::print(const String& str)
 {
-    if (_verbose)
-    {
-        SerialBT.print(str);
-        Telnet.print(str);
-    }
+    _write(str, true);
 }
 
 /// <summary>
 /// Prints the string if verbose is enabled (a linefeed is added).
-/// Note that the string length seems to be limited (ca. 512) for SerialBT.
 /// </summary>
 /// <param name="str">The string to be printed.</param>
 void UserInterface::println(const String& str)
 {
-    if (_verbose)
-    {
-        SerialBT.println(str);
-        Telnet.println(str);
-    }
+    _write(str + "\r\n", true);
 }
 
 /// <summary>
-/// Update loop for printing move info, and getting SerialBT inputs.
+/// Update loop for printing move info, getting SerialBT inputs, and writing the buffered SerialBT output.
 /// </summary>
 void UserInterface::run()
 {
     String info = Actuator.getMoveInfo();
 
-    if (_verbose)
+    // Print the move info to all users with verbose output enabled.
+    if (info.length() > 0)
     {
-        if (info.length() > 0)
-        {
-            Telnet.println(info);
-            Telnet.print(Settings.Server.Prompt);
-        }
+        _write(info + "\r\n" + Settings.Server.Prompt, true);
     }
 
     if (SerialBT)
     {
-        if (_verbose)
-        {
-            if (info.length() > 0)
-            {
-                SerialBT.println(info);
-                SerialBT.print(Settings.Server.Prompt);
-            }
-        }
-
-        if (SerialBT.available()) {
-            String line = SerialBT.readStringUntil('\n');
-            if (line != "") {
-                line.replace('\r', ' ');
-                line.trim();
-                Commands.parse(line);
-                SerialBT.print(Settings.Server.Prompt);
-            }
-        }
+        _readBT();
+        _bluetoothOutput.drainTo(SerialBT);
+    }
+    else
+    {
+        _bluetoothOutput.clear();
     }
 }
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
-
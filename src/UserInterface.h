@@ -18,18 +18,38 @@
 
 #include <Arduino.h>
 
+#include "UserContext.h"
+#include "OutputBuffer.h"
+#include "LineBuffer.h"
+
+/// <summary>
+/// The user IO keeps track of the current input source. Output generated while processing a command
+/// is sent to the source of the command only. Output without a source (e.g. move info) is sent to all.
+/// Every source has its own user context (JSON output, verbose flag, and pending confirmation).
+/// The SerialBT output is buffered and written once per loop (a slow terminal drops the oldest output).
+/// A response larger than the output buffer is paged (see page()), the input is held until it is written.
+/// </summary>
 class UserInterface
 {
 private:
-    static constexpr const uint  BTSTRING = 512;    // The maximum string length for SerialBT output.
+    UserContext _default;                           // The context used by the HTTP server (no source).
+    UserContext _bluetooth;                         // The context used by SerialBT.
+    bool _bluetoothInput = false;                   // Flag indicating that SerialBT input is processed.
+    OutputBuffer _bluetoothOutput { OutputBuffer::DROP_OLDEST };  // The buffered SerialBT output.
+    LineBuffer _bluetoothLine;                      // The (fixed size) SerialBT input line buffer.
 
-	bool _verbose = false;                          // Verbose flag indicates verbose output.
+    void _showBT(const String& str);                // Adds the string to the SerialBT output.
+    void _readBT();                                 // Reads the available SerialBT input (non-blocking).
+    void _write(const String& str, bool verbose);   // Prints the string at the current source (or all).
 
 public:
+    UserContext* getContext();                      // Returns the context of the current input source.
+
     bool getVerbose();                              // Returns the Verbose flag.
     void toggleVerbose();                           // Toggle the verbose flag.
 
     void show(const String& str);                   // Prints the string at output (ignores verbose flag).
+    void page(OutputBuffer::Source source);         // Prints the source output, paged (ignores verbose flag).
 
     void println();                                 // Prints an empty new line (if verbose flag is set).
     void print(const String& str);                  // Prints the string at output (if verbose flag is set).
@@ -50,3 +70,4 @@ public:
 
 
 
+
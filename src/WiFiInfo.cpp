@@ -14,6 +14,12 @@
 #include <WiFi.h>
 
 #include "WiFiInfo.h"
+#include "Wireless.h"
+
+/// <summary>
+/// The global network instance (link supervision data).
+/// </summary>
+extern Wireless Network;
 
 /// <summary>
 ///  Using a WiFi instance to get the actual data.
@@ -31,6 +37,12 @@ WiFiInfo::WiFiInfo()
 	Clients  = 0;
 	RSSI     = 0L;
 
+	LinkLosses = Network.getLinkLosses();
+	Reconnects = Network.getReconnects();
+	Attempts   = Network.getAttempts();
+	Downtime   = Network.getDowntime();
+	LastOutage = Network.getLastOutage();
+
 	Gateway = WiFi.gatewayIP().toString();
 	Subnet = WiFi.subnetMask().toString();
     MAC = WiFi.macAddress();
@@ -66,41 +78,45 @@ WiFiInfo::WiFiInfo()
 /// <returns>The serialized JSON document.</returns>
 String WiFiInfo::toJsonString()
 {
-    _doc.clear();
+    JsonArenaDocument doc(JSON_SIZE);
 
     if (Mode == "AP")
 	{
         String json;
       
-        _doc["Version"]  = Version;
-        _doc["Mode"]     = Mode;
-        _doc["SSID"]     = SSID;
-        _doc["Hostname"] = Hostname;
-        _doc["Address"]  = Address;
-        _doc["Gateway"]  = Gateway;
-        _doc["Subnet"]   = Subnet;
-        _doc["MAC"]      = MAC;
-        _doc["Clients"]  = Clients;
-        serializeJsonPretty(_doc, json);
+        doc["Version"]  = Version;
+        doc["Mode"]     = Mode;
+        doc["SSID"]     = SSID;
+        doc["Hostname"] = Hostname;
+        doc["Address"]  = Address;
+        doc["Gateway"]  = Gateway;
+        doc["Subnet"]   = Subnet;
+        doc["MAC"]      = MAC;
+        doc["Clients"]  = Clients;
+        serializeJsonPretty(doc, json);
 
         return json;
 	}
     else if (Mode == "STA")
     {
         String json;
-        DynamicJsonDocument doc(300);
 
-        _doc["Version"]  = Version;
-        _doc["Mode"]     = Mode;
-        _doc["SSID"]     = SSID;
-        _doc["Hostname"] = Hostname;
-        _doc["Address"]  = Address;
-        _doc["Gateway"]  = Gateway;
-        _doc["Subnet"]   = Subnet;
-        _doc["DNS"]      = DNS;
-        _doc["RSSI"]     = RSSI;
-        _doc["MAC"]      = MAC;
-        serializeJsonPretty(_doc, json);
+        doc["Version"]  = Version;
+        doc["Mode"]     = Mode;
+        doc["SSID"]     = SSID;
+        doc["Hostname"] = Hostname;
+        doc["Address"]  = Address;
+        doc["Gateway"]  = Gateway;
+        doc["Subnet"]   = Subnet;
+        doc["DNS"]      = DNS;
+        doc["RSSI"]     = RSSI;
+        doc["MAC"]      = MAC;
+        doc["LinkLosses"] = LinkLosses;
+        doc["Reconnects"] = Reconnects;
+        doc["Attempts"]   = Attempts;
+        doc["Downtime"]   = Downtime;
+        doc["LastOutage"] = LastOutage;
+        serializeJsonPretty(doc, json);
 
         return json;
     }
@@ -140,7 +156,9 @@ String WiFiInfo::toString()
                       "    Subnet:   " + Subnet   + "\r\n" +
                       "    DNS:      " + DNS      + "\r\n" +
                       "    RSSI:     " + RSSI     + "\r\n" +
-                      "    MAC:      " + MAC      + "\r\n";
+                      "    MAC:      " + MAC      + "\r\n" +
+                      "    Link:     " + LinkLosses + " losses, " + Reconnects + " reconnects (" + Attempts + " attempts)\r\n" +
+                      "    Downtime: " + Downtime + " ms (last outage " + LastOutage + " ms)\r\n";
     }
     else 
     {
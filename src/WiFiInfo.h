@@ -18,13 +18,15 @@
 
 #include <ArduinoJson.h>
 
+#include "JsonArena.h"
+
 /// <summary>
 /// This class holds the actual WiFi connection data.
 /// </summary>
 class WiFiInfo
 {
 private:
-    StaticJsonDocument<384> _doc; // The Json document representing the data.
+    static const size_t JSON_SIZE = 512; // The JSON document capacity (borrowed from the arena).
 
 public:
     WiFiInfo();
@@ -41,6 +43,11 @@ public:
 	String MAC;								// The MAC address.
 	int Clients;							// The number of connected clients (AP Mode). 
 	long RSSI;								// The signal strength.
+	uint32_t LinkLosses;					// The number of link losses (STA mode).
+	uint32_t Reconnects;					// The number of successful reconnects (STA mode).
+	uint32_t Attempts;						// The number of reconnect attempts (STA mode).
+	unsigned long Downtime;					// The total downtime including a current outage (ms).
+	unsigned long LastOutage;				// The duration of the last recovered outage (ms).
 
     String toJsonString();                  // Get a serialized JSON representation.
     String toString();						// Get a string representation.
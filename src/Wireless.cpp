@@ -6,7 +6,7 @@
 //   Licensed under the MIT license. See the LICENSE file in the project root for more information.
 // </license>
 // <created>9-4-2023 7:49 PM</created>
-// <modified>11-5-2023 4:36 PM</modified>
+// <modified>18-10-2026 7:15 PM</modified>
 // <author>Peter Trimmel</author>
 // --------------------------------------------------------------------------------------------------------------------
 #include <Arduino.h>
@@ -14,6 +14,7 @@
 #include <WiFi.h>
 
 #include "AppSettings.h"
+#include "Metrics.h"
 #include "Wireless.h"
 
 /// <summary>
@@ -22,100 +23,75 @@
 extern AppSettings Settings;
 
 /// <summary>
-/// Try to connect to WiFi network using the application settings.
+/// The global metrics instance (link losses and reconnects).
 /// </summary>
-bool Wireless::connectWiFi(void)
+extern MetricsClass Metrics;
+
+/// <summary>
+/// Sets the state and calls the state change callback.
+/// </summary>
+/// <param name="state">The new state.</param>
+void Wireless::_setState(State state)
+{
+    _state = state;
+    _stateSince = millis();
+
+    if (_onStateChanged != nullptr)
+    {
+        _onStateChanged(state);
+    }
+}
+
+/// <summary>
+/// Starts the connection to the WiFi network using the application settings. The connection is
+/// established in the background (see run()).
+/// </summary>
+void Wireless::_beginWiFi(void)
 {
-    bool ok = false;
     WiFi.mode(WIFI_STA);    
 	WiFi.setHostname(Settings.WiFi.Hostname.c_str());
 
-    // Using WiFi passphrase to connect.
-    if (Settings.WiFi.Password.length() > 0)
+    if (!Settings.WiFi.DHCP)
     {
-        if (Settings.WiFi.DHCP)
-        {
-            WiFi.begin(Settings.WiFi.SSID.c_str(), Settings.WiFi.Password.c_str());
-        }
-        else
-        {
-            IPAddress address;
-            IPAddress gateway;
-            IPAddress subnet;
-            IPAddress dns;
-
-            bool addressOK = address.fromString(Settings.WiFi.Address);
-            bool gatewayOK = gateway.fromString(Settings.WiFi.Gateway);
-            bool subnetOK = subnet.fromString(Settings.WiFi.Subnet);
-            bool dnsOK = dns.fromString(Settings.WiFi.DNS);
+        IPAddress address;
+        IPAddress gateway;
+        IPAddress subnet;
+        IPAddress dns;
 
-            if (addressOK && dnsOK && gatewayOK && subnetOK)
-            {
-                WiFi.config(address, dns, gateway, subnet);
-            }
-            else if (addressOK)
-            {
-                WiFi.config(address);
-            }
+        bool addressOK = address.fromString(Settings.WiFi.Address);
+        bool gatewayOK = gateway.fromString(Settings.WiFi.Gateway);
+        bool subnetOK = subnet.fromString(Settings.WiFi.Subnet);
+        bool dnsOK = dns.fromString(Settings.WiFi.DNS);
 
-            WiFi.begin(Settings.WiFi.SSID.c_str(), Settings.WiFi.Password.c_str());
-        }
-    }
-    // Connect to the open WiFi network.
-    else
-    {
-        if (Settings.WiFi.DHCP)
+        if (addressOK && dnsOK && gatewayOK && subnetOK)
         {
-            WiFi.begin(Settings.WiFi.SSID.c_str());
+            WiFi.config(address, dns, gateway, subnet);
         }
-        else
+        else if (addressOK)
         {
-            IPAddress address;
-            IPAddress gateway;
-            IPAddress subnet;
-            IPAddress dns;
-
-            bool addressOK = address.fromString(Settings.WiFi.Address);
-            bool gatewayOK = gateway.fromString(Settings.WiFi.Gateway);
-            bool subnetOK = subnet.fromString(Settings.WiFi.Subnet);
-            bool dnsOK = dns.fromString(Settings.WiFi.DNS);
-
-            if (addressOK && dnsOK && gatewayOK && subnetOK)
-            {
-                if (dnsOK)
-                {
-                    WiFi.config(address, dns, gateway, subnet);
-                }
-                else
-                {
-                    WiFi.config(address);
-                }
-
-                WiFi.begin(Settings.WiFi.SSID.c_str());
-            }
+            WiFi.config(address);
         }
     }
 
-    for (int retries = 0; retries < CONNECT_RETRIES; retries++)
+    // Using WiFi passphrase to connect, or connect to the open WiFi network.
+    if (Settings.WiFi.Password.length() > 0)
     {
-        Serial.print(".");
-        delay(CONNECT_DELAY);
-        ok = WiFi.status() == WL_CONNECTED;
-
-        if (ok) break;
+        WiFi.beginNoBlock(Settings.WiFi.SSID.c_str(), Settings.WiFi.Password.c_str());
+    }
+    else
+    {
+        WiFi.beginNoBlock(Settings.WiFi.SSID.c_str());
     }
-
-    Serial.println();
-
-    return ok;
 }
 
 /// <summary>
 /// Try to create an WiFi access point using the application settings.
 /// </summary>
-bool Wireless::createAP(void)
+/// <returns>True if successful.</returns>
+bool Wireless::_createAP(void)
 {
     bool ok = false;
+    WiFi.disconnect();
     WiFi.mode(WIFI_AP);    
 	WiFi.setHostname(Settings.WiFi.Hostname.c_str());
 
@@ -139,12 +115,233 @@ bool Wireless::createAP(void)
 }
 
 /// <summary>
-/// Setting the current time using NTP.
+/// Starts setting the current time using NTP. The time is set in the background (see run()).
 /// </summary>
-void Wireless::setClock()
+void Wireless::_beginClock(void)
 {
     NTP.begin("pool.ntp.org", "time.nist.gov");
-    NTP.waitSet();
+}
+
+/// <summary>
+/// Checks the link status (every LINK_INTERVAL) and samples the signal strength (every RSSI_INTERVAL).
+/// If the link has been lost the first reconnect attempt is started immediately.
+/// </summary>
+void Wireless::_supervise(void)
+{
+    unsigned long now = millis();
+
+    // The access point is not supervised (no link to an external access point).
+    if (_accessPoint || (now - _lastLinkCheck < LINK_INTERVAL))
+        return;
+
+    _lastLinkCheck = now;
+
+    if (WiFi.status() != WL_CONNECTED)
+    {
+        Serial.println("WiFi link lost, reconnecting");
+
+        _linkLosses++;
+        Metrics.WiFiLinkLosses.inc();
+        _lostSince = now;
+        _backoff = BACKOFF_MIN;
+        _rssi = 0;
+        _attempts++;
+
+        WiFi.disconnect();
+        _beginWiFi();
+        _setState(RECONNECTING);
+    }
+    else if ((_lastRSSI == 0) || (now - _lastRSSI >= RSSI_INTERVAL))
+    {
+        _lastRSSI = now;
+        _rssi = WiFi.RSSI();
+    }
+}
+
+/// <summary>
+/// Waits for the reconnect attempt to succeed. If the attempt is not successful within the current
+/// backoff interval, a new attempt is started and the interval is doubled (up to BACKOFF_MAX).
+/// </summary>
+void Wireless::_reconnect(void)
+{
+    unsigned long now = millis();
+
+    if (WiFi.status() == WL_CONNECTED)
+    {
+        _lastOutage = now - _lostSince;
+        _downtime += _lastOutage;
+        _reconnects++;
+        Metrics.WiFiReconnects.inc();
+        _lastRSSI = 0;
+
+        Serial.println(String("WiFi link recovered after ") + _lastOutage + " ms");
+
+        if (_timeSet)
+        {
+            _setState(READY);
+        }
+        else
+        {
+            _beginClock();
+            _setState(TIME_SYNC);
+        }
+    }
+    else if (now - _stateSince >= _backoff)
+    {
+        _backoff = (_backoff < BACKOFF_MAX / 2) ? _backoff * 2 : BACKOFF_MAX;
+        _attempts++;
+        _stateSince = now;
+
+        WiFi.disconnect();
+        _beginWiFi();
+    }
+}
+
+/// <summary>
+/// Starts the network. Only the WiFi module is checked, the connection is established in the background.
+/// </summary>
+void Wireless::begin(void)
+{
+    if (WiFi.status() == WL_NO_MODULE)
+    {
+        Serial.println("Communication with WiFi module failed!");
+        _setState(FAILED);
+        return;
+    }
+
+    Serial.println(String("Trying to connect WiFi to '") + Settings.WiFi.SSID + "'");
+
+    _beginWiFi();
+    _setState(CONNECTING);
+}
+
+/// <summary>
+/// Advances the state machine. This is called from the main loop and never blocks (except for the
+/// short time needed to create the access point after the connection timeout).
+/// </summary>
+void Wireless::run(void)
+{
+    switch (_state)
+    {
+    case CONNECTING:
+        if (WiFi.status() == WL_CONNECTED)
+        {
+            Serial.println("WiFi connection successful");
+            _beginClock();
+            _setState(TIME_SYNC);
+        }
+        else if (millis() - _stateSince >= CONNECT_TIMEOUT)
+        {
+            Serial.println("WiFi connection not successful");
+            Serial.println("Trying to create WiFi accesss point");
+
+            if (_createAP())
+            {
+                Serial.println("Creating a WiFi access point successful");
+                _accessPoint = true;
+
+                // No internet access (NTP) is expected using the access point.
+                _setState(READY);
+            }
+            else
+            {
+                Serial.println("Creating a WiFi access point not successful");
+                _setState(FAILED);
+            }
+        }
+        break;
+
+    case TIME_SYNC:
+        _supervise();
+
+        if (_state != TIME_SYNC)
+        {
+            break;
+        }
+        else if (time(nullptr) > VALID_TIME)
+        {
+            _timeSet = true;
+            Serial.println(String("Current UTC time: ") + getTime());
+            _setState(READY);
+        }
+        else if (millis() - _stateSince >= TIME_SYNC_TIMEOUT)
+        {
+            Serial.println("Setting the time using NTP not successful");
+            _setState(READY);
+        }
+        break;
+
+    case READY:
+        _supervise();
+        break;
+
+    case RECONNECTING:
+        _reconnect();
+        break;
+
+    default:
+        break;
+    }
+}
+
+/// <summary>
+/// Sets the state change callback.
+/// </summary>
+/// <param name="f">The callback function.</param>
+void Wireless::onStateChanged(CallbackFunction f)
+{
+    _onStateChanged = f;
+}
+
+/// <summary>
+/// Returns the current state.
+/// </summary>
+/// <returns>The state.</returns>
+Wireless::State Wireless::getState(void)
+{
+    return _state;
+}
+
+/// <summary>
+/// Returns the name of the current state.
+/// </summary>
+/// <returns>The state name.</returns>
+String Wireless::getStateName(void)
+{
+    switch (_state)
+    {
+    case IDLE:          return "Idle";
+    case CONNECTING:    return "Connecting";
+    case TIME_SYNC:     return "TimeSync";
+    case READY:         return "Ready";
+    case RECONNECTING:  return "Reconnecting";
+    case FAILED:        return "Failed";
+    default:            return "Unknown";
+    }
+}
+
+/// <summary>
+/// Returns true if the network is available (connected to the WiFi network or access point created).
+/// </summary>
+bool Wireless::isAvailable(void)
+{
+    return (_state == TIME_SYNC) || (_state == READY);
+}
+
+/// <summary>
+/// Returns true if an access point has been created.
+/// </summary>
+bool Wireless::isAccessPoint(void)
+{
+    return _accessPoint;
+}
+
+/// <summary>
+/// Returns true if the time has been set by NTP.
+/// </summary>
+bool Wireless::isTimeSet(void)
+{
+    return _timeSet;
 }
 
 /// <summary>
@@ -160,5 +357,53 @@ String Wireless::getTime()
     return time.substring(0, time.length() - 1);
 }
 
+/// <summary>
+/// Returns the last sampled signal strength (0 if not connected).
+/// </summary>
+/// <returns>The signal strength (dBm).</returns>
+long Wireless::getRSSI(void)
+{
+    return _rssi;
+}
 
+/// <summary>
+/// Returns the number of link losses.
+/// </summary>
+uint32_t Wireless::getLinkLosses(void)
+{
+    return _linkLosses;
+}
+
+/// <summary>
+/// Returns the number of successful reconnects.
+/// </summary>
+uint32_t Wireless::getReconnects(void)
+{
+    return _reconnects;
+}
+
+/// <summary>
+/// Returns the number of reconnect attempts.
+/// </summary>
+uint32_t Wireless::getAttempts(void)
+{
+    return _attempts;
+}
+
+/// <summary>
+/// Returns the total downtime of all outages including a current outage.
+/// </summary>
+/// <returns>The downtime (ms).</returns>
+unsigned long Wireless::getDowntime(void)
+{
+    return (_state == RECONNECTING) ? _downtime + (millis() - _lostSince) : _downtime;
+}
 
+/// <summary>
+/// Returns the duration of the last recovered outage.
+/// </summary>
+/// <returns>The duration (ms).</returns>
+unsigned long Wireless::getLastOutage(void)
+{
+    return _lastOutage;
+}
@@ -6,7 +6,7 @@
 //   Licensed under the MIT license. See the LICENSE file in the project root for more information.
 // </license>
 // <created>9-4-2023 7:49 PM</created>
-// <modified>24-4-2023 11:54 AM</modified>
+// <modified>18-10-2026 7:15 PM</modified>
 // <author>Peter Trimmel</author>
 // --------------------------------------------------------------------------------------------------------------------
 
@@ -14,19 +14,93 @@
 
 #include <WiFi.h>
 
+#include <functional>
+
 /// <summary>
-/// This helper class provides WiFi setup support.
+/// This helper class provides the (non-blocking) WiFi setup. The network is started in the background
+/// while the stepper, the inputs and the local commands are already running. The state machine is
+/// advanced by calling run() from the main loop:
+///
+///     IDLE         - The network has not been started (see begin()).
+///     CONNECTING   - Connecting to the WiFi network (station mode).
+///     TIME_SYNC    - The network is available (station or access point), waiting for the NTP time.
+///     READY        - The network is available and the time has been set (or the NTP timeout expired).
+///     RECONNECTING - The WiFi link has been lost, reconnecting (station mode).
+///     FAILED       - No WiFi module, or neither the WiFi connection nor the access point could be created.
+///
+/// If the connection is not established within CONNECT_TIMEOUT an access point is created instead.
+/// A callback is called on every state change (i.e. to start the servers when the network is available).
+///
+/// Once connected the link is supervised: the link status is checked every LINK_INTERVAL, and if the link
+/// has been lost, a new connection is started with an exponential backoff (BACKOFF_MIN doubling up to
+/// BACKOFF_MAX between the attempts). The signal strength, the link losses, the reconnects and the
+/// downtime are recorded (see WiFiInfo).
 /// </summary>
 class Wireless
 {
+public:
+    static const unsigned long CONNECT_TIMEOUT = 20000;         // The WiFi connection timeout (ms).
+    static const unsigned long TIME_SYNC_TIMEOUT = 15000;       // The NTP time sync timeout (ms).
+    static const time_t VALID_TIME = 1672531200;                // A time after this (1-1-2023) has been set by NTP.
+    static const unsigned long LINK_INTERVAL = 500;             // The link status check interval (ms).
+    static const unsigned long RSSI_INTERVAL = 5000;            // The signal strength sampling interval (ms).
+    static const unsigned long BACKOFF_MIN = 2000;              // The first reconnect attempt interval (ms).
+    static const unsigned long BACKOFF_MAX = 60000;             // The maximum reconnect attempt interval (ms).
+
+    enum State
+    {
+        IDLE,
+        CONNECTING,
+        TIME_SYNC,
+        READY,
+        RECONNECTING,
+        FAILED
+    };
+
+    typedef std::function<void(State)> CallbackFunction;
+
 private:
-    const int CONNECT_DELAY = 1000;
-    const int CONNECT_RETRIES = 20;
+    State _state = IDLE;                                        // The current state.
+    unsigned long _stateSince = 0;                              // The time of the last state change (millis).
+    bool _accessPoint = false;                                  // Flag indicating that an access point has been created.
+    bool _timeSet = false;                                      // Flag indicating that the time has been set by NTP.
+    CallbackFunction _onStateChanged = nullptr;                 // The state change callback.
+
+    unsigned long _lastLinkCheck = 0;                           // The time of the last link status check (millis).
+    unsigned long _lastRSSI = 0;                                // The time of the last signal strength sample (millis).
+    unsigned long _lostSince = 0;                               // The time the link has been lost (millis).
+    unsigned long _backoff = BACKOFF_MIN;                       // The current reconnect attempt interval (ms).
+    unsigned long _downtime = 0;                                // The total downtime of all recovered outages (ms).
+    unsigned long _lastOutage = 0;                              // The duration of the last recovered outage (ms).
+    uint32_t _linkLosses = 0;                                   // The number of link losses.
+    uint32_t _reconnects = 0;                                   // The number of successful reconnects.
+    uint32_t _attempts = 0;                                     // The number of reconnect attempts.
+    long _rssi = 0;                                             // The last sampled signal strength (dBm).
+
+    void _setState(State state);                                // Sets the state and calls the callback.
+    void _beginWiFi(void);                                      // Starts the WiFi connection (non-blocking).
+    bool _createAP(void);                                       // Creates the WiFi access point.
+    void _beginClock(void);                                     // Starts the NTP time sync (non-blocking).
+    void _supervise(void);                                      // Checks the link and samples the signal strength.
+    void _reconnect(void);                                      // Retries the connection (exponential backoff).
 
 public:
-    bool   connectWiFi(void);
-    bool   createAP(void);
-    void   setClock(void);
-    String getTime(void);
-};
+    void   begin(void);                                         // Starts the network (non-blocking).
+    void   run(void);                                           // Advances the state machine (called from the main loop).
+
+    void   onStateChanged(CallbackFunction f);                  // Sets the state change callback.
 
+    State  getState(void);                                      // Returns the current state.
+    String getStateName(void);                                  // Returns the name of the current state.
+    bool   isAvailable(void);                                   // True if the network is available (station or access point).
+    bool   isAccessPoint(void);                                 // True if an access point has been created.
+    bool   isTimeSet(void);                                     // True if the time has been set by NTP.
+    String getTime(void);                                       // Returns the current time (UTC).
+
+    long     getRSSI(void);                                     // Returns the last sampled signal strength (dBm).
+    uint32_t getLinkLosses(void);                               // Returns the number of link losses.
+    uint32_t getReconnects(void);                               // Returns the number of successful reconnects.
+    uint32_t getAttempts(void);                                 // Returns the number of reconnect attempts.
+    unsigned long getDowntime(void);                            // Returns the total downtime including a current outage (ms).
+    unsigned long getLastOutage(void);                          // Returns the duration of the last recovered outage (ms).
+};
@@ -0,0 +1,42 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="Check.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 5:10 AM</created>
+// <modified>19-10-2026 5:10 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   The check macro of the host tests (a test executable returns the result of checkResult()).
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdio.h>
+
+static int _checks = 0;                             // The number of checks.
+static int _failures = 0;                           // The number of failed checks.
+
+#define CHECK(condition, ...)                                                       \
+    do {                                                                            \
+        _checks++;                                                                  \
+        if (!(condition)) {                                                         \
+            _failures++;                                                            \
+            printf("FAILED %s:%d: %s - ", __FILE__, __LINE__, #condition);          \
+            printf(__VA_ARGS__);                                                    \
+            printf("\n");                                                           \
+        }                                                                           \
+    } while (0)
+
+/// <summary>
+/// Prints the number of checks and failures, returns the exit code (0 if all checks passed).
+/// </summary>
+static inline int checkResult()
+{
+    printf("%d checks, %d failed\n", _checks, _failures);
+
+    return (_failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,244 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="OutputBufferTest.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 5:10 AM</created>
+// <modified>19-10-2026 5:10 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   Host test of the output buffer policies and the paged output against a slow sink.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include "OutputBuffer.h"
+#include "Check.h"
+
+uint32_t HostMicros = 0;
+
+/// <summary>
+/// A sink accepting at most Room bytes per loop (as a WiFiClient with a full send window).
+/// </summary>
+class SlowSink : public Print
+{
+public:
+    String Output;                                  // The output received.
+    size_t Room = 0;                                // The bytes accepted until the next loop.
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t size) override
+    {
+        size = min(size, Room);
+        Output.concat((const char*)data, size);
+        Room -= size;
+
+        return size;
+    }
+
+    int availableForWrite() override { return (int)Room; }
+};
+
+/// <summary>
+/// Returns a text of the given size ("line <n>\r\n" lines).
+/// </summary>
+static String makeText(size_t size)
+{
+    String text;
+
+    for (int n = 0; text.length() < size; n++)
+    {
+        text += "line " + String(n) + "\r\n";
+    }
+
+    text.resize(size);
+
+    return text;
+}
+
+/// <summary>
+/// Drains the buffer with the given room per loop until the buffer is empty. Returns the number of loops.
+/// </summary>
+static int drain(OutputBuffer& buffer, SlowSink& sink, size_t room, int maxloops = 1000)
+{
+    int loops = 0;
+
+    do
+    {
+        sink.Room = room;
+        buffer.drainTo(sink);
+        loops++;
+    } while ((buffer.length() > 0) && (loops < maxloops));
+
+    return loops;
+}
+
+/// <summary>
+/// A write larger than the free space is truncated at once (no waiting), and the marker is appended.
+/// </summary>
+static void testTruncate()
+{
+    OutputBuffer buffer(OutputBuffer::TRUNCATE);
+    SlowSink sink;
+    String text = makeText(OutputBuffer::SIZE + 500);
+
+    buffer.print(text);
+
+    CHECK(buffer.length() == OutputBuffer::SIZE, "truncate: %zu bytes buffered", buffer.length());
+    CHECK(buffer.getDropped() > 500, "truncate: %u bytes dropped", (unsigned)buffer.getDropped());
+
+    buffer.print("dropped");
+    drain(buffer, sink, 100);
+
+    CHECK(sink.Output.find("[output truncated]") != std::string::npos, "truncate: no marker");
+    CHECK(sink.Output.find("dropped") == std::string::npos, "truncate: output after the truncation kept");
+    CHECK(sink.Output.length() + buffer.getDropped() == text.length() + 7 + 22, "truncate: %u + %u bytes",
+        sink.Output.length(), (unsigned)buffer.getDropped());
+
+    // After draining, the buffer accepts output again.
+    buffer.print("next");
+    drain(buffer, sink, 100);
+
+    CHECK(sink.Output.substring(sink.Output.length() - 4) == "next", "truncate: output after draining dropped");
+}
+
+/// <summary>
+/// A write larger than the free space discards the oldest output at once.
+/// </summary>
+static void testDropOldest()
+{
+    OutputBuffer buffer(OutputBuffer::DROP_OLDEST);
+    SlowSink sink;
+    String text = makeText(OutputBuffer::SIZE + 500);
+
+    buffer.print(text);
+
+    CHECK(buffer.length() == OutputBuffer::SIZE, "drop oldest: %zu bytes buffered", buffer.length());
+    CHECK(buffer.getDropped() == 500, "drop oldest: %u bytes dropped", (unsigned)buffer.getDropped());
+
+    drain(buffer, sink, 100);
+
+    CHECK(sink.Output == text.substring(500), "drop oldest: not the last %zu bytes", OutputBuffer::SIZE);
+}
+
+/// <summary>
+/// A text larger than the buffer is paged over several loops without dropping anything, and the output
+/// written while paging follows the paged text.
+/// </summary>
+static void testPageText()
+{
+    OutputBuffer buffer;
+    SlowSink sink;
+    String text = makeText(6000);
+
+    buffer.page(text);
+
+    CHECK(buffer.isPaging(), "page text: not paging");
+
+    buffer.print("prompt> ");
+
+    int loops = drain(buffer, sink, 300);
+
+    CHECK(!buffer.isPaging(), "page text: still paging");
+    CHECK(loops > 1, "page text: %d loops", loops);
+    CHECK(sink.Output == text + "prompt> ", "page text: %u bytes received", sink.Output.length());
+    CHECK(buffer.getDropped() == 0, "page text: %u bytes dropped", (unsigned)buffer.getDropped());
+
+    // A small text is added at once.
+    buffer.page("small");
+
+    CHECK(!buffer.isPaging() && (buffer.length() == 5), "page text: small text paged");
+}
+
+/// <summary>
+/// The source is asked for the chunks while draining, and a second page request while paging is held.
+/// </summary>
+static void testPageSource()
+{
+    OutputBuffer buffer;
+    SlowSink sink;
+    String expected;
+    int index = 0;
+
+    for (int n = 0; n < 100; n++)
+    {
+        expected += makeText(100);
+    }
+
+    buffer.page([&index](String& chunk) {
+        if (index >= 100) return false;
+        chunk = makeText(100);
+        index++;
+        return true;
+    });
+
+    CHECK(index < 100, "page source: all %d chunks read at once", index);
+
+    int second = 0;
+
+    buffer.page([&second](String& chunk) {
+        if (second >= 3) return false;
+        chunk = "second";
+        second++;
+        return true;
+    });
+
+    CHECK(second == 3, "page source: second source not held (%d chunks)", second);
+
+    drain(buffer, sink, 500);
+
+    CHECK(sink.Output == expected + "secondsecondsecond", "page source: %u bytes received", sink.Output.length());
+    CHECK(buffer.getDropped() == 0, "page source: %u bytes dropped", (unsigned)buffer.getDropped());
+}
+
+/// <summary>
+/// The output held while paging is bounded (using the policy).
+/// </summary>
+static void testHeld()
+{
+    OutputBuffer buffer(OutputBuffer::DROP_OLDEST);
+    SlowSink sink;
+    String text = makeText(4000);
+    String held = makeText(OutputBuffer::SIZE + 100);
+
+    buffer.page(text);
+    buffer.print(held);
+
+    CHECK(buffer.getDropped() == 100, "held: %u bytes dropped", (unsigned)buffer.getDropped());
+
+    drain(buffer, sink, 1000);
+
+    CHECK(sink.Output == text + held.substring(100), "held: %u bytes received", sink.Output.length());
+}
+
+/// <summary>
+/// Clearing discards the buffered, paged and held output.
+/// </summary>
+static void testClear()
+{
+    OutputBuffer buffer;
+    SlowSink sink;
+
+    buffer.page(makeText(5000));
+    buffer.print("held");
+    buffer.clear();
+
+    CHECK(!buffer.isPaging() && (buffer.length() == 0), "clear: output left");
+
+    drain(buffer, sink, 1000);
+
+    CHECK(sink.Output.length() == 0, "clear: %u bytes received", sink.Output.length());
+}
+
+int main()
+{
+    testTruncate();
+    testDropOldest();
+    testPageText();
+    testPageSource();
+    testHeld();
+    testClear();
+
+    return checkResult();
+}
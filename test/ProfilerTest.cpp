@@ -0,0 +1,200 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="ProfilerTest.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 6:00 AM</created>
+// <modified>19-10-2026 6:00 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   Host test of the profiler aggregates and the paged profile output (as the profile command pages it).
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include "OutputBuffer.h"
+#include "Profiler.h"
+#include "Check.h"
+
+uint32_t HostMicros = 0;
+ProfilerClass Profiler;
+
+static const int SITES = ProfilerClass::MAX_SITES - PROFILE_STATIC_SITES;  // The sites added (fills the table).
+
+static const char* NAMES[SITES];                    // The site names (constant strings as in setup).
+static std::string _names[SITES];                   // The storage of the site names.
+
+/// <summary>
+/// A sink accepting at most Room bytes per loop (as a WiFiClient with a full send window).
+/// </summary>
+class SlowSink : public Print
+{
+public:
+    String Output;                                  // The output received.
+    size_t Room = 0;                                // The bytes accepted until the next loop.
+
+    size_t write(uint8_t c) override { return write(&c, 1); }
+    size_t write(const uint8_t* data, size_t size) override
+    {
+        size = min(size, Room);
+        Output.concat((const char*)data, size);
+        Room -= size;
+
+        return size;
+    }
+
+    int availableForWrite() override { return (int)Room; }
+};
+
+/// <summary>
+/// Adds the sites (alternating the groups "task" and "command"), records times for all but every fifth site.
+/// </summary>
+static void addSites()
+{
+    for (int i = 0; i < SITES; i++)
+    {
+        _names[i] = "site" + std::to_string(i);
+        NAMES[i] = _names[i].c_str();
+
+        int site = Profiler.add((i % 2) ? "command" : "task", NAMES[i]);
+
+        CHECK(site == PROFILE_STATIC_SITES + i, "add: site %d for %d", site, i);
+
+        if (i % 5 == 0) continue;
+
+        for (uint32_t n = 0; n < 10; n++)
+        {
+            Profiler.record(site, 10 + n * i * 100);
+        }
+    }
+
+    CHECK(Profiler.add("task", "full") == -1, "add: table full not refused");
+
+    // A scoped timer records the time to the end of the scope.
+    HostMicros = 1000;
+    {
+        PROFILE_SCOPE(PROFILE_LOOP);
+        HostMicros = 1300;
+    }
+}
+
+/// <summary>
+/// Returns the complete (streamed) output.
+/// </summary>
+static String writeAll(bool json, const char* group)
+{
+    String output;
+
+    Profiler.write(json, [&output](const String& chunk) { output += chunk; }, group);
+
+    return output;
+}
+
+/// <summary>
+/// Pages the output through an output buffer (as the profile command) and returns the output received by a
+/// slow sink. The number of loops is returned in loops.
+/// </summary>
+static String pageAll(bool json, const char* group, int& loops)
+{
+    OutputBuffer buffer;
+    SlowSink sink;
+    ProfilerClass::Cursor cursor;
+
+    cursor.Json  = json;
+    cursor.Group = group;
+
+    buffer.page([cursor](String& chunk) mutable { return Profiler.read(cursor, chunk); });
+    buffer.print("prompt> ");
+
+    for (loops = 0; (buffer.length() > 0) && (loops < 1000); loops++)
+    {
+        sink.Room = 400;
+        buffer.drainTo(sink);
+    }
+
+    CHECK(buffer.getDropped() == 0, "page: %u bytes dropped", (unsigned)buffer.getDropped());
+
+    return sink.Output;
+}
+
+/// <summary>
+/// Returns the number of occurrences of the text.
+/// </summary>
+static int countOf(const String& output, const char* text)
+{
+    int count = 0;
+
+    for (size_t index = output.find(text); index != std::string::npos; index = output.find(text, index + 1))
+    {
+        count++;
+    }
+
+    return count;
+}
+
+/// <summary>
+/// The paged text output of all sites is complete: the header, a line per site used, and the prompt.
+/// </summary>
+static void testText()
+{
+    int    loops  = 0;
+    String all    = writeAll(false, nullptr);
+    String paged  = pageAll(false, "", loops);
+    int    used   = SITES - (SITES + 4) / 5;
+
+    CHECK(all.length() > 2 * OutputBuffer::SIZE, "text: %u bytes only", all.length());
+    CHECK(loops > 1, "text: %d loops", loops);
+    CHECK(paged == all + "prompt> ", "text: %u of %u bytes", paged.length(), all.length() + 8);
+    CHECK(countOf(paged, "\r\n") == used + 3, "text: %d lines for %d sites", countOf(paged, "\r\n"), used);
+    CHECK(paged.find("loop:pass") != std::string::npos, "text: scoped timer not recorded");
+    CHECK(paged.find("settings:") == std::string::npos, "text: unused site shown");
+}
+
+/// <summary>
+/// The paged output of a single group holds only the sites of the group.
+/// </summary>
+static void testGroup()
+{
+    int    loops = 0;
+    String paged = pageAll(false, "task", loops);
+
+    CHECK(paged == writeAll(false, "task") + "prompt> ", "group: %u bytes", paged.length());
+    CHECK(countOf(paged, "command:") == 0, "group: other group shown");
+    int used = 0;
+
+    for (int i = 0; i < SITES; i += 2)
+    {
+        if (i % 5 != 0) used++;
+    }
+
+    CHECK(countOf(paged, "task:") == used, "group: %d task sites for %d", countOf(paged, "task:"), used);
+    CHECK(paged.find("loop:pass") == std::string::npos, "group: loop site shown");
+}
+
+/// <summary>
+/// The paged JSON output is complete (header, sites, trailer).
+/// </summary>
+static void testJson()
+{
+    int    loops = 0;
+    String all   = writeAll(true, nullptr);
+    String paged = pageAll(true, "", loops);
+    int    used  = SITES - (SITES + 4) / 5 + 1;
+
+    CHECK(loops > 1, "json: %d loops", loops);
+    CHECK(paged == all + "prompt> ", "json: %u of %u bytes", paged.length(), all.length() + 8);
+    CHECK(countOf(paged, "\"Group\"") == used, "json: %d sites for %d", countOf(paged, "\"Group\""), used);
+    CHECK(paged.find("\n    ]\n}\n") != std::string::npos, "json: no trailer");
+    CHECK(paged.find("\"Max\": 300") != std::string::npos, "json: scoped timer time");
+}
+
+int main()
+{
+    addSites();
+    testText();
+    testGroup();
+    testJson();
+
+    return checkResult();
+}
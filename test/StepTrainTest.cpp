@@ -0,0 +1,328 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="StepTrainTest.cpp" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 4:30 AM</created>
+// <modified>19-10-2026 5:10 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   Host test of the step planner words against an emulation of the PIO step generator program.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+
+#include <deque>
+#include <vector>
+
+#include "StepPlanner.h"
+#include "Check.h"
+
+/// <summary>
+/// The PIO program loaded by StepTrain::init() (origin 0), as encoded by the pio_encode_* helpers with
+/// an optional single side-set pin (side-set enable bit 12, value bit 11, delay bits 10..8).
+/// </summary>
+static const uint16_t PROGRAM[] = {
+    0x80A0,                                         // 0:  pull block
+    0x7830,                                         // 1:  out x, 16       side 1
+    0x0042,                                         // 2:  jmp x--, 2
+    0x7050,                                         // 3:  out y, 16       side 0
+    0x0084                                          // 4:  jmp y--, 4
+};
+
+static const size_t BUFFER_SIZE = 256;              // The step words per DMA buffer (see StepTrain::BUFFER_SIZE).
+
+/// <summary>
+/// A single step as seen on the PUL pin (PIO ticks).
+/// </summary>
+struct Step
+{
+    uint32_t High = 0;                              // The ticks PUL is high.
+    uint32_t Low  = 0;                              // The ticks PUL is low (until the next rising edge).
+};
+
+/// <summary>
+/// This class emulates a PIO state machine running the step program: one instruction per tick, the TX FIFO
+/// is fed with the step words (as by the DMA, no underrun), the output shift register shifts to the right
+/// (no autopull), and the side-set is applied at the start of an instruction. The emulation ends when the
+/// pull finds the FIFO empty (the last low phase includes this tick).
+/// </summary>
+class PioEmulator
+{
+private:
+    std::deque<uint32_t> _fifo;                     // The TX FIFO (joined, the DMA keeps it filled).
+    std::vector<Step>    _steps;                    // The steps output.
+    uint64_t _tick   = 0;                           // The current tick.
+    uint64_t _rise   = 0;                           // The tick of the last rising edge.
+    uint64_t _fall   = 0;                           // The tick of the last falling edge.
+    uint32_t _pc     = 0;                           // The program counter.
+    uint32_t _x      = 0;                           // The scratch register X.
+    uint32_t _y      = 0;                           // The scratch register Y.
+    uint32_t _osr    = 0;                           // The output shift register.
+    bool     _pin    = false;                       // The side-set (PUL) pin.
+    bool     _failed = false;                       // Flag indicating an unsupported instruction.
+
+    void _setPin(bool value)
+    {
+        if (value == _pin) return;
+
+        if (value)
+        {
+            if (!_steps.empty()) _steps.back().Low = uint32_t(_tick - _fall);
+            _steps.push_back(Step());
+            _rise = _tick;
+        }
+        else
+        {
+            _steps.back().High = uint32_t(_tick - _rise);
+            _fall = _tick;
+        }
+
+        _pin = value;
+    }
+
+    uint32_t _next() const { return (_pc + 1) % (sizeof(PROGRAM) / sizeof(PROGRAM[0])); }
+
+public:
+    void push(const uint32_t* words, size_t count) { _fifo.insert(_fifo.end(), words, words + count); }
+
+    /// <summary>
+    /// Runs the program until the FIFO is empty. Returns false for an unsupported instruction.
+    /// </summary>
+    bool run()
+    {
+        while (!_failed)
+        {
+            uint16_t instruction = PROGRAM[_pc];
+            uint32_t delay = (instruction >> 8) & 0x07;
+
+            if (instruction & 0x1000) _setPin((instruction >> 11) & 0x01);
+
+            switch (instruction >> 13)
+            {
+            case 0: // JMP (always, x--, y--)
+            {
+                uint32_t condition = (instruction >> 5) & 0x07;
+                bool jump = false;
+
+                if (condition == 0) jump = true;
+                else if (condition == 2) jump = (_x-- != 0);
+                else if (condition == 4) jump = (_y-- != 0);
+                else _failed = true;
+
+                _pc = jump ? (instruction & 0x1F) : _next();
+                break;
+            }
+
+            case 3: // OUT (x, y)
+            {
+                uint32_t count = instruction & 0x1F;
+                uint32_t value = (count == 0) ? _osr : (_osr & ((1u << count) - 1));
+                uint32_t destination = (instruction >> 5) & 0x07;
+
+                _osr = (count == 0) ? 0 : (_osr >> count);
+
+                if (destination == 1) _x = value;
+                else if (destination == 2) _y = value;
+                else _failed = true;
+
+                _pc = _next();
+                break;
+            }
+
+            case 4: // PULL (block)
+                if (!(instruction & 0x80) || !(instruction & 0x20))
+                {
+                    _failed = true;
+                    break;
+                }
+
+                if (_fifo.empty())
+                {
+                    // The pull stalls (PUL stays low), the last low phase ends with this tick.
+                    _tick++;
+                    if (!_steps.empty()) _steps.back().Low = uint32_t(_tick - _fall);
+                    return true;
+                }
+
+                _osr = _fifo.front();
+                _fifo.pop_front();
+                _pc = _next();
+                break;
+
+            default:
+                _failed = true;
+                break;
+            }
+
+            _tick += 1 + delay;
+        }
+
+        return false;
+    }
+
+    inline const std::vector<Step>& getSteps() const { return _steps; }
+};
+
+/// <summary>
+/// Plans the move (filling buffers as the DMA interrupt does), emulates the PIO program, and checks the
+/// number of steps and the high and low ticks of every step against the planned step period.
+/// Returns the emulated steps.
+/// </summary>
+static std::vector<Step> checkMove(const char* name, long steps, long rampsteps, StepSpeed minspeed, SpeedDelta deltaspeed)
+{
+    StepPlanner planner;
+    StepPlanner reference;
+    PioEmulator pio;
+    uint32_t buffer[BUFFER_SIZE];
+    size_t count;
+
+    planner.begin(steps, rampsteps, minspeed, deltaspeed);
+    reference.begin(steps, rampsteps, minspeed, deltaspeed);
+
+    while ((count = planner.fill(buffer, BUFFER_SIZE)) > 0)
+    {
+        pio.push(buffer, count);
+    }
+
+    CHECK(planner.isDone() && (planner.getPlanned() == steps), "%s: planned %ld of %ld steps", name, planner.getPlanned(), steps);
+    CHECK(pio.run(), "%s: unsupported instruction", name);
+
+    const std::vector<Step>& output = pio.getSteps();
+    CHECK(long(output.size()) == steps, "%s: %zu pulses for %ld steps", name, output.size(), steps);
+
+    for (size_t n = 0; n < output.size(); n++)
+    {
+        uint32_t period = reference.getPeriod(long(n));
+        uint32_t high = period / 2;
+        uint32_t low = period - high;
+
+        CHECK(output[n].High == high, "%s: step %zu high %u ticks, expected %u", name, n, output[n].High, high);
+        CHECK(output[n].Low == low, "%s: step %zu low %u ticks, expected %u", name, n, output[n].Low, low);
+    }
+
+    printf("%-24s %6zu steps, period %u..%u ticks\n", name, output.size(),
+           output.empty() ? 0 : reference.getPeriod(0), output.empty() ? 0 : reference.getPeriod(long(output.size() / 2)));
+
+    return output;
+}
+
+/// <summary>
+/// Emulates a single step word and returns the step.
+/// </summary>
+static Step emulateWord(uint32_t word)
+{
+    PioEmulator pio;
+
+    pio.push(&word, 1);
+    pio.run();
+
+    return pio.getSteps().empty() ? Step() : pio.getSteps().front();
+}
+
+/// <summary>
+/// A move with full ramps (as planned by LinearActuator::moveAbsolute()): the period decreases over the
+/// ramp up, is constant at the maximum speed, and increases again over the ramp down.
+/// </summary>
+static void testRamp()
+{
+    StepSpeed  minspeed   = StepSpeed::fromInt(500);
+    StepSpeed  maxspeed   = StepSpeed::fromInt(20000);
+    long       maxsteps   = 400;
+    SpeedDelta deltaspeed = (maxspeed - minspeed).convert<SpeedDelta>() / maxsteps;
+
+    std::vector<Step> output = checkMove("ramp", 5000, maxsteps, minspeed, deltaspeed);
+
+    if (output.size() != 5000) return;
+
+    CHECK(output[0].High + output[0].Low == StepPlanner::toPeriod(minspeed), "ramp: first period %u", output[0].High + output[0].Low);
+    CHECK(output[2500].High + output[2500].Low == StepPlanner::toPeriod(maxspeed), "ramp: constant period %u", output[2500].High + output[2500].Low);
+
+    for (size_t n = 1; n <= 400; n++)
+    {
+        CHECK(output[n].High + output[n].Low <= output[n - 1].High + output[n - 1].Low, "ramp: step %zu slower than the previous", n);
+        CHECK(output[4999 - n].High + output[4999 - n].Low <= output[5000 - n].High + output[5000 - n].Low, "ramp: step %zu faster than the next", 4999 - n);
+    }
+}
+
+/// <summary>
+/// A move at constant speed (no ramp): every step has the same period, including the maximum speed.
+/// </summary>
+static void testConstant()
+{
+    std::vector<Step> output = checkMove("constant", 3000, 0, StepSpeed::fromInt(4000), SpeedDelta());
+
+    for (const Step& step : output)
+    {
+        CHECK((step.High == 1250) && (step.Low == 1250), "constant: %u/%u ticks", step.High, step.Low);
+    }
+
+    output = checkMove("constant (max speed)", 1000, 0, StepPlanner::MAX_SPEED, SpeedDelta());
+
+    for (const Step& step : output)
+    {
+        CHECK((step.High == 20) && (step.Low == 20), "constant (max speed): %u/%u ticks", step.High, step.Low);
+    }
+}
+
+/// <summary>
+/// Short moves: a partial ramp (half the steps ramping), a single step, and no step at all.
+/// </summary>
+static void testShort()
+{
+    StepSpeed  minspeed   = StepSpeed::fromInt(1000);
+    SpeedDelta deltaspeed = (StepSpeed::fromInt(10000) - minspeed).convert<SpeedDelta>() / 100;
+
+    checkMove("short (partial ramp)", 9, 4, minspeed, deltaspeed);
+    checkMove("short (single step)", 1, 0, minspeed, deltaspeed);
+    checkMove("short (no step)", 0, 0, minspeed, deltaspeed);
+}
+
+/// <summary>
+/// The 16 bit counts: periods beyond the counts are clamped, periods below the instruction overhead give
+/// the shortest pulse, and the slowest planned speed (MIN_SPEED) is still within the counts (not clamped).
+/// </summary>
+static void testClamping()
+{
+    const uint32_t maxhigh = StepPlanner::MAX_COUNT + StepPlanner::HIGH_OVERHEAD;
+    const uint32_t maxlow  = StepPlanner::MAX_COUNT + StepPlanner::LOW_OVERHEAD;
+
+    uint32_t word = StepPlanner::encode(1000000);
+    Step step = emulateWord(word);
+
+    CHECK(word == 0xFFFFFFFF, "encode(1000000) = 0x%08X", word);
+    CHECK((step.High == maxhigh) && (step.Low == maxlow), "clamped: %u/%u ticks", step.High, step.Low);
+    CHECK(StepPlanner::decode(word) == maxhigh + maxlow, "clamped: decode %u", StepPlanner::decode(word));
+
+    word = StepPlanner::encode(2 * maxhigh);
+    step = emulateWord(word);
+    CHECK((word & 0xFFFF) == StepPlanner::MAX_COUNT, "high count 0x%04X", word & 0xFFFF);
+    CHECK(step.High == maxhigh, "high at limit: %u ticks", step.High);
+
+    word = StepPlanner::encode(3);
+    step = emulateWord(word);
+    CHECK(word == 0, "encode(3) = 0x%08X", word);
+    CHECK((step.High == StepPlanner::HIGH_OVERHEAD) && (step.Low == StepPlanner::LOW_OVERHEAD), "shortest: %u/%u ticks", step.High, step.Low);
+
+    // Any speed below MIN_SPEED is planned at MIN_SPEED, the period still fits the counts.
+    std::vector<Step> output = checkMove("slowest", 10, 0, StepSpeed::fromRaw(1), SpeedDelta());
+
+    for (const Step& slowest : output)
+    {
+        CHECK((slowest.High <= maxhigh) && (slowest.Low <= maxlow), "slowest: %u/%u ticks", slowest.High, slowest.Low);
+        CHECK(slowest.High + slowest.Low == StepPlanner::toPeriod(StepPlanner::MIN_SPEED), "slowest: period %u", slowest.High + slowest.Low);
+    }
+}
+
+int main()
+{
+    testRamp();
+    testConstant();
+    testShort();
+    testClamping();
+
+    return checkResult();
+}
@@ -0,0 +1,95 @@
+// --------------------------------------------------------------------------------------------------------------------
+// <copyright file="Arduino.h" company="DTV-Online">
+//   Copyright (c) 2023 Dr. Peter Trimmel. All rights reserved.
+// </copyright>
+// <license>
+//   Licensed under the MIT license. See the LICENSE file in the project root for more information.
+// </license>
+// <created>19-10-2026 5:10 AM</created>
+// <modified>19-10-2026 5:10 AM</modified>
+// <author>Peter Trimmel</author>
+// <summary>
+//   A minimal host stand-in for the Arduino core (String, Print and micros) used by the host tests.
+// </summary>
+// --------------------------------------------------------------------------------------------------------------------
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <string>
+
+using std::max;
+using std::min;
+
+// The time returned by micros() (set by the tests).
+extern uint32_t HostMicros;
+
+inline uint32_t micros() { return HostMicros; }
+
+/// <summary>
+/// The subset of the Arduino String used by the tested modules.
+/// </summary>
+class String : public std::string
+{
+public:
+    String() {}
+    String(const char* text) : std::string(text) {}
+    String(const std::string& text) : std::string(text) {}
+    String(char c) : std::string(1, c) {}
+    String(int value) : std::string(std::to_string(value)) {}
+    String(unsigned int value) : std::string(std::to_string(value)) {}
+    String(long value) : std::string(std::to_string(value)) {}
+    String(unsigned long value) : std::string(std::to_string(value)) {}
+    String(double value, unsigned int decimals)
+    {
+        char text[32];
+        snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+        assign(text);
+    }
+
+    unsigned int length() const { return (unsigned int)size(); }
+    bool concat(const char* text, unsigned int size) { append(text, size); return true; }
+    void remove(unsigned int index, unsigned int count) { erase(index, count); }
+    String substring(unsigned int from) const { return String(substr(from)); }
+
+    String& operator+=(const String& text) { append(text); return *this; }
+    String& operator+=(const char* text) { append(text); return *this; }
+    String& operator+=(char c) { push_back(c); return *this; }
+
+    friend String operator+(const String& left, const String& right) { return String(std::string(left) + std::string(right)); }
+    friend String operator+(const String& left, const char* right) { return String(std::string(left) + right); }
+    friend String operator+(const char* left, const String& right) { return String(left + std::string(right)); }
+    friend String operator+(const String& left, int right) { return left + String(right); }
+    friend String operator+(const String& left, unsigned int right) { return left + String(right); }
+    friend String operator+(const String& left, long right) { return left + String(right); }
+    friend String operator+(const String& left, unsigned long right) { return left + String(right); }
+};
+
+/// <summary>
+/// The subset of the Arduino Print class used by the tested modules.
+/// </summary>
+class Print
+{
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t c) = 0;
+    virtual size_t write(const uint8_t* data, size_t size)
+    {
+        size_t count = 0;
+
+        while (size-- > 0) count += write(*data++);
+
+        return count;
+    }
+
+    virtual int availableForWrite() { return 0; }
+
+    size_t write(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t print(const String& text) { return write((const uint8_t*)text.c_str(), text.length()); }
+    size_t print(const char* text) { return write(text); }
+};